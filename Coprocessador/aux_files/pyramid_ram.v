@@ -0,0 +1,30 @@
+// Memória de dupla porta inferida (M10K): níveis da pirâmide de zoom out
+// e bancos das memórias do main.
+// Mesma latência de leitura da mem1: endereço e saída registrados (2 ciclos).
+// DATA_W maior que 8 para os contadores do histograma.
+module pyramid_ram (
+    clock, wraddress, data, wren, rdaddress, q
+);
+    parameter ADDR_W = 16;
+    parameter DEPTH  = 38400;
+    parameter DATA_W = 8;
+
+    input clock;
+    input [ADDR_W-1:0] wraddress;
+    input [DATA_W-1:0] data;
+    input wren;
+    input [ADDR_W-1:0] rdaddress;
+    output reg [DATA_W-1:0] q;
+
+    reg [DATA_W-1:0] ram [0:DEPTH-1];
+    reg [ADDR_W-1:0] rdaddress_reg;
+
+    always @(posedge clock) begin
+        if (wren) begin
+            ram[wraddress] <= data;
+        end
+        rdaddress_reg <= rdaddress;
+        q <= ram[rdaddress_reg];
+    end
+
+endmodule
@@ -1,7 +1,7 @@
 module vga_module (
     input wire clock,     // 25 MHz
     input wire reset,     // Active high
-    input [7:0] color_in, // Pixel color data (RRRGGGBB)
+    input [23:0] color_in, // Pixel color data {R, G, B}
     output [9:0] next_x,  // x-coordinate of NEXT pixel that will be drawn
     output [9:0] next_y,  // y-coordinate of NEXT pixel that will be drawn
     output wire hsync,    // HSYNC (to VGA connector)
@@ -149,9 +149,9 @@ module vga_module (
             //////////////////////////////// COLOR OUT ///////////////////////////////
             //////////////////////////////////////////////////////////////////////////
             // Assign colors if in active mode
-            red_reg<=(h_state==H_ACTIVE_STATE)?((v_state==V_ACTIVE_STATE)?color_in:8'd_0):8'd_0 ;
-            green_reg<=(h_state==H_ACTIVE_STATE)?((v_state==V_ACTIVE_STATE)?color_in:8'd_0):8'd_0 ;
-            blue_reg<=(h_state==H_ACTIVE_STATE)?((v_state==V_ACTIVE_STATE)?color_in:8'd_0):8'd_0 ;
+            red_reg<=(h_state==H_ACTIVE_STATE)?((v_state==V_ACTIVE_STATE)?color_in[23:16]:8'd_0):8'd_0 ;
+            green_reg<=(h_state==H_ACTIVE_STATE)?((v_state==V_ACTIVE_STATE)?color_in[15:8]:8'd_0):8'd_0 ;
+            blue_reg<=(h_state==H_ACTIVE_STATE)?((v_state==V_ACTIVE_STATE)?color_in[7:0]:8'd_0):8'd_0 ;
 
         end
     end
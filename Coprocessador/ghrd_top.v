@@ -232,7 +232,7 @@ assign stm_hw_events    = {{3{1'b0}},SW, fpga_led_internal, fpga_debounced_butto
 wire [28:0] pio_instruct;
 wire        pio_enable;
 wire [7:0] pio_dataout;
-wire [3:0] pio_flags;
+wire [31:0] pio_flags;
 
 
 
@@ -360,6 +360,7 @@ main main_inst (
     .FLAG_ERROR     (pio_flags[1]),
     .FLAG_ZOOM_MAX  (pio_flags[2]),
     .FLAG_ZOOM_MIN  (pio_flags[3]),
+    .STATUS         (pio_flags[31:4]),
     
     // VGA
     .VGA_R          (VGA_R),
@@ -138,7 +138,7 @@
 #define PIO_FLAGS_BIT_CLEARING_EDGE_REGISTER 0
 #define PIO_FLAGS_BIT_MODIFYING_OUTPUT_REGISTER 0
 #define PIO_FLAGS_CAPTURE 0
-#define PIO_FLAGS_DATA_WIDTH 4
+#define PIO_FLAGS_DATA_WIDTH 32
 #define PIO_FLAGS_DO_TEST_BENCH_WIRING 0
 #define PIO_FLAGS_DRIVEN_SIM_VALUE 0
 #define PIO_FLAGS_EDGE_TYPE NONE
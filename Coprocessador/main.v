@@ -1,878 +1,1740 @@
-module main(
-    // Portas de Entrada
-    CLOCK_50,
-    INSTRUCTION,
-    DATA_IN,
-    MEM_ADDR,
-    SEL_MEM,
-    ENABLE,
-
-    // Portas de Saída e Debug
-    DATA_OUT,
-    FLAG_DONE,
-    FLAG_ERROR,
-    FLAG_ZOOM_MAX,
-    FLAG_ZOOM_MIN,
-    VGA_R,
-    VGA_B, 
-    VGA_G,
-    VGA_BLANK_N,
-    VGA_H_SYNC_N, 
-    VGA_V_SYNC_N, 
-    VGA_CLK, 
-    VGA_SYNC
-);
-
-    input CLOCK_50;
-    input [2:0] INSTRUCTION;
-    input [7:0] DATA_IN;
-    input [16:0] MEM_ADDR;
-    input SEL_MEM;
-    input ENABLE;
-
-    // Portas de Saída e Debug
-    output reg [7:0] DATA_OUT;
-    output reg FLAG_DONE;
-    output reg FLAG_ERROR;
-    output FLAG_ZOOM_MAX;
-    output FLAG_ZOOM_MIN;
-    output [7:0] VGA_R;
-    output [7:0] VGA_B; 
-    output [7:0] VGA_G;
-    output VGA_BLANK_N;
-    output VGA_H_SYNC_N; 
-    output VGA_V_SYNC_N;
-    output VGA_CLK;
-    output VGA_SYNC;
-    //================================================================
-    // 1. Definições, Clocks e Sinais
-    //================================================================
-    wire clk_100, clk_25_vga;
-
-    pll pll0(
-        .refclk(CLOCK_50), 
-        .rst(1'b0), 
-        .outclk_0(clk_100), 
-        .outclk_1(clk_25_vga)
-    );
-
-    localparam REFRESH_SCREEN = 3'b000, LOAD = 3'b001, STORE = 3'b010, NHI_ALG = 3'b011;
-    //Instruções
-    localparam PR_ALG = 3'b100, BA_ALG = 3'b101, NH_ALG = 3'b110, RESET_INST = 3'b111;
-    //instruções
-    localparam IDLE = 3'b00, READ_AND_WRITE = 3'b001, ALGORITHM = 3'b010, RESET = 3'b011, COPY_READ = 3'b100, COPY_WRITE = 3'b101, WAIT_WR_OR_RD = 3'b111;
-    // estados
-
-    // --- Sinais de Controle da FSM ---
-    reg [2:0] uc_state;
-    reg [2:0] last_instruction;
-
-    // Registradores para armazenar os offsets de zoom/pan enviados pelo HPS
-    reg [16:0] zoom_x_offset; // Vem de MEM_ADDR (17 bits)
-    reg [7:0]  zoom_y_offset; // Vem de DATA_IN (8 bits)
-
-    // --- Lógica de Gatilho ---
-    reg  enable_ff;
-    wire enable_pulse;
-
-    always @(posedge clk_100) enable_ff <= !ENABLE;
-    assign enable_pulse = !ENABLE && !enable_ff;
-
-    // --- Sinais do VGA ---
-    wire [9:0] next_x, next_y;
-    reg [16:0] addr_from_vga;
-    reg        inside_box;
-
-    //================================================================
-    // 2. Lógica de Gerenciamento das 3 Memórias
-    //================================================================
-
-    reg [16:0] addr_mem2, addr_mem3;
-    wire [16:0] addr_mem1;
-    wire [7:0] data_in_mem3;
-    reg [7:0]  data_in_mem1, data_in_mem2;
-    reg        wren_mem1, wren_mem2;
-    reg wren_mem3;
-    wire [7:0] data_out_mem1, data_out_mem2, data_out_mem3;
-
-    //memoria que guarda a imagem original
-    mem1 memory1(
-        .rdaddress(addr_mem1), 
-        .wraddress(addr_wr_mem1), 
-        .clock(clk_100), 
-        .data(data_in_mem1), 
-        .wren(wren_mem1), 
-        .q(data_out_mem1)
-    );
-
-    //memoria de exibiçao
-    mem1 memory2(
-        .rdaddress(addr_mem2), 
-        .wraddress(addr_wr_mem2), 
-        .clock(clk_100), 
-        .data(data_in_mem2), 
-        .wren(wren_mem2), 
-        .q(data_out_mem2)
-    );
-
-    //memoria de trabalho
-    mem1 memory3(
-        .rdaddress(addr_mem3), 
-        .wraddress(addr_for_write), 
-        .clock(clk_100), 
-        .data(data_to_write), 
-        .wren(wren_mem3), 
-        .q(data_out_mem3)
-    );
-
-    assign addr_mem1 = (uc_state != ALGORITHM && uc_state != WAIT_WR_OR_RD && uc_state != READ_AND_WRITE) ? addr_for_copy: addr_for_read;
-
-    //================================================================
-    // 3. Lógica do VGA
-    //================================================================
-    always @(posedge clk_25_vga) begin
-        localparam X_START=159, Y_START=119, X_END=X_START+320, Y_END=Y_START+240;
-        reg [16:0] vga_offset;
-        if (next_x >= (X_START) && next_x <= (X_END) && next_y >= (Y_START) && next_y <= (Y_END )) begin
-            inside_box <= 1'b1;
-            vga_offset = (next_y - Y_START) * 320 + (next_x - X_START);
-            addr_from_vga <= vga_offset;
-        end else begin
-            inside_box <= 1'b0;
-            addr_from_vga <= 17'd0;
-        end
-    end
-    
-    reg [7:0] data_to_vga_pipe;
-    always @(posedge clk_100) begin
-        data_to_vga_pipe <= (inside_box) ? data_out_mem2:8'b0;
-    end 
-
-    reg [1:0] counter_rd_wr;
-
-    reg [16:0] counter_address;
-    //================================================================
-    // 4. Pipeline de Dados do Algoritmo
-    //================================================================
-    reg [2:0] next_zoom;
-    reg [2:0] current_zoom;
-    
-    reg has_alg_on_exec;
-
-    reg [16:0] addr_wr_mem2;
-
-    reg [16:0] addr_wr_mem1;
-
-    reg [9:0] new_x, new_y;
-    reg [9:0] old_x, old_y;
-    reg [16:0] addr_for_read;
-    reg [16:0] addr_for_write;
-
-    reg [7:0] data_to_write;
-    reg [16:0] needed_steps, current_step;
-    reg [3:0] op_step;
-
-    reg [31:0] data_to_avg;
-    reg [7:0] data_to_write_mem1;
-
-    assign FLAG_ZOOM_MAX = (current_zoom == 3'b111) ? 1'b1: 1'b0;
-    assign FLAG_ZOOM_MIN = (current_zoom == 3'b001) ? 1'b1: 1'b0;
-    
-    //================================================================
-    // 5. Máquina de Estados Finitos (FSM) Principal
-    //================================================================
-    always @(posedge clk_100) begin
-
-        case (uc_state) 
-            IDLE: begin 
-                has_alg_on_exec     <= 1'b0;
-                FLAG_DONE           <= 1'b1;
-                wren_mem1 <= 1'b0;
-                wren_mem2 <= 1'b0;
-                wren_mem3 <= 1'b0;
-
-                if (enable_pulse) begin
-                    counter_address <= 17'd0;
-                    counter_rd_wr <= 2'b0;
-                    if (INSTRUCTION == LOAD || INSTRUCTION == STORE) begin
-                        uc_state         <= READ_AND_WRITE;
-                        last_instruction <= INSTRUCTION;
-                    end else if (INSTRUCTION >= NHI_ALG && INSTRUCTION <= NH_ALG) begin
-                            
-                        // Captura os offsets X e Y enviados pelo HPS
-                        zoom_x_offset <= MEM_ADDR; // X offset
-                        zoom_y_offset <= DATA_IN;  // Y offset
-
-                        case (INSTRUCTION)
-                            // --- (Zoom Out: NH_ALG) ---
-                            NH_ALG:begin
-                                if (FLAG_ZOOM_MIN) begin
-                                    FLAG_DONE <= 1'b1;
-                                    uc_state <= IDLE;
-                                end else begin
-                                    next_zoom <=  current_zoom - 1'b1;
-                                    if (current_zoom == 3'b101) begin
-                                        uc_state <= COPY_READ;
-                                        last_instruction <= RESET_INST;
-                                    end
-                                    else if (current_zoom <= 3'b100) begin
-                                        last_instruction <= NH_ALG;
-                                        uc_state         <= ALGORITHM;
-                                    end else if (next_zoom > 3'b100) begin
-                                        last_instruction <= NHI_ALG;
-                                        uc_state         <= ALGORITHM;
-                                    end else begin
-                                        uc_state <= IDLE;
-                                    end
-                                end
-                            end
-                            
-                            // --- (Zoom In / Pan: NHI_ALG) ---
-                            NHI_ALG: begin
-                                // SEL_MEM = 0 -> Zoom In
-                                // SEL_MEM = 1 -> Pan
-                                
-                                // Só bloqueia se for um ZOOM IN (SEL_MEM=0) e já estiver no máximo
-                                if (FLAG_ZOOM_MAX && !SEL_MEM) begin
-                                    FLAG_DONE <= 1'b1;
-                                    uc_state <= IDLE;
-                                end else begin
-                                    
-                                    if (SEL_MEM) begin // É um comando PAN
-                                        next_zoom <= current_zoom; // MANTÉM o nível de zoom
-                                    end else begin // É um comando ZOOM IN
-                                        next_zoom <= current_zoom + 1'b1; // INCREMENTA o nível de zoom
-                                    end
-
-                                    // Se estamos em 1x (3'b011) E é um ZOOM IN (não PAN),
-                                    // precisamos copiar a imagem original (mem1) para a memória de trabalho (mem3) primeiro.
-                                    if (current_zoom == 3'b011 && !SEL_MEM) begin
-                                        uc_state <= COPY_READ;
-                                        last_instruction <= RESET_INST; // RESET_INST copia mem1 -> mem3 (se não for STORE) -> mem2
-                                    end
-                                    else begin // Se já estamos com zoom OU se é um comando PAN
-                                        last_instruction <= NHI_ALG; // Aplica o algoritmo direto
-                                        uc_state         <= ALGORITHM;
-                                    end
-                                end
-                            end
-                            
-                            // --- (Zoom Out: BA_ALG) ---
-                            BA_ALG:begin
-                                if (FLAG_ZOOM_MIN) begin
-                                    FLAG_DONE <= 1'b1;
-                                    uc_state <= IDLE;
-                                end else begin
-                                    next_zoom <=  current_zoom - 1'b1;
-                                    if (current_zoom == 3'b101) begin
-                                        uc_state <= COPY_READ;
-                                        last_instruction <= RESET_INST;
-                                    end
-                                    else if (current_zoom <= 3'b100) begin
-                                        last_instruction <= BA_ALG;
-                                        uc_state         <= ALGORITHM;
-                                    end else if (current_zoom > 3'b100) begin
-                                        last_instruction <= PR_ALG;
-                                        uc_state         <= ALGORITHM;
-                                    end else begin
-                                        uc_state <= IDLE;
-                                    end
-                                    
-                                end
-                            end
-
-                            // --- (Zoom In / Pan: PR_ALG) ---
-                            PR_ALG: begin
-                                // SEL_MEM = 0 -> Zoom In
-                                // SEL_MEM = 1 -> Pan
-
-                                // Só bloqueia se for um ZOOM IN (SEL_MEM=0) e já estiver no máximo
-                                if (FLAG_ZOOM_MAX && !SEL_MEM) begin
-                                    FLAG_DONE <= 1'b1;
-                                    uc_state <= IDLE;
-                                end else begin
-                                
-                                    if (SEL_MEM) begin // É um comando PAN
-                                        next_zoom <= current_zoom; // MANTÉM o nível de zoom
-                                    end else begin // É um comando ZOOM IN
-                                        next_zoom <=  current_zoom + 1'b1; // INCREMENTA o nível de zoom
-                                    end
-
-                                    // Se estamos em 1x (3'b011) E é um ZOOM IN (não PAN),
-                                    // precisamos copiar a imagem original (mem1) para a memória de trabalho (mem3) primeiro.
-                                    if (current_zoom == 3'b011 && !SEL_MEM) begin
-                                        uc_state <= COPY_READ;
-                                        last_instruction <= RESET_INST; // RESET_INST copia mem1 -> mem3 (se não for STORE) -> mem2
-                                    end
-                                    else begin // Se já estamos com zoom OU se é um comando PAN
-                                        last_instruction <= PR_ALG; // Aplica o algoritmo direto
-                                        uc_state         <= ALGORITHM;
-                                    end
-                                end
-                            end
-
-                        endcase
-                        
-                        counter_address <= 17'd0;
-                        counter_rd_wr <= 2'b0;
-                        
-                    end else if (INSTRUCTION == RESET_INST) begin
-                        last_instruction <= 3'b111;
-                        uc_state <= RESET;
-                        counter_address <= 17'd0;
-                        counter_rd_wr <= 2'b0;
-                    end else if (INSTRUCTION == REFRESH_SCREEN) begin
-                        last_instruction <= 3'b111;
-                        uc_state <= COPY_READ;
-                        counter_address <= 17'd0;
-                        counter_rd_wr <= 2'b0;
-                    end
-                end
-            end
-            
-            READ_AND_WRITE: begin
-                if (MEM_ADDR > 17'd76799) begin
-                    FLAG_ERROR <= 1'b1;
-                end
-                FLAG_DONE <= 1'b0;
-                if (last_instruction == STORE) begin
-                    addr_wr_mem1 <= MEM_ADDR;
-                    data_in_mem1 <= DATA_IN;
-                    wren_mem1 <= 1'b1;
-                    uc_state <= WAIT_WR_OR_RD;
-                    counter_rd_wr <= 2'b00;
-                end else begin
-                    if (SEL_MEM) begin
-                        counter_address <= MEM_ADDR;
-                        wren_mem3 <= 1'b0;
-                    end else begin
-                        addr_for_read <= MEM_ADDR;
-                        wren_mem1 <= 1'b0;
-                    end
-                    counter_rd_wr <= 2'b0;
-                    uc_state <= WAIT_WR_OR_RD;
-                end
-            end
-
-            ALGORITHM: begin
-                wren_mem1 <= 1'b0;
-                FLAG_DONE <= 1'b0;
-                case (last_instruction)
-                    // --- (Lógica do PR_ALG - usa zoom_x_offset e zoom_y_offset) ---
-                    PR_ALG: begin
-                        if (!has_alg_on_exec) begin
-                            current_step <= 19'd0;
-                            has_alg_on_exec <= 1'b1;
-                            needed_steps <= 19'd19199;
-                            op_step <= 3'b0;
-                            new_x <= 10'b0;
-                            new_y <= 10'b0;
-                            
-                            // O old_x/y inicial (para new_x=0, new_y=0) deve ser o offset
-                            old_x <= zoom_x_offset; 
-                            old_y <= zoom_y_offset;
-
-                        end else begin
-                            if (current_step >= needed_steps) begin
-                                counter_address <= 17'd0;
-                                counter_rd_wr <= 2'b0;
-                                has_alg_on_exec <= 1'b0;
-                                wren_mem3 <= 1'b0;
-                                
-                                uc_state <= COPY_READ;
-                            end else begin
-                                if (op_step == 3'b000) begin
-                                    addr_for_read <= old_x + (old_y*10'd320);
-                                    counter_rd_wr <= 2'b0;
-                                    op_step <= 3'b001;
-                                    wren_mem3 <= 1'b0;
-                                    uc_state <= WAIT_WR_OR_RD;
-                                end else if (op_step == 3'b001) begin
-                                    data_to_write <= data_out_mem1;
-                                    counter_rd_wr <= 2'b0;
-                                    addr_for_write <= new_x + (new_y*10'd320);
-                                    wren_mem3 <= 1'b1;
-                                    op_step <= 3'b010;
-                                    uc_state <= WAIT_WR_OR_RD;
-                                    new_x <= new_x + 1'b1;
-                                end else if (op_step == 3'b010) begin
-                                    data_to_write <= data_out_mem1;
-                                    counter_rd_wr <= 2'b0;
-                                    addr_for_write <= new_x + (new_y*10'd320);
-                                    wren_mem3 <= 1'b1;
-                                    op_step <= 3'b011;
-                                    uc_state <= WAIT_WR_OR_RD;
-                                    new_x <= new_x - 1'b1;
-                                    new_y <= new_y + 1'b1;
-                                end else if (op_step == 3'b011) begin
-                                    data_to_write <= data_out_mem1;
-                                    counter_rd_wr <= 2'b0;
-                                    addr_for_write <= new_x + (new_y*10'd320);
-                                    wren_mem3 <= 1'b1;
-                                    op_step <= 3'b100;
-                                    uc_state <= WAIT_WR_OR_RD;
-                                    new_x <= new_x + 1'b1;
-                                end else if (op_step == 3'b100) begin
-                                    data_to_write <= data_out_mem1;
-                                    counter_rd_wr <= 2'b0;
-                                    addr_for_write <= new_x + (new_y*10'd320);
-                                    wren_mem3 <= 1'b1;
-                                    op_step <= 3'b000;
-                                    uc_state <= WAIT_WR_OR_RD;
-                                    
-                                    if (new_x >= 10'd319) begin
-                                        new_x <= 10'd0;
-                                        new_y <= new_y + 1'b1;
-
-                                        if (next_zoom == 3'b101) begin
-                                            old_x <= zoom_x_offset;
-                                            old_y <= (new_y >> 2'b1) + zoom_y_offset;
-                                        end else if (next_zoom == 3'b110) begin
-                                            old_x <= zoom_x_offset;
-                                            old_y <= (new_y >> 2'd2) + zoom_y_offset;
-                                        end else  if (next_zoom == 3'b111) begin
-                                            old_x <= zoom_x_offset;
-                                            old_y <= (new_y>>2'd3) + zoom_y_offset;
-                                        end else begin
-                                            old_x <= new_x;
-                                            old_y <= new_y;
-                                        end
-                                    end else begin
-                                        new_x <= new_x + 1'b1;
-                                        new_y <= new_y - 1'b1;
-                                        
-                                        if (next_zoom == 3'b101) begin
-                                            old_x <= (new_x >> 1'b1) + zoom_x_offset;
-                                        end else if(next_zoom == 3'b110) begin
-                                            old_x <= (new_x >> 2'd2) + zoom_x_offset;
-                                        end else if (next_zoom == 3'b111) begin
-                                            old_x <= (new_x >> 2'd3) + zoom_x_offset;
-                                        end else begin
-                                            old_x <= new_x;
-                                        end
-                                        current_step <= current_step + 1;
-                                    end
-                                end
-                            end
-                        end
-                    end
-
-                    // --- (Lógica do NHI_ALG - usa zoom_x_offset e zoom_y_offset) ---
-                    NHI_ALG: begin
-                        if (!has_alg_on_exec) begin
-                            has_alg_on_exec <= 1'b1;
-                            current_step <= 19'd0;
-                            needed_steps <= 19'd76799;
-                            op_step <= 3'b0;
-                            new_x <= 10'b0;
-                            new_y <= 10'b0;
-
-                            old_x <= zoom_x_offset;
-                            old_y <= zoom_y_offset;
-
-                        end else begin
-                            if (current_step >= needed_steps) begin
-                                counter_address <= 17'd0;
-                                counter_rd_wr <= 2'b0;
-                                has_alg_on_exec <= 1'b0;
-                                wren_mem3 <= 1'b0;
-                                
-                                uc_state <= COPY_READ;
-                            end else begin
-                                if (op_step == 3'b000) begin
-                                    addr_for_read <= old_x + (old_y*10'd320);
-                                    counter_rd_wr <= 2'b0;
-                                    op_step <= 3'b001;
-                                    wren_mem3 <= 1'b0;
-                                    uc_state <= WAIT_WR_OR_RD;
-                                end else if (op_step == 3'b001) begin
-                                    current_step <= current_step + 1'b1;
-                                    data_to_write <= data_out_mem1;
-                                    counter_rd_wr <= 2'b0;
-                                    addr_for_write <= new_x + (new_y*10'd320);
-                                    wren_mem3 <= 1'b1;
-                                    op_step <= 3'b000;
-                                    uc_state <= WAIT_WR_OR_RD;
-
-                                    if (new_x >= 10'd319) begin
-                                        new_x <= 10'd0;
-                                        new_y <= new_y + 1'b1;
-                                        
-                                        if (next_zoom == 3'b101) begin
-                                            old_x <= zoom_x_offset;
-                                            old_y <= (new_y>>1'b1) + zoom_y_offset;
-                                        end else if (next_zoom == 3'b110) begin
-                                            old_x <= zoom_x_offset;
-                                            old_y <= (new_y>>2'd2) + zoom_y_offset;
-                                        end else if (next_zoom == 3'b111) begin
-                                            old_x <= zoom_x_offset;
-                                            old_y <= (new_y>>2'd3) + zoom_y_offset;
-                                        end else begin
-                                            old_x <= new_x;
-                                            old_y <= new_y;
-                                        end
-                                        
-                                    end else begin
-                                        new_x <= new_x + 1'b1;
-                                        
-                                        if (next_zoom == 3'b101) begin
-                                            old_x <= (new_x>>1'b1) + zoom_x_offset;
-                                        end else if (next_zoom == 3'b110) begin
-                                            old_x <= (new_x>>2'd2) + zoom_x_offset;
-                                        end else if (next_zoom == 3'b111) begin
-                                            old_x <= (new_x>>2'd3) + zoom_x_offset;
-                                        end else begin
-                                            old_x <= new_x;
-                                        end
-                                    end
-                                end
-                            end
-                        end
-                    end
-                    
-                    // --- (Lógicas de Zoom Out - sem mudanças) ---
-                    BA_ALG: begin
-                        if (!has_alg_on_exec) begin
-                            has_alg_on_exec <= 1'b1;
-                            current_step <= 19'd0;
-                            needed_steps <= 19'd76799;
-                            op_step <= 3'b0;
-                            new_x <= 10'b0;
-                            new_y <= 10'b0;
-                            old_x <= 10'd0;
-                            old_y <= 10'd0;
-                            
-                        end else begin
-                            if (current_step >= needed_steps) begin
-                                counter_address <= 17'd0;
-                                counter_rd_wr <= 2'b0;
-                                has_alg_on_exec <= 1'b0;
-                                wren_mem3 <= 1'b0;
-                                uc_state <= COPY_READ;
-                            end else begin
-                                if ((((new_x < 10'd80 || new_x > 10'd239 ) || (new_y < 10'd60 ||  new_y > 10'd179)) && next_zoom == 3'b011) || (((new_x < 10'd120 || new_x > 10'd199 ) || (new_y < 10'd90 ||  new_y > 10'd149)) && next_zoom == 3'b010) || (((new_x < 10'd140 || new_x > 10'd179 ) || (new_y < 10'd105 ||  new_y > 10'd134)) && next_zoom == 3'b001)) 
-                                begin
-                                    current_step <= current_step + 1'b1;
-                                    data_to_write <= 8'b0;
-                                    counter_rd_wr <= 2'b0;
-                                    wren_mem3 <= 1'b1;
-                                    addr_for_write <= new_x + (new_y*10'd320);
-                                    op_step <= 3'b000;
-                                    if(new_x >= 10'd319) begin
-                                        new_x <= 10'd0;
-                                        new_y <= new_y + 1'b1;
-                                    end else begin
-                                        new_x <= new_x + 1'b1;
-                                    end
-                                    uc_state <= WAIT_WR_OR_RD;
-                                end else begin
-                                    if (op_step == 3'b000) begin
-                                        addr_for_read <= old_x + (old_y*10'd320);
-                                        counter_rd_wr <= 2'b0;
-                                        wren_mem3 <= 1'b0;
-                                        uc_state <= WAIT_WR_OR_RD;
-                                        if (next_zoom == 3'b011) begin
-                                            old_x <= old_x + 1'b1;
-                                        end else if (next_zoom == 3'b010) begin
-                                            old_x <= old_x + 2'd2;
-                                        end else if (next_zoom == 3'b001) begin
-                                            old_x <= old_x + 3'd4;
-                                        end
-                                        op_step <= 3'b001;
-                                    end else if (op_step == 3'b001) begin
-                                        data_to_avg[7:0] <= data_out_mem1;
-                                        addr_for_read <= old_x + (old_y*10'd320);
-                                        counter_rd_wr <= 2'b0;
-                                        wren_mem3 <= 1'b0;
-                                        uc_state <= WAIT_WR_OR_RD;
-                                        if (next_zoom == 3'b011) begin
-                                            old_x <= old_x - 1'b1;
-                                            old_y <= old_y + 1'b1;
-                                        end else if (next_zoom == 3'b010) begin
-                                            old_x <= old_x - 2'd2;
-                                            old_y <= old_y + 2'd2;
-                                        end else if (next_zoom == 3'b001) begin
-                                            old_x <= old_x - 3'd4;
-                                            old_y <= old_y + 3'd4;
-                                        end
-                                        op_step <= 3'b010;
-                                    end else if (op_step == 3'b010) begin
-                                        data_to_avg[15:8] <= data_out_mem1;
-                                        addr_for_read <= old_x + (old_y*10'd320);
-                                        counter_rd_wr <= 2'b0;
-                                        wren_mem3 <= 1'b0;
-                                        uc_state <=WAIT_WR_OR_RD;
-                                        if (next_zoom == 3'b011) begin
-                                            old_x <= old_x + 1'b1;
-                                        end else if (next_zoom == 3'b010) begin
-                                            old_x <= old_x + 2'd2;
-                                        end else if (next_zoom == 3'b001) begin
-                                            old_x <= old_x + 3'd4;
-                                        end
-                                        op_step <= 3'b011;
-                                    end else if (op_step == 3'b011) begin
-                                        data_to_avg[23:16] <= data_out_mem1;
-                                        addr_for_read <= old_x + (old_y*10'd320);
-                                        counter_rd_wr <= 2'b0;
-                                        wren_mem3 <= 1'b0;
-                                        uc_state <= WAIT_WR_OR_RD;
-                                        if (((old_x >= 10'd319) && (next_zoom == 3'b011)) || ((old_x >= 10'd318) && (next_zoom == 3'b010)) || ((old_x >= 10'd316) && (next_zoom == 3'b001))) begin
-                                            old_x <= 10'd0;
-                                            if (next_zoom == 3'b011) begin
-                                                old_y <= old_y + 1'b1;
-                                            end else if (next_zoom == 3'b010) begin
-                                                old_y <= old_y + 2'd2;
-                                            end else if (next_zoom == 3'b001) begin
-                                                old_y <= old_y + 3'd4;
-                                            end
-                                        end else begin
-                                            if (next_zoom == 3'b011) begin
-                                                old_y <= old_y - 1'b1;
-                                                old_x <= old_x + 1'b1;
-                                            end else if (next_zoom == 3'b010) begin
-                                                old_y <= old_y - 2'd2;
-                                                old_x <= old_x + 2'd2;
-                                            end else if (next_zoom == 3'b001) begin
-                                                old_y <= old_y - 3'd4;
-                                                old_x <= old_x + 3'd4;
-                                            end
-                                        end
-                                        op_step <= 3'b100;
-                                    end else if (op_step == 3'b100) begin
-                                        data_to_avg[31:24] <= data_out_mem1;
-                                        uc_state <= ALGORITHM;
-                                        op_step <= 3'b101;
-                                    end else if (op_step == 3'b101) begin
-                                        current_step <= current_step + 1'b1;
-                                        data_to_write <= (data_to_avg>> 2'd2);
-                                        addr_for_write <= new_x + (new_y*10'd320);
-                                        counter_rd_wr <= 2'b0;
-                                        wren_mem3 <= 1'b1;
-                                        op_step <= 3'b000;
-                                        if (new_x >= 10'd319) begin
-                                            new_x <= 10'd0;
-                                            new_y <= new_y + 1'b1;
-                                        end else begin
-                                            new_x <= new_x + 1'b1;
-                                        end
-                                        uc_state <= WAIT_WR_OR_RD;
-                                    end
-                                end
-                            end
-                        end
-                    end
-                    
-                    NH_ALG: begin
-                        if (!has_alg_on_exec) begin
-                            has_alg_on_exec <= 1'b1;
-                            current_step <= 19'd0;
-                            needed_steps <= 19'd76799;
-                            op_step <= 3'b0;
-                            new_x <= 10'b0;
-                            new_y <= 10'b0;
-                            old_x <= 10'd0;
-                            old_y <= 10'd0;
-                            
-                        end else begin
-                            if (current_step >= needed_steps) begin
-                                counter_address <= 17'd0;
-                                counter_rd_wr <= 2'b0;
-                                has_alg_on_exec <= 1'b0;
-                                wren_mem3 <= 1'b0;
-                                
-                                uc_state <= COPY_READ;
-                            end else begin
-                                if ((((new_x < 10'd80 || new_x > 10'd239 ) || (new_y < 10'd60 ||  new_y > 10'd179)) && next_zoom == 3'b011) || (((new_x < 10'd120 || new_x > 10'd199 ) || (new_y < 10'd90 ||  new_y > 10'd149)) && next_zoom == 3'b010) || (((new_x < 10'd140 || new_x > 10'd179 ) || (new_y < 10'd105 ||  new_y > 10'd134)) && next_zoom == 3'b001)) 
-                                begin
-                                    current_step <= current_step + 1'b1;
-                                    data_to_write <= 8'b0;
-                                    counter_rd_wr <= 2'b0;
-                                    wren_mem3 <= 1'b1;
-                                    addr_for_write <= new_x + (new_y*10'd320);
-                                    op_step <= 3'b000;
-                                    if(new_x >= 10'd319) begin
-                                        new_x <= 10'd0;
-                                        new_y <= new_y + 1'b1;
-                                    end else begin
-                                        new_x <= new_x + 1'b1;
-                                    end
-                                    uc_state <= WAIT_WR_OR_RD;
-                                end else begin
-                                    if (op_step == 3'b000) begin
-                                        if (next_zoom == 3'b011) begin
-                                            addr_for_read <= (old_x<<1) + ((old_y<<1)*10'd320);
-                                        end else if (next_zoom == 3'b010) begin
-                                            addr_for_read <= (old_x<<2) + ((old_y<<2)*10'd320);
-                                        end else if (next_zoom == 3'b001) begin
-                                            addr_for_read <= (old_x<<3) + ((old_y<<3)*10'd320);
-                                        end
-                                        
-                                        counter_rd_wr <= 2'b0;
-                                        wren_mem3 <= 1'b0;
-                                        uc_state <= WAIT_WR_OR_RD;
-                                        if (next_zoom == 3'b011) begin
-                                            if (old_x >= 10'd159) begin
-                                                old_x <= 10'd0;
-                                                old_y <= old_y + 2'd1;
-                                            end else begin
-                                                old_x <= old_x + 2'd1;
-                                            end
-                                        end else if (next_zoom == 3'b010) begin
-                                            if (old_x >= 10'd79) begin
-                                                old_x <= 10'd0;
-                                                old_y <= old_y + 2'd1;
-                                            end else begin
-                                                old_x <= old_x + 2'd1;
-                                            end
-                                        end else if (next_zoom == 3'b001) begin
-                                            if (old_x >= 10'd39) begin
-                                                old_x <= 10'd0;
-                                                old_y <= old_y + 2'd1;
-                                            end else begin
-                                                old_x <= old_x + 2'd1;
-                                            end
-                                        end else begin
-                                            old_x <= new_x;
-                                            old_y <= new_y;
-                                        end
-                                        op_step <= 3'b001;
-                                    end else if (op_step == 3'b001) begin
-                                        current_step <= current_step + 1'b1;
-                                        data_to_write <= data_out_mem1;
-                                        counter_rd_wr <= 2'b0;
-                                        addr_for_write <= new_x + (new_y*10'd320);
-                                        wren_mem3 <= 1'b1;
-                                        op_step <= 3'b000;
-                                        uc_state <= WAIT_WR_OR_RD;
-                                        if (new_x >= 10'd319) begin
-                                            new_x <= 10'd0;
-                                            new_y <= new_y + 1'b1;
-                                        end else begin
-                                            new_x <= new_x + 1'b1;
-                                        end
-                                    end
-                                end
-                            end
-                        end
-                    end
-                endcase
-            end
-
-            RESET: begin
-                FLAG_DONE <= 1'b0;
-                next_zoom <= 3'b100;
-                FLAG_ERROR <= 1'b0;
-                last_instruction <= RESET_INST;
-                
-                counter_address <= 17'd0;
-                counter_rd_wr <= 2'b0;
-                uc_state       <= COPY_READ;
-
-            end
-
-            COPY_READ: begin
-                if(counter_rd_wr == 2'b10) begin
-                    wren_mem2 <= 1'b0;
-                    counter_rd_wr <= 2'b00;
-                    uc_state <= COPY_WRITE;
-                    
-                end else begin
-                    counter_rd_wr <= counter_rd_wr + 1;
-                end
-            end
-
-            COPY_WRITE: begin
-
-                // Se for RESET ou STORE, copia mem1 -> mem2
-                if (last_instruction == RESET_INST || last_instruction == STORE) begin
-                    data_in_mem2 <= data_out_mem1;
-                // Se for um algoritmo (ex: PR_ALG, NHI_ALG, etc.), copia mem3 -> mem2
-                end else begin
-                    data_in_mem2 <= data_out_mem3;
-                end
-                addr_wr_mem2 <= counter_address;
-                wren_mem2    <= 1'b1;
-                
-                if (counter_rd_wr == 2'b10) begin
-                    counter_rd_wr <= 2'b00;
-                    if (counter_address == 17'd76799) begin // 320*240 - 1
-                        current_zoom <= next_zoom;
-                        FLAG_DONE <= 1'b1;
-                        uc_state <= IDLE; // Cópia concluída
-                        
-                    end else begin
-                        counter_address <= counter_address + 1'b1;
-                        uc_state <= COPY_READ;
-                    end
-                end else begin
-                    counter_rd_wr <= counter_rd_wr + 1;
-                end
-            end
-
-            WAIT_WR_OR_RD: begin
-                if (counter_rd_wr == 2'b10) begin
-                    counter_rd_wr <= 2'b00;
-                    if (last_instruction == LOAD) begin
-                        uc_state <= IDLE;
-                        if (SEL_MEM) begin
-                            DATA_OUT <= data_out_mem3;
-                        end else begin
-                            DATA_OUT <= data_out_mem1;
-                        end
-                        FLAG_DONE <= 1'b1;
-                    end else if (last_instruction == STORE) begin
-                        uc_state <= IDLE;
-                        wren_mem1 <= 1'b0;
-                        counter_rd_wr <= 2'b0;
-                        counter_address <= 17'd0;
-                    end else begin
-                        wren_mem3 <= 1'b0;
-                        uc_state <= ALGORITHM;
-                    end
-                end else begin
-                    counter_rd_wr <= counter_rd_wr + 1;
-                end
-            end
-            
-            default: uc_state <= IDLE;
-        endcase
-    
-    end
-
-    reg [16:0] addr_for_copy;
-
-    always @(*) begin
-        // Endereçamento
-        // Se for um RESET ou STORE, a cópia (leitura) vem da mem1
-        if (last_instruction == RESET_INST || last_instruction == STORE) begin
-            addr_for_copy <= counter_address;
-        // Se for um algoritmo, a cópia (leitura) vem da mem3
-        end else begin
-            addr_mem3 <= counter_address;
-        end
-        
-        addr_mem2 <= addr_from_vga;
-    end
-
-    wire [16:0] addr_from_memory_control_wr;
-    wire [16:0] addr_from_memory_control_rd;
-
-    //================================================================
-    // 6. Instâncias de Módulos
-    //================================================================
-
-    vga_module vga_out(.clock(clk_25_vga), 
-    .reset(1'b0), 
-    .color_in(data_to_vga_pipe), 
-    .next_x(next_x), 
-    .next_y(next_y), 
-    .hsync(VGA_H_SYNC_N), 
-    .vsync(VGA_V_SYNC_N), 
-    .red(VGA_R), 
-    .green(VGA_G), 
-    .blue(VGA_B), 
-    .sync(VGA_SYNC), 
-    .clk(VGA_CLK), 
-    .blank(VGA_BLANK_N));
-    
+module main(
+    // Portas de Entrada
+    CLOCK_50,
+    INSTRUCTION,
+    DATA_IN,
+    MEM_ADDR,
+    SEL_MEM,
+    ENABLE,
+
+    // Portas de Saída e Debug
+    DATA_OUT,
+    FLAG_DONE,
+    FLAG_ERROR,
+    FLAG_ZOOM_MAX,
+    FLAG_ZOOM_MIN,
+    STATUS,
+    VGA_R,
+    VGA_B, 
+    VGA_G,
+    VGA_BLANK_N,
+    VGA_H_SYNC_N, 
+    VGA_V_SYNC_N, 
+    VGA_CLK, 
+    VGA_SYNC
+);
+
+    input CLOCK_50;
+    input [2:0] INSTRUCTION;
+    input [7:0] DATA_IN;
+    input [16:0] MEM_ADDR;
+    input SEL_MEM;
+    input ENABLE;
+
+    // Portas de Saída e Debug
+    output reg [7:0] DATA_OUT; // pio_dataout: pixel do LOAD ou um byte do registrador do CTRL_STATS_READ
+    output reg FLAG_DONE;
+    output reg FLAG_ERROR;
+    output FLAG_ZOOM_MAX;
+    output FLAG_ZOOM_MIN;
+    output [27:0] STATUS; // pio_flags[31:4], ver "Palavra de status" abaixo
+    output [7:0] VGA_R;
+    output [7:0] VGA_B; 
+    output [7:0] VGA_G;
+    output VGA_BLANK_N;
+    output VGA_H_SYNC_N; 
+    output VGA_V_SYNC_N;
+    output VGA_CLK;
+    output VGA_SYNC;
+    //================================================================
+    // 1. Definições, Clocks e Sinais
+    //================================================================
+    wire clk_engine, clk_25_vga;
+
+    // clk_engine (outclk_0, 100 MHz) move a FSM, as memórias e a pirâmide
+    pll pll0(
+        .refclk(CLOCK_50), 
+        .rst(1'b0), 
+        .outclk_0(clk_engine), 
+        .outclk_1(clk_25_vga)
+    );
+
+    localparam REFRESH_SCREEN = 3'b000, LOAD = 3'b001, STORE = 3'b010, NHI_ALG = 3'b011;
+    //Instruções
+    localparam PR_ALG = 3'b100, BA_ALG = 3'b101, NH_ALG = 3'b110, RESET_INST = 3'b111;
+    //instruções
+    localparam IDLE = 4'b0000, READ_AND_WRITE = 4'b0001, ALGORITHM = 4'b0010, RESET = 4'b0011, COPY_READ = 4'b0100, COPY_WRITE = 4'b0101, RECT_WRITE = 4'b0110, WAIT_WR_OR_RD = 4'b0111;
+    localparam PYR_BUILD = 4'b1000, PYR_COPY = 4'b1001, FILTER = 4'b1010, STATS = 4'b1011, STATS_READ = 4'b1100;
+    // estados
+
+    // Instruções estendidas (REFRESH_SCREEN com SEL_MEM = 1): sub-operação em MEM_ADDR[16:15]
+    localparam EXT_RECT_ORIGIN = 2'b00, EXT_RECT_SIZE = 2'b01, EXT_RECT_RUN = 2'b10, EXT_CTRL = 2'b11;
+    // Comandos de EXT_CTRL (MEM_ADDR[14:11]); 4'b1LLL = SET_ZOOM para o nível LLL
+    localparam CTRL_PYRAMID_BUILD = 4'b0000, CTRL_ABORT = 4'b0001, CTRL_FILTER_COEF = 4'b0010, CTRL_FILTER_RUN = 4'b0011;
+    localparam CTRL_STATS_START = 4'b0100, CTRL_STATS_READ = 4'b0101, CTRL_LUT = 4'b0110, CTRL_CONFIG = 4'b0111;
+    // Registradores do CTRL_CONFIG (MEM_ADDR[10:8]) e seus valores (MEM_ADDR[7:0])
+    localparam CONFIG_PIXEL_FORMAT = 3'b000, CONFIG_ORIENTATION = 3'b001, CONFIG_SCANOUT = 3'b010;
+    // Retângulo sobreposto: ligado em CONFIG_OVERLAY; posição e tamanho usam
+    // dois registradores cada (MEM_ADDR[8] é o bit 8 de x ou de w - 1)
+    localparam CONFIG_OVERLAY = 3'b011, CONFIG_OVERLAY_POS = 2'b10, CONFIG_OVERLAY_SIZE = 2'b11;
+    localparam PIXEL_GRAY8 = 8'd0, PIXEL_RGB332 = 8'd1;
+    localparam SCANOUT_BOX = 2'd0, SCANOUT_2X = 2'd1, SCANOUT_2X_BILINEAR = 2'd2;
+
+    // SET_ZOOM: MEM_ADDR[10:9] = algoritmo - NHI_ALG, MEM_ADDR[8:0] = x, DATA_IN = y
+    wire [2:0] set_zoom_level = MEM_ADDR[13:11];
+    wire [2:0] set_zoom_alg   = {1'b0, MEM_ADDR[10:9]} + NHI_ALG;
+    wire       set_zoom_ok    = (set_zoom_level == 3'b100) ||
+                                (set_zoom_level >  3'b100 && (set_zoom_alg == PR_ALG || set_zoom_alg == NHI_ALG)) ||
+                                (set_zoom_level != 3'b000 && set_zoom_level < 3'b100 && (set_zoom_alg == BA_ALG || set_zoom_alg == NH_ALG));
+
+    // Formato do pixel (CTRL_CONFIG/CONFIG_PIXEL_FORMAT): cinza de 8 bits
+    // (valor de power-up) ou RGB332 (RRRGGGBB). Só o BA e a saída de vídeo
+    // olham o formato; PR, NHI e NH copiam bytes.
+    reg pixel_rgb332;
+
+    // Orientação da imagem na tela (CTRL_CONFIG/CONFIG_ORIENTATION), aplicada
+    // na leitura da memory2 pelo VGA: {troca x/y, espelha x, espelha y}.
+    // Com a troca (90/270 graus) a caixa fica em pé, 240x320. As memórias e
+    // os algoritmos não mudam.
+    reg [2:0] orientation;
+
+    // Saída de vídeo (CTRL_CONFIG/CONFIG_SCANOUT): caixa de 320x240 no
+    // centro (power-up) ou a tela toda, com cada pixel 640x480 lendo
+    // (x >> 1, y >> 1), opcionalmente com filtro bilinear. Nas orientações
+    // com troca de x/y a imagem em pé não cabe em 2x e fica na caixa.
+    reg [1:0] scanout;
+
+    // Retângulo sobreposto à imagem na saída de vídeo (CONFIG_OVERLAY*): a
+    // borda de 1 pixel da imagem sai com as cores invertidas. Fica nas
+    // coordenadas da memória, então acompanha a orientação e a tela cheia.
+    // Mover o retângulo é uma instrução, sem recalcular a imagem.
+    reg       overlay_on;
+    reg [8:0] overlay_x, overlay_w_m1;
+    reg [7:0] overlay_y, overlay_h_m1;
+
+    // Média do BA entre o primeiro (p0) e o segundo (p1) pixel do bloco. Em
+    // cinza é o byte montado de sempre; em RGB332, a média truncada de cada
+    // canal (somar bytes misturaria os canais).
+    function [7:0] ba_pixel;
+        input [7:0] p0, p1;
+        input       rgb332;
+        reg   [3:0] r, g;
+        reg   [2:0] b;
+        begin
+            if (rgb332) begin
+                r = p0[7:5] + p1[7:5];
+                g = p0[4:2] + p1[4:2];
+                b = p0[1:0] + p1[1:0];
+                ba_pixel = {r[3:1], g[3:1], b[2:1]};
+            end else begin
+                ba_pixel = {p1[1:0], p0[7:2]};
+            end
+        end
+    endfunction
+
+    // Média de dois pixels vizinhos (filtro bilinear do VGA), por canal em RGB332
+    function [7:0] mid_pixel;
+        input [7:0] a, b;
+        input       rgb332;
+        reg   [8:0] s;
+        reg   [3:0] r, g;
+        reg   [2:0] bl;
+        begin
+            s  = a + b;
+            r  = a[7:5] + b[7:5];
+            g  = a[4:2] + b[4:2];
+            bl = a[1:0] + b[1:0];
+            mid_pixel = rgb332 ? {r[3:1], g[3:1], bl[2:1]} : s[8:1];
+        end
+    endfunction
+
+    // --- Sinais de Controle da FSM ---
+    reg [3:0] uc_state;
+    reg [2:0] last_instruction;
+
+    // Registradores para armazenar os offsets de zoom/pan enviados pelo HPS
+    reg [16:0] zoom_x_offset; // Vem de MEM_ADDR (17 bits)
+    reg [7:0]  zoom_y_offset; // Vem de DATA_IN (8 bits)
+
+    // --- Lógica de Gatilho ---
+    reg  enable_ff;
+    wire enable_pulse;
+
+    always @(posedge clk_engine) enable_ff <= !ENABLE;
+    assign enable_pulse = !ENABLE && !enable_ff;
+
+    // --- Sinais do VGA ---
+    wire [9:0] next_x, next_y;
+    reg        inside_box;
+
+    //================================================================
+    // 2. Lógica de Gerenciamento das 3 Memórias
+    //================================================================
+    // Cada memória é dividida em LANES bancos intercalados por linha: o
+    // pixel (x, y) fica no banco y % LANES, no endereço local
+    // (y / LANES)*320 + x. Assim as LANES linhas de um grupo são lidas e
+    // escritas no mesmo ciclo, e uma varredura em ordem (cópia, pirâmide,
+    // VGA) anda de 1 em 1 no endereço local. Os bancos são pyramid_ram, com
+    // os mesmos 2 ciclos de leitura da mem1.
+    parameter LANES = 4; // 2, 4, 8 ou 16 (precisa dividir as 240 linhas)
+    localparam LANE_BITS  = $clog2(LANES);
+    localparam BANK_ROWS  = 240 / LANES;
+    localparam BANK_WORDS = BANK_ROWS * 320;
+    localparam BANK_AW    = $clog2(BANK_WORDS);
+    localparam LAST_BANK  = LANES - 1, LAST_LOCAL = BANK_WORDS - 1; // Pixel 76799
+
+    // memory1: imagem original (escrita pelo HPS, um pixel por vez)
+    reg  [LANE_BITS-1:0] wr_bank_mem1;
+    reg  [BANK_AW-1:0]   wr_local_mem1;
+    reg  [7:0]           data_in_mem1;
+    reg                  wren_mem1;
+    reg  [BANK_AW-1:0]   rd_local_mem1 [0:LANES-1];
+    wire [7:0]           q_mem1 [0:LANES-1];
+
+    // memory2: exibição (a cópia escreve todos os bancos no mesmo endereço local)
+    reg  [BANK_AW-1:0]   wr_local_mem2;
+    reg  [7:0]           data_in_mem2 [0:LANES-1];
+    reg  [LANES-1:0]     wren_mem2;
+    reg  [LANE_BITS-1:0] vga_bank;
+    reg  [BANK_AW-1:0]   vga_local;
+    wire [7:0]           q_mem2 [0:LANES-1];
+
+    // Filtro bilinear da saída 2x (seção 3). Nas colunas ímpares da tela o
+    // VGA já pede a coluna seguinte da imagem e tira a média com o pixel
+    // anterior (vga_prev); nas linhas ímpares, a linha seguinte, com a
+    // média vertical vinda de vga_line, que guarda a linha lida na linha
+    // par da tela. Fora desse modo vga_px é o pixel da memory2.
+    reg                  vga_h_odd, vga_v_odd, vga_lb_wr;
+    reg                  vga_overlay; // Pixel na borda do retângulo sobreposto
+    reg  [8:0]           vga_lb_col;
+    reg  [7:0]           vga_prev;
+    wire [7:0]           vga_lb_q;
+    wire [7:0]           vga_q    = q_mem2[vga_bank];
+    wire [7:0]           vga_vert = vga_v_odd ? mid_pixel(vga_lb_q, vga_q, pixel_rgb332) : vga_q;
+    wire [7:0]           vga_px   = vga_h_odd ? mid_pixel(vga_prev, vga_vert, pixel_rgb332) : vga_vert;
+
+    // memory3: trabalho. Cada faixa do motor (seção 4) escreve no seu banco
+    // (lane_*); wren_mem3/wr_local_mem3/data_to_write são as escritas do PYR_COPY e do FILTER
+    reg  [LANES-1:0]     lane_wren;
+    reg  [BANK_AW-1:0]   lane_wr_local [0:LANES-1];
+    reg  [7:0]           lane_wr_data [0:LANES-1];
+    reg  [BANK_AW-1:0]   wr_local_mem3;
+    reg  [7:0]           data_to_write;
+    reg  [LANES-1:0]     wren_mem3;
+    wire [BANK_AW-1:0]   rd_local_mem3;
+    wire [7:0]           q_mem3 [0:LANES-1];
+
+    genvar bank;
+    generate
+        for (bank = 0; bank < LANES; bank = bank + 1) begin : banks
+            //memoria que guarda a imagem original
+            pyramid_ram #(.ADDR_W(BANK_AW), .DEPTH(BANK_WORDS)) memory1(
+                .clock(clk_engine),
+                .wraddress(wr_local_mem1),
+                .data(data_in_mem1),
+                .wren(wren_mem1 && wr_bank_mem1 == bank),
+                .rdaddress(rd_local_mem1[bank]),
+                .q(q_mem1[bank])
+            );
+
+            //memoria de exibiçao
+            pyramid_ram #(.ADDR_W(BANK_AW), .DEPTH(BANK_WORDS)) memory2(
+                .clock(clk_engine),
+                .wraddress(wr_local_mem2),
+                .data(data_in_mem2[bank]),
+                .wren(wren_mem2[bank]),
+                .rdaddress(vga_local),
+                .q(q_mem2[bank])
+            );
+
+            //memoria de trabalho
+            pyramid_ram #(.ADDR_W(BANK_AW), .DEPTH(BANK_WORDS)) memory3(
+                .clock(clk_engine),
+                .wraddress(lane_wren[bank] ? lane_wr_local[bank] : wr_local_mem3),
+                .data(lane_wren[bank] ? lane_wr_data[bank] : data_to_write),
+                .wren(lane_wren[bank] || wren_mem3[bank]),
+                .rdaddress(rd_local_mem3),
+                .q(q_mem3[bank])
+            );
+        end
+    endgenerate
+
+    //----------------------------------------------------------------
+    // Pirâmide de zoom out: uma memória por nível (1/2, 1/4, 1/8), cada
+    // uma com a janela do BA_ALG seguida da janela do NH_ALG, byte a byte
+    // iguais ao que os algoritmos escrevem na mem3. Montada a partir da
+    // mem1 numa única passada (EXT_CTRL/CTRL_PYRAMID_BUILD).
+    //----------------------------------------------------------------
+    localparam PYR_NH_BASE_2 = 16'd19200, PYR_NH_BASE_4 = 14'd4800, PYR_NH_BASE_8 = 12'd1200;
+
+    reg  [15:0] pyr_wraddr_2;
+    reg  [13:0] pyr_wraddr_4;
+    reg  [11:0] pyr_wraddr_8;
+    reg  [7:0]  pyr_wrdata_2, pyr_wrdata_4, pyr_wrdata_8;
+    reg         pyr_wren_2, pyr_wren_4, pyr_wren_8;
+    reg  [14:0] pyr_rd_ptr;  // Próximo pixel da janela lido em PYR_COPY
+    wire [7:0]  pyr_q_2, pyr_q_4, pyr_q_8;
+    wire        pyr_from_nh = (last_instruction == NH_ALG);
+
+    pyramid_ram #(.ADDR_W(16), .DEPTH(38400)) pyramid_2(
+        .clock(clk_engine),
+        .wraddress(pyr_wraddr_2),
+        .data(pyr_wrdata_2),
+        .wren(pyr_wren_2),
+        .rdaddress((pyr_from_nh ? PYR_NH_BASE_2 : 16'd0) + pyr_rd_ptr),
+        .q(pyr_q_2)
+    );
+
+    pyramid_ram #(.ADDR_W(14), .DEPTH(9600)) pyramid_4(
+        .clock(clk_engine),
+        .wraddress(pyr_wraddr_4),
+        .data(pyr_wrdata_4),
+        .wren(pyr_wren_4),
+        .rdaddress((pyr_from_nh ? PYR_NH_BASE_4 : 14'd0) + pyr_rd_ptr[13:0]),
+        .q(pyr_q_4)
+    );
+
+    pyramid_ram #(.ADDR_W(12), .DEPTH(2400)) pyramid_8(
+        .clock(clk_engine),
+        .wraddress(pyr_wraddr_8),
+        .data(pyr_wrdata_8),
+        .wren(pyr_wren_8),
+        .rdaddress((pyr_from_nh ? PYR_NH_BASE_8 : 12'd0) + pyr_rd_ptr[11:0]),
+        .q(pyr_q_8)
+    );
+
+    //----------------------------------------------------------------
+    // Filtro 3x3 (FILTER): duas linhas de atraso com as linhas y-1 e y-2
+    // da fonte. São lidas na coluna emitida (filt_x), junto com a fonte,
+    // e regravadas 2 ciclos depois (linha 1 <- fonte, linha 2 <- linha 1).
+    //----------------------------------------------------------------
+    reg  [9:0] filt_x, filt_y;  // Posição emitida: x até 320 e y até 240 (coluna/linha virtuais)
+    reg  [8:0] filt_lb_wraddr;
+    reg  [7:0] filt_lb1_wrdata, filt_lb2_wrdata;
+    reg        filt_lb_wren;
+    wire [7:0] filt_lb1_q, filt_lb2_q;
+
+    pyramid_ram #(.ADDR_W(9), .DEPTH(320)) filter_line1(
+        .clock(clk_engine),
+        .wraddress(filt_lb_wraddr),
+        .data(filt_lb1_wrdata),
+        .wren(filt_lb_wren),
+        .rdaddress(filt_x[8:0]),
+        .q(filt_lb1_q)
+    );
+
+    pyramid_ram #(.ADDR_W(9), .DEPTH(320)) filter_line2(
+        .clock(clk_engine),
+        .wraddress(filt_lb_wraddr),
+        .data(filt_lb2_wrdata),
+        .wren(filt_lb_wren),
+        .rdaddress(filt_x[8:0]),
+        .q(filt_lb2_q)
+    );
+
+    //----------------------------------------------------------------
+    // Histograma (STATS/STATS_READ): um contador de 17 bits por valor de
+    // pixel em cada faixa, para a varredura contar LANES pixels por ciclo.
+    // O CTRL_STATS_READ lê o mesmo valor em todas as faixas e soma.
+    //----------------------------------------------------------------
+    reg  [7:0]       hist_px_s0  [0:LANES-1]; // Pixel que entra na faixa (endereço de leitura)
+    reg  [7:0]       hist_wraddr [0:LANES-1];
+    reg  [16:0]      hist_wrdata [0:LANES-1];
+    reg  [LANES-1:0] hist_wren;
+    reg  [7:0]       stats_rd_bin;            // Valor pedido pelo CTRL_STATS_READ
+    wire [16:0]      hist_q [0:LANES-1];
+
+    generate
+        for (bank = 0; bank < LANES; bank = bank + 1) begin : hist_banks
+            pyramid_ram #(.ADDR_W(8), .DEPTH(256), .DATA_W(17)) histogram(
+                .clock(clk_engine),
+                .wraddress(hist_wraddr[bank]),
+                .data(hist_wrdata[bank]),
+                .wren(hist_wren[bank]),
+                .rdaddress((uc_state == STATS_READ) ? stats_rd_bin : hist_px_s0[bank]),
+                .q(hist_q[bank])
+            );
+        end
+    endgenerate
+
+    //----------------------------------------------------------------
+    // LUT de exibição (CTRL_LUT): uma tabela de 256 bytes por canal entre
+    // a memory2 e o vga_module, indexada pelo byte do pixel. Desligada
+    // (lut_on = 0, valor de power-up), o cinza vai direto aos três canais
+    // e o RGB332 é expandido para 8 bits por canal.
+    //----------------------------------------------------------------
+    reg  [7:0] lut_wraddr, lut_wrdata;
+    reg  [2:0] lut_wren;  // {R, G, B}
+    reg        lut_on;
+    wire [7:0] lut_q [0:2];
+
+    genvar ch;
+    generate
+        for (ch = 0; ch < 3; ch = ch + 1) begin : lut_channels
+            pyramid_ram #(.ADDR_W(8), .DEPTH(256)) lut(
+                .clock(clk_engine),
+                .wraddress(lut_wraddr),
+                .data(lut_wrdata),
+                .wren(lut_wren[2 - ch]),
+                .rdaddress(vga_px),
+                .q(lut_q[ch])
+            );
+        end
+    endgenerate
+
+    //================================================================
+    // 3. Lógica do VGA
+    //================================================================
+    always @(posedge clk_25_vga) begin
+        // Caixa deitada (320x240) ou em pé (240x320, com a troca de x/y)
+        localparam X_START=159, Y_START=119, X_START_T=199, Y_START_T=79;
+        reg [9:0] box_x0, box_y0, box_w, box_h;
+        reg [9:0] vga_col, vga_row, src_x, src_y;
+        reg       full, bilinear, hit;
+        reg [9:0] ov_x1, ov_y1;
+        box_x0 = orientation[2] ? X_START_T : X_START;
+        box_y0 = orientation[2] ? Y_START_T : Y_START;
+        box_w  = orientation[2] ? 10'd240 : 10'd320;
+        box_h  = orientation[2] ? 10'd320 : 10'd240;
+        full     = (scanout != SCANOUT_BOX) && !orientation[2];
+        bilinear = full && (scanout == SCANOUT_2X_BILINEAR);
+
+        // Pixel anterior da tela (o atual ainda está na saída da memory2)
+        vga_prev <= vga_vert;
+
+        if (full) begin
+            // Tela toda: next_x/next_y já são 0 fora da área ativa
+            hit     = 1'b1;
+            vga_col = next_x >> 1;
+            vga_row = next_y >> 1;
+            if (bilinear) begin
+                // Coluna/linha seguinte nos ímpares, repetindo a última na borda
+                if (next_x[0] && vga_col != 10'd319) vga_col = vga_col + 1'b1;
+                if (next_y[0] && vga_row != 10'd239) vga_row = vga_row + 1'b1;
+            end
+        end else begin
+            hit = next_x >= box_x0 && next_x <= box_x0 + box_w && next_y >= box_y0 && next_y <= box_y0 + box_h;
+            // Mesmo pixel do endereço linear y*320 + x: a coluna box_w da caixa é o início da linha seguinte
+            vga_col = next_x - box_x0;
+            vga_row = next_y - box_y0;
+            if (vga_col == box_w) begin
+                vga_col = 10'd0;
+                vga_row = vga_row + 1'b1;
+            end
+        end
+
+        // Pixel da imagem (na orientação da memória) mostrado nessa posição
+        src_x = orientation[2] ? vga_row : vga_col;
+        src_y = orientation[2] ? vga_col : vga_row;
+        if (orientation[1]) src_x = 10'd319 - src_x;
+        if (orientation[0]) src_y = 10'd239 - src_y;
+
+        vga_h_odd  <= bilinear && next_x[0];
+        vga_v_odd  <= bilinear && next_y[0];
+        vga_lb_wr  <= bilinear && !next_y[0];
+        vga_lb_col <= src_x[8:0];
+        // Borda do retângulo sobreposto, no pixel da imagem
+        ov_x1 = overlay_x + overlay_w_m1;
+        ov_y1 = overlay_y + overlay_h_m1;
+        vga_overlay <= hit && overlay_on &&
+                       (((src_x == overlay_x || src_x == ov_x1) && src_y >= overlay_y && src_y <= ov_y1) ||
+                        ((src_y == overlay_y || src_y == ov_y1) && src_x >= overlay_x && src_x <= ov_x1));
+        if (hit) begin
+            inside_box <= 1'b1;
+            vga_bank   <= src_y[LANE_BITS-1:0];
+            vga_local  <= ((src_y >> LANE_BITS) << 8) + ((src_y >> LANE_BITS) << 6) + src_x;
+        end else begin
+            inside_box <= 1'b0;
+            vga_bank   <= {LANE_BITS{1'b0}};
+            vga_local  <= {BANK_AW{1'b0}};
+        end
+    end
+
+    // Linha da imagem lida na linha par da tela, para a média vertical da
+    // linha ímpar. A escrita se repete nos 6 ciclos do pixel; vale a
+    // última, com o pixel já na saída da memory2.
+    pyramid_ram #(.ADDR_W(9), .DEPTH(320)) vga_line(
+        .clock(clk_engine),
+        .wraddress(vga_lb_col),
+        .data(vga_q),
+        .wren(vga_lb_wr),
+        .rdaddress(vga_lb_col),
+        .q(vga_lb_q)
+    );
+    
+    // O pixel sai da memory2 2 ciclos do clk_engine depois de vga_local,
+    // passa pela LUT (mais 2) e é registrado: 5 dos 6 ciclos de um pixel
+    // a 25 MHz. O pixel sem LUT anda junto, com o mesmo atraso. Com o
+    // filtro bilinear as médias (vga_px) ficam antes do endereço da LUT.
+    // A borda do retângulo sobreposto inverte a cor final.
+    reg [23:0] data_to_vga_pipe; // {R, G, B}
+    reg [23:0] vga_color;
+    reg [7:0]  vga_px_d1, vga_px_d2;
+    always @(*) begin
+        if (lut_on) begin
+            vga_color = {lut_q[0], lut_q[1], lut_q[2]};
+        end else if (pixel_rgb332) begin
+            // Repete os bits de cada canal: 111 -> 255, 000 -> 0
+            vga_color = {vga_px_d2[7:5], vga_px_d2[7:5], vga_px_d2[7:6],
+                         vga_px_d2[4:2], vga_px_d2[4:2], vga_px_d2[4:3],
+                         {4{vga_px_d2[1:0]}}};
+        end else begin
+            vga_color = {3{vga_px_d2}};
+        end
+    end
+
+    always @(posedge clk_engine) begin
+        vga_px_d1 <= vga_px;
+        vga_px_d2 <= vga_px_d1;
+        data_to_vga_pipe <= !inside_box ? 24'd0 : vga_overlay ? ~vga_color : vga_color;
+    end
+
+    reg [1:0] counter_rd_wr;
+
+    reg [16:0] counter_address;
+    //================================================================
+    // 4. Pipeline de Dados do Algoritmo
+    //================================================================
+    reg [2:0] next_zoom;
+    reg [2:0] current_zoom;
+    
+    reg has_alg_on_exec;
+
+    // Os parâmetros do nível (escala, passo do BA, janela central) ficam na
+    // AGU do motor de faixas (memory_control.v), registrados a partir de next_zoom.
+
+    // --- Escrita por retângulo (EXT_RECT_ORIGIN/EXT_RECT_SIZE + STORE com SEL_MEM = 1 ou EXT_RECT_RUN) ---
+    reg [8:0]  rect_x, rect_w_m1, rect_col;
+    reg [7:0]  rect_y, rect_h_m1, rect_row;
+    reg [LANE_BITS-1:0] rect_bank;  // Banco/endereço local do próximo pixel do retângulo
+    reg [BANK_AW-1:0]   rect_local;
+    reg [23:0] rect_data;   // Pixels do pacote (byte 0 primeiro)
+    reg [14:0] rect_left;   // Pixels do pacote/corrida ainda por escrever, menos 1
+    reg        rect_run;    // EXT_RECT_RUN: o mesmo valor em todos os pixels
+    reg        rect_active; // Ainda faltam pixels do retângulo
+
+    // --- Pirâmide (PYR_BUILD / PYR_COPY) ---
+    reg        pyr_valid;    // Pirâmide corresponde à mem1 atual
+    reg        pyr_issuing;  // Ainda há endereços a emitir
+    reg [BANK_AW-1:0] pyr_local; // Endereço local de (pyr_x, pyr_y): lido da mem1 no PYR_BUILD, escrito no PYR_COPY
+    reg [9:0]  pyr_x, pyr_y;
+    // Endereços emitidos, atrasados pelos 2 ciclos de leitura das memórias
+    reg [BANK_AW-1:0] pyr_local_d1, pyr_local_d2;
+    reg [9:0]  pyr_x_d1, pyr_y_d1, pyr_x_d2, pyr_y_d2;
+    reg        pyr_v_d1, pyr_v_d2, pyr_in_d1, pyr_in_d2;
+    reg [14:0] pyr_ba_ptr_2, pyr_nh_ptr_2;
+    reg [12:0] pyr_ba_ptr_4, pyr_nh_ptr_4;
+    reg [10:0] pyr_ba_ptr_8, pyr_nh_ptr_8;
+    reg [7:0]  pyr_p0_2, pyr_p0_4, pyr_p0_8; // Primeiro pixel do bloco do BA
+    wire [7:0] pyr_pixel = q_mem1[pyr_y_d2[LANE_BITS-1:0]]; // Pixel lido no PYR_BUILD
+
+    // --- Filtro 3x3 (EXT_CTRL/CTRL_FILTER_COEF e CTRL_FILTER_RUN) ---
+    // A posição (x, y) emitida fecha a janela do pixel (x-1, y-1). Nas
+    // bordas a janela repete a linha/coluna da borda.
+    reg signed [7:0] filt_k [0:8]; // Coeficientes em ordem de varredura (4 = centro)
+    reg [3:0]  filt_shift;         // Deslocamento aritmético da soma
+    reg        filt_abs;           // |soma| antes de saturar (bordas)
+    reg        filt_from_mem3;     // Fonte: mem3 (imagem na tela) ou mem1
+    reg        filt_issuing;
+    reg [BANK_AW-1:0] filt_local;  // Endereço local de (filt_x, filt_y) na fonte
+    reg [9:0]  filt_x_d1, filt_y_d1, filt_x_d2, filt_y_d2;
+    reg        filt_v_d1, filt_v_d2, filt_v_d3, filt_v_d4, filt_v_d5, filt_v_d6, filt_v_d7;
+    reg [23:0] filt_col_c, filt_col_l;  // Colunas x-1 e x-2: {cima, meio, baixo}
+    reg [7:0]  filt_w [0:8];            // Janela do pixel de saída
+    reg [9:0]  filt_ox, filt_oy;        // Pixel de saída da janela
+    reg signed [16:0] filt_prod [0:8];  // Produtos (blocos DSP)
+    reg signed [19:0] filt_part [0:2];  // Somas por linha da janela
+    reg signed [20:0] filt_sum, filt_res;
+    reg [LANE_BITS-1:0] filt_bank_d4, filt_bank_d5, filt_bank_d6, filt_bank_d7;
+    reg [BANK_AW-1:0]   filt_local_d4, filt_local_d5, filt_local_d6, filt_local_d7;
+
+    wire [7:0]  filt_pixel = filt_from_mem3 ? q_mem3[filt_y_d2[LANE_BITS-1:0]] : q_mem1[filt_y_d2[LANE_BITS-1:0]];
+    // Coluna x da janela do centro y-1: na linha 0 repete o meio em cima, na 239 embaixo
+    wire [23:0] filt_col   = {(filt_y_d2 == 10'd1) ? filt_lb1_q : filt_lb2_q, filt_lb1_q,
+                              (filt_y_d2 == 10'd240) ? filt_lb1_q : filt_pixel};
+    wire [23:0] filt_left  = (filt_x_d2 == 10'd1)   ? filt_col_c : filt_col_l;
+    wire [23:0] filt_right = (filt_x_d2 == 10'd320) ? filt_col_c : filt_col;
+    wire signed [20:0] filt_mag = (filt_abs && filt_res < 0) ? -filt_res : filt_res;
+    wire [7:0]  filt_out   = (filt_mag < 0) ? 8'd0 : (filt_mag > 21'sd255) ? 8'd255 : filt_mag[7:0];
+    wire        filt_busy  = filt_issuing || filt_v_d1 || filt_v_d2 || filt_v_d3 ||
+                             filt_v_d4 || filt_v_d5 || filt_v_d6 || filt_v_d7;
+
+    // --- Histograma e estatísticas (EXT_CTRL/CTRL_STATS_START e CTRL_STATS_READ) ---
+    // Cada pixel entra numa faixa (s0), tem o contador do seu valor lido
+    // 2 ciclos depois (s2) e gravado + 1 no ciclo seguinte (hist_wr*). As
+    // escritas dos dois pixels anteriores da faixa ainda não aparecem na
+    // leitura: com o mesmo valor, o contador vem delas.
+    reg        stats_stream;      // Conta cada pixel escrito na mem1 (STORE e retângulo)
+    reg        stats_tap;         // Pixel escrito na mem1 neste ciclo, no modo stream (faixa 0)
+    reg  [7:0] stats_tap_px;
+    reg        stats_clearing;    // Zerando os contadores, um valor por ciclo
+    reg  [7:0] stats_clr;
+    reg        stats_issuing;     // Varredura: ainda há endereços a emitir
+    reg        stats_from_mem3;   // Varredura da mem3 (imagem na tela) ou da mem1
+    reg [BANK_AW-1:0] stats_local;
+    reg        stats_v_d1, stats_v_d2;
+    reg  [1:0] stats_rd_sel;      // Registrador do CTRL_STATS_READ
+    reg  [1:0] stats_rd_byte;     // Byte do registrador que vai para o pio_dataout
+    reg  [LANES-1:0] hist_v_s0, hist_v_s1, hist_v_s2, hist_wren_d;
+    reg  [7:0]  hist_px_s1 [0:LANES-1];
+    reg  [7:0]  hist_px_s2 [0:LANES-1];
+    reg  [7:0]  hist_wraddr_d [0:LANES-1];
+    reg  [16:0] hist_wrdata_d [0:LANES-1];
+    reg  [16:0] hist_base;
+    reg  [7:0]  stats_min, stats_max;
+    reg  [16:0] stats_count;
+    reg  [24:0] stats_sum;        // Até 76800 * 255
+    wire        stats_busy = stats_clearing || stats_issuing || stats_v_d1 || stats_v_d2 ||
+                             (|hist_v_s0) || (|hist_v_s1) || (|hist_v_s2) || (|hist_wren);
+
+    // --- Endereço do HPS (LOAD/STORE) em banco/endereço local ---
+    // MEM_ADDR / 320 = (MEM_ADDR / 64) / 5, com 1/5 ~ 3277/2^14 (exato para
+    // todo MEM_ADDR de 17 bits). São 3 estágios registrados: o
+    // READ_AND_WRITE espera 3 ciclos depois do pulso de enable, quando
+    // MEM_ADDR já está estável.
+    reg  [22:0]          hps_prod;
+    reg  [8:0]           hps_row, hps_col;
+    reg  [LANE_BITS-1:0] hps_bank;
+    reg  [BANK_AW-1:0]   hps_local;
+    reg                  hps_in_frame; // MEM_ADDR <= 76799
+
+    always @(posedge clk_engine) begin
+        hps_prod     <= MEM_ADDR[16:6] * 12'd3277;
+        hps_row      <= hps_prod[22:14];
+        hps_col      <= MEM_ADDR - ({hps_prod[22:14], 8'd0} + {hps_prod[22:14], 6'd0});
+        hps_bank     <= hps_row[LANE_BITS-1:0];
+        hps_local    <= ((hps_row >> LANE_BITS) << 8) + ((hps_row >> LANE_BITS) << 6) + hps_col;
+        hps_in_frame <= hps_row < 9'd240;
+    end
+
+    // --- Cópia para a memory2 (COPY_READ/COPY_WRITE) ---
+    // Todos os bancos em paralelo: o endereço local lido num ciclo
+    // (counter_address) é escrito 2 ciclos depois.
+    reg               copy_v_d1, copy_v_d2;
+    reg [BANK_AW-1:0] copy_local_d1, copy_local_d2;
+    wire              copy_from_mem1 = (last_instruction == RESET_INST || last_instruction == STORE);
+
+    always @(posedge clk_engine) begin
+        copy_v_d1     <= (uc_state == COPY_READ);
+        copy_v_d2     <= copy_v_d1;
+        copy_local_d1 <= counter_address[BANK_AW-1:0];
+        copy_local_d2 <= copy_local_d1;
+    end
+
+    //----------------------------------------------------------------
+    // Motor de zoom em faixas (ALGORITHM)
+    //----------------------------------------------------------------
+    // As LANES faixas andam juntas pelas posições (x, grupo de linhas): a
+    // faixa i produz o pixel (x, m*LANES + i), que vai para o banco i da
+    // memory3 no endereço local m*320 + x. Os endereços vêm da AGU
+    // (memory_control.v), uma posição por ciclo com o endereço de leitura
+    // de cada faixa na memory1 e o endereço local de escrita; o BA usa 2
+    // posições por pixel (p0 e p1) e grava ba_pixel(p0, p1).
+    // Pipeline: AGU (3 estágios) -> crossbar -> leitura (2 ciclos) -> escrita.
+    // A crossbar atende, em cada banco da memory1, a faixa de menor índice
+    // e junto dela as que pedem o mesmo endereço; a AGU só anda quando
+    // todas as faixas foram atendidas. No zoom in as faixas pedem linhas
+    // vizinhas (bancos diferentes) ou a mesma linha, e anda uma posição
+    // por ciclo; no zoom out as amostras caem no mesmo banco e a posição
+    // leva até LANES ciclos.
+    wire                       r_valid, r_sub, eng_agu_done;
+    wire [BANK_AW-1:0]         r_local;
+    wire [LANES*BANK_AW-1:0]   r_src_bus;
+    wire [LANES*LANE_BITS-1:0] r_bank_bus;
+    wire [LANES-1:0]           r_need, r_wr;
+    wire [LANE_BITS-1:0]       r_bank [0:LANES-1];
+    wire [BANK_AW-1:0]         r_src  [0:LANES-1];
+    reg  [LANES-1:0]           lane_served;
+
+    // Retorno das leituras, por faixa
+    reg  [LANES-1:0]     lane_v_d1, lane_v_d2, lane_rd_d1, lane_rd_d2;
+    reg  [LANES-1:0]     lane_wr_d1, lane_wr_d2, lane_sub_d1, lane_sub_d2;
+    reg  [LANE_BITS-1:0] lane_bank_d1 [0:LANES-1];
+    reg  [LANE_BITS-1:0] lane_bank_d2 [0:LANES-1];
+    reg  [BANK_AW-1:0]   lane_local_d1 [0:LANES-1];
+    reg  [BANK_AW-1:0]   lane_local_d2 [0:LANES-1];
+    reg  [7:0]           lane_p0 [0:LANES-1];
+    reg  [7:0]           lane_data;
+
+    wire eng_ba      = (last_instruction == BA_ALG);
+    wire eng_start   = (uc_state == ALGORITHM) && !has_alg_on_exec;
+    wire eng_running = (uc_state == ALGORITHM) && has_alg_on_exec;
+    wire eng_advance;
+
+    memory_control #(.LANES(LANES)) agu(
+        .clock(clk_engine),
+        .start(eng_start),
+        .run(eng_running),
+        .advance(eng_advance),
+        .operation(last_instruction),
+        .zoom_level(next_zoom),
+        .x_offset(zoom_x_offset[9:0]),
+        .y_offset(zoom_y_offset),
+        .addr_valid(r_valid),
+        .addr_sub(r_sub),
+        .addr_out_rd(r_src_bus),
+        .bank_out_rd(r_bank_bus),
+        .rd_need(r_need),
+        .addr_out_wr(r_local),
+        .wr_need(r_wr),
+        .done(eng_agu_done)
+    );
+
+    genvar agu_l;
+    generate
+        for (agu_l = 0; agu_l < LANES; agu_l = agu_l + 1) begin : agu_lane
+            assign r_src[agu_l]  = r_src_bus[agu_l*BANK_AW +: BANK_AW];
+            assign r_bank[agu_l] = r_bank_bus[agu_l*LANE_BITS +: LANE_BITS];
+        end
+    endgenerate
+
+    // Crossbar faixas -> bancos da memory1
+    wire [LANES-1:0]     lane_wait = r_need & ~lane_served & {LANES{r_valid && eng_running}};
+    reg  [LANES-1:0]     xbar_grant;
+    reg  [BANK_AW-1:0]   xbar_local [0:LANES-1];
+    integer xb_b, xb_i;
+
+    always @(*) begin
+        for (xb_b = 0; xb_b < LANES; xb_b = xb_b + 1) begin
+            xbar_local[xb_b] = {BANK_AW{1'b0}};
+            // Do maior para o menor índice: vale a última faixa que pede o banco
+            for (xb_i = LANES - 1; xb_i >= 0; xb_i = xb_i - 1) begin
+                if (lane_wait[xb_i] && r_bank[xb_i] == xb_b) begin
+                    xbar_local[xb_b] = r_src[xb_i];
+                end
+            end
+        end
+        for (xb_i = 0; xb_i < LANES; xb_i = xb_i + 1) begin
+            xbar_grant[xb_i] = lane_wait[xb_i] && xbar_local[r_bank[xb_i]] == r_src[xb_i];
+        end
+    end
+
+    // Faixas que terminam a posição neste ciclo (as que não leem, no primeiro)
+    wire [LANES-1:0] lane_push   = {LANES{r_valid && eng_running}} & ~lane_served & (~r_need | xbar_grant);
+    assign           eng_advance = !r_valid || &(lane_served | lane_push);
+    wire             eng_done    = eng_agu_done && !(|lane_v_d1) && !(|lane_v_d2);
+    integer ln;
+
+    always @(posedge clk_engine) begin
+        if (eng_start) begin
+            lane_served <= {LANES{1'b0}};
+        end else if (eng_running) begin
+            // Posição nova na saída da AGU, ou mais faixas atendidas
+            lane_served <= eng_advance ? {LANES{1'b0}} : (lane_served | lane_push);
+        end
+
+        // Retorno das leituras e escrita na memory3 (continua depois de um ABORT;
+        // a mem3 fica pela metade de qualquer forma)
+        lane_v_d1   <= lane_push;
+        lane_rd_d1  <= r_need;
+        lane_wr_d1  <= r_wr;
+        lane_sub_d1 <= {LANES{r_sub}};
+        lane_v_d2   <= lane_v_d1;
+        lane_rd_d2  <= lane_rd_d1;
+        lane_wr_d2  <= lane_wr_d1;
+        lane_sub_d2 <= lane_sub_d1;
+        for (ln = 0; ln < LANES; ln = ln + 1) begin
+            lane_bank_d1[ln]  <= r_bank[ln];
+            lane_local_d1[ln] <= r_local;
+            lane_bank_d2[ln]  <= lane_bank_d1[ln];
+            lane_local_d2[ln] <= lane_local_d1[ln];
+
+            lane_data = lane_rd_d2[ln] ? q_mem1[lane_bank_d2[ln]] : 8'd0;
+            lane_wren[ln] <= 1'b0;
+            if (lane_v_d2[ln]) begin
+                if (eng_ba && !lane_sub_d2[ln]) begin
+                    lane_p0[ln] <= lane_data;
+                end else if (lane_wr_d2[ln]) begin
+                    lane_wr_local[ln] <= lane_local_d2[ln];
+                    lane_wr_data[ln]  <= eng_ba ? ba_pixel(lane_p0[ln], lane_data, pixel_rgb332) : lane_data;
+                    lane_wren[ln]     <= 1'b1;
+                end
+            end
+        end
+    end
+
+    //----------------------------------------------------------------
+    // Histograma e mínimo/máximo/soma (STATS, ou o modo stream)
+    //----------------------------------------------------------------
+    // Na varredura cada faixa recebe o pixel do seu banco; no modo stream,
+    // a faixa 0 recebe o pixel escrito na mem1. Mínimo, máximo e soma
+    // andam junto com a entrada (s0).
+    reg  [7:0]  st_in_min, st_in_max;
+    reg  [11:0] st_in_sum;
+    reg  [4:0]  st_in_count;
+    reg  [16:0] hist_q_sum;
+    integer hb;
+
+    always @(*) begin
+        st_in_min   = 8'hFF;
+        st_in_max   = 8'h00;
+        st_in_sum   = 12'd0;
+        st_in_count = 5'd0;
+        hist_q_sum  = 17'd0;
+        for (hb = 0; hb < LANES; hb = hb + 1) begin
+            if (hist_v_s0[hb]) begin
+                if (hist_px_s0[hb] < st_in_min) st_in_min = hist_px_s0[hb];
+                if (hist_px_s0[hb] > st_in_max) st_in_max = hist_px_s0[hb];
+                st_in_sum   = st_in_sum + hist_px_s0[hb];
+                st_in_count = st_in_count + 1'b1;
+            end
+            hist_q_sum = hist_q_sum + hist_q[hb];
+        end
+    end
+
+    // Registrador do CTRL_STATS_READ, lido um byte por instrução (pio_dataout de 8 bits)
+    reg  [31:0] stats_rd_word;
+
+    always @(*) begin
+        case (stats_rd_sel)
+            2'b00:   stats_rd_word = {15'd0, hist_q_sum};
+            2'b01:   stats_rd_word = {15'd0, stats_count};
+            2'b10:   stats_rd_word = {7'd0, stats_sum};
+            default: stats_rd_word = {16'd0, stats_max, stats_min};
+        endcase
+    end
+
+    always @(posedge clk_engine) begin
+        for (hb = 0; hb < LANES; hb = hb + 1) begin
+            if (stats_v_d2) begin
+                hist_v_s0[hb]  <= 1'b1;
+                hist_px_s0[hb] <= stats_from_mem3 ? q_mem3[hb] : q_mem1[hb];
+            end else begin
+                hist_v_s0[hb]  <= (hb == 0) && stats_tap;
+                hist_px_s0[hb] <= stats_tap_px;
+            end
+            hist_v_s1[hb]  <= hist_v_s0[hb];
+            hist_px_s1[hb] <= hist_px_s0[hb];
+            hist_v_s2[hb]  <= hist_v_s1[hb];
+            hist_px_s2[hb] <= hist_px_s1[hb];
+
+            hist_wren_d[hb]   <= hist_wren[hb];
+            hist_wraddr_d[hb] <= hist_wraddr[hb];
+            hist_wrdata_d[hb] <= hist_wrdata[hb];
+            if (stats_clearing) begin
+                hist_wraddr[hb] <= stats_clr;
+                hist_wrdata[hb] <= 17'd0;
+                hist_wren[hb]   <= 1'b1;
+            end else begin
+                // s2: a escrita mais recente do mesmo valor vale mais que a leitura
+                if (hist_wren[hb] && hist_wraddr[hb] == hist_px_s2[hb])
+                    hist_base = hist_wrdata[hb];
+                else if (hist_wren_d[hb] && hist_wraddr_d[hb] == hist_px_s2[hb])
+                    hist_base = hist_wrdata_d[hb];
+                else
+                    hist_base = hist_q[hb];
+                hist_wraddr[hb] <= hist_px_s2[hb];
+                hist_wrdata[hb] <= hist_base + 1'b1;
+                hist_wren[hb]   <= hist_v_s2[hb];
+            end
+        end
+
+        if (stats_clearing) begin
+            stats_min   <= 8'hFF;
+            stats_max   <= 8'h00;
+            stats_count <= 17'd0;
+            stats_sum   <= 25'd0;
+        end else begin
+            if (st_in_min < stats_min) stats_min <= st_in_min;
+            if (st_in_max > stats_max) stats_max <= st_in_max;
+            stats_count <= stats_count + st_in_count;
+            stats_sum   <= stats_sum + st_in_sum;
+        end
+    end
+
+    // Leitura das memórias: faixas/pirâmide/cópia, senão o endereço do HPS (LOAD)
+    integer rd_b;
+    always @(*) begin
+        for (rd_b = 0; rd_b < LANES; rd_b = rd_b + 1) begin
+            rd_local_mem1[rd_b] = (uc_state == ALGORITHM) ? xbar_local[rd_b] :
+                                  (uc_state == PYR_BUILD) ? pyr_local :
+                                  (uc_state == FILTER)    ? filt_local :
+                                  (uc_state == STATS)     ? stats_local :
+                                  (uc_state == COPY_READ) ? counter_address[BANK_AW-1:0] : hps_local;
+        end
+    end
+    assign rd_local_mem3 = (uc_state == PYR_COPY)  ? LAST_LOCAL :
+                           (uc_state == FILTER)    ? filt_local :
+                           (uc_state == STATS)     ? stats_local :
+                           (uc_state == COPY_READ) ? counter_address[BANK_AW-1:0] : hps_local;
+
+    // Janela central do zoom out (mesmos limites do BA_ALG/NH_ALG)
+    wire pyr_inside = (next_zoom == 3'b011) ? (pyr_x >= 10'd80  && pyr_x <= 10'd239 && pyr_y >= 10'd60  && pyr_y <= 10'd179) :
+                      (next_zoom == 3'b010) ? (pyr_x >= 10'd120 && pyr_x <= 10'd199 && pyr_y >= 10'd90  && pyr_y <= 10'd149) :
+                                              (pyr_x >= 10'd140 && pyr_x <= 10'd179 && pyr_y >= 10'd105 && pyr_y <= 10'd134);
+    wire [7:0] pyr_q = (next_zoom == 3'b011) ? pyr_q_2 : (next_zoom == 3'b010) ? pyr_q_4 : pyr_q_8;
+
+    assign FLAG_ZOOM_MAX = (current_zoom == 3'b111) ? 1'b1: 1'b0;
+    assign FLAG_ZOOM_MIN = (current_zoom == 3'b001) ? 1'b1: 1'b0;
+
+    // ABORT: aceito também durante um algoritmo (ALGORITHM), que é
+    // interrompido sem copiar a mem3 para a tela
+    wire abort_request = enable_pulse && INSTRUCTION == REFRESH_SCREEN && SEL_MEM &&
+                         MEM_ADDR[16:15] == EXT_CTRL && MEM_ADDR[14:11] == CTRL_ABORT;
+    wire abort_taken   = abort_request && uc_state == ALGORITHM;
+
+    // Palavra de status (pio_flags[31:4]): [6:4] current_zoom, [10:7] uc_state,
+    // [19:11] offset X, [27:20] offset Y, [31:28] nº de instruções concluídas
+    // (em código Gray).
+    // O PIO a amostra no clock dele, sem sincronizador. Para que uma leitura
+    // no meio de uma mudança não misture valores:
+    //   - nível e offsets saem de um retrato (snap_*) que só é atualizado com
+    //     a FSM parada em IDLE, sem instrução pendente;
+    //   - o nº de sequência mostrado (seq_shown) só anda depois de o retrato
+    //     ter os valores da instrução, e de 1 em 1 (o +2 do ABORT leva dois
+    //     ciclos). Em Gray, cada passo muda um bit: a leitura dá o valor
+    //     anterior ou o seguinte, nunca um terceiro.
+    // uc_state segue ao vivo (só diagnóstico: ocupada ou não).
+    reg [3:0] op_seq;
+    reg       op_pending; // Instrução aceita e ainda não concluída
+    reg [3:0] seq_shown;  // Persegue op_seq
+    reg [3:0] seq_gray;   // seq_shown em Gray (o que o PIO lê)
+    reg [2:0] snap_zoom;
+    reg [8:0] snap_x;
+    reg [7:0] snap_y;
+    reg       snap_fresh; // O retrato já tem os valores da última instrução
+    wire      status_settled = uc_state == IDLE && !op_pending && !enable_pulse;
+    wire [3:0] seq_next = seq_shown + 1'b1;
+
+    assign STATUS = {seq_gray, snap_y, snap_x, uc_state, snap_zoom};
+
+    always @(posedge clk_engine) begin
+        if (status_settled) begin
+            snap_zoom  <= current_zoom;
+            snap_x     <= zoom_x_offset[8:0];
+            snap_y     <= zoom_y_offset;
+            snap_fresh <= 1'b1;
+            if (snap_fresh && seq_shown != op_seq) begin
+                seq_shown <= seq_next;
+                seq_gray  <= seq_next ^ (seq_next >> 1);
+            end
+        end else begin
+            snap_fresh <= 1'b0;
+        end
+    end
+
+    // Contador de conclusão: a instrução aceita em IDLE conta no primeiro
+    // ciclo em que a FSM está de novo em IDLE (no seguinte, se ela nem saiu).
+    // Diferente do FLAG_DONE, que já vale 1 antes de a instrução ser vista,
+    // o contador diz ao HPS qual instrução terminou (coproc_poll).
+    // Um ABORT que interrompe o algoritmo conta junto com ele (+2); fora
+    // disso é ignorado e não conta, e o HPS sabe se a operação foi cortada.
+    always @(posedge clk_engine) begin
+        if (abort_taken) begin
+            op_seq     <= op_seq + 2'd2;
+            op_pending <= 1'b0;
+        end else if (uc_state == IDLE) begin
+            if (op_pending) begin
+                op_seq <= op_seq + 1'b1;
+            end
+            op_pending <= enable_pulse && !abort_request;
+        end
+    end
+    
+    //================================================================
+    // 5. Máquina de Estados Finitos (FSM) Principal
+    //================================================================
+    integer bk, fk;
+
+    always @(posedge clk_engine) begin
+        stats_tap <= 1'b0; // Só nos ciclos em que a mem1 recebe um pixel (READ_AND_WRITE/RECT_WRITE)
+        lut_wren  <= 3'b000;
+
+        case (uc_state) 
+            IDLE: begin 
+                has_alg_on_exec     <= 1'b0;
+                FLAG_DONE           <= 1'b1;
+                wren_mem1 <= 1'b0;
+                wren_mem2 <= {LANES{1'b0}};
+                wren_mem3 <= {LANES{1'b0}};
+                pyr_wren_2 <= 1'b0;
+                pyr_wren_4 <= 1'b0;
+                pyr_wren_8 <= 1'b0;
+
+                if (enable_pulse) begin
+                    counter_address <= 17'd0;
+                    counter_rd_wr <= 2'b0;
+                    // Pipeline da pirâmide pronto para PYR_BUILD/PYR_COPY
+                    pyr_local    <= {BANK_AW{1'b0}};
+                    pyr_x        <= 10'd0;
+                    pyr_y        <= 10'd0;
+                    pyr_issuing  <= 1'b1;
+                    pyr_v_d1     <= 1'b0;
+                    pyr_v_d2     <= 1'b0;
+                    pyr_rd_ptr   <= 15'd0;
+                    pyr_ba_ptr_2 <= 15'd0;
+                    pyr_nh_ptr_2 <= 15'd0;
+                    pyr_ba_ptr_4 <= 13'd0;
+                    pyr_nh_ptr_4 <= 13'd0;
+                    pyr_ba_ptr_8 <= 11'd0;
+                    pyr_nh_ptr_8 <= 11'd0;
+                    if (INSTRUCTION == STORE && SEL_MEM) begin
+                        // Pacote de 3 pixels para o retângulo aberto:
+                        // DATA_IN = pixel 0, MEM_ADDR[7:0] = pixel 1, MEM_ADDR[15:8] = pixel 2
+                        if (rect_active) begin
+                            rect_data <= {MEM_ADDR[15:0], DATA_IN};
+                            rect_left <= 15'd2;
+                            rect_run  <= 1'b0;
+                            FLAG_DONE <= 1'b0;
+                            uc_state  <= RECT_WRITE;
+                        end else begin
+                            FLAG_ERROR <= 1'b1;
+                        end
+                    end else if (INSTRUCTION == LOAD || INSTRUCTION == STORE) begin
+                        uc_state         <= READ_AND_WRITE;
+                        last_instruction <= INSTRUCTION;
+                    end else if (INSTRUCTION >= NHI_ALG && INSTRUCTION <= NH_ALG) begin
+                            
+                        // Captura os offsets X e Y enviados pelo HPS
+                        zoom_x_offset <= MEM_ADDR; // X offset
+                        zoom_y_offset <= DATA_IN;  // Y offset
+
+                        case (INSTRUCTION)
+                            // --- (Zoom Out: NH_ALG) ---
+                            NH_ALG:begin
+                                if (FLAG_ZOOM_MIN) begin
+                                    FLAG_DONE <= 1'b1;
+                                    uc_state <= IDLE;
+                                end else begin
+                                    next_zoom <=  current_zoom - 1'b1;
+                                    if (current_zoom == 3'b101) begin
+                                        uc_state <= COPY_READ;
+                                        last_instruction <= RESET_INST;
+                                    end
+                                    else if (current_zoom <= 3'b100) begin
+                                        last_instruction <= NH_ALG;
+                                        if (pyr_valid) begin
+                                            // Janela já pronta na pirâmide: só copia
+                                            uc_state        <= PYR_COPY;
+                                        end else begin
+                                            uc_state        <= ALGORITHM;
+                                        end
+                                    end else if (next_zoom > 3'b100) begin
+                                        last_instruction <= NHI_ALG;
+                                        uc_state         <= ALGORITHM;
+                                    end else begin
+                                        uc_state <= IDLE;
+                                    end
+                                end
+                            end
+                            
+                            // --- (Zoom In / Pan: NHI_ALG) ---
+                            NHI_ALG: begin
+                                // SEL_MEM = 0 -> Zoom In
+                                // SEL_MEM = 1 -> Pan
+                                
+                                // Só bloqueia se for um ZOOM IN (SEL_MEM=0) e já estiver no máximo
+                                if (FLAG_ZOOM_MAX && !SEL_MEM) begin
+                                    FLAG_DONE <= 1'b1;
+                                    uc_state <= IDLE;
+                                end else begin
+                                    
+                                    if (SEL_MEM) begin // É um comando PAN
+                                        next_zoom <= current_zoom; // MANTÉM o nível de zoom
+                                    end else begin // É um comando ZOOM IN
+                                        next_zoom <= current_zoom + 1'b1; // INCREMENTA o nível de zoom
+                                    end
+
+                                    // Se estamos em 1x (3'b011) E é um ZOOM IN (não PAN),
+                                    // precisamos copiar a imagem original (mem1) para a memória de trabalho (mem3) primeiro.
+                                    if (current_zoom == 3'b011 && !SEL_MEM) begin
+                                        uc_state <= COPY_READ;
+                                        last_instruction <= RESET_INST; // RESET_INST copia mem1 -> mem3 (se não for STORE) -> mem2
+                                    end
+                                    else begin // Se já estamos com zoom OU se é um comando PAN
+                                        last_instruction <= NHI_ALG; // Aplica o algoritmo direto
+                                        uc_state         <= ALGORITHM;
+                                    end
+                                end
+                            end
+                            
+                            // --- (Zoom Out: BA_ALG) ---
+                            BA_ALG:begin
+                                if (FLAG_ZOOM_MIN) begin
+                                    FLAG_DONE <= 1'b1;
+                                    uc_state <= IDLE;
+                                end else begin
+                                    next_zoom <=  current_zoom - 1'b1;
+                                    if (current_zoom == 3'b101) begin
+                                        uc_state <= COPY_READ;
+                                        last_instruction <= RESET_INST;
+                                    end
+                                    else if (current_zoom <= 3'b100) begin
+                                        last_instruction <= BA_ALG;
+                                        if (pyr_valid) begin
+                                            // Janela já pronta na pirâmide: só copia
+                                            uc_state        <= PYR_COPY;
+                                        end else begin
+                                            uc_state        <= ALGORITHM;
+                                        end
+                                    end else if (current_zoom > 3'b100) begin
+                                        last_instruction <= PR_ALG;
+                                        uc_state         <= ALGORITHM;
+                                    end else begin
+                                        uc_state <= IDLE;
+                                    end
+                                    
+                                end
+                            end
+
+                            // --- (Zoom In / Pan: PR_ALG) ---
+                            PR_ALG: begin
+                                // SEL_MEM = 0 -> Zoom In
+                                // SEL_MEM = 1 -> Pan
+
+                                // Só bloqueia se for um ZOOM IN (SEL_MEM=0) e já estiver no máximo
+                                if (FLAG_ZOOM_MAX && !SEL_MEM) begin
+                                    FLAG_DONE <= 1'b1;
+                                    uc_state <= IDLE;
+                                end else begin
+                                
+                                    if (SEL_MEM) begin // É um comando PAN
+                                        next_zoom <= current_zoom; // MANTÉM o nível de zoom
+                                    end else begin // É um comando ZOOM IN
+                                        next_zoom <=  current_zoom + 1'b1; // INCREMENTA o nível de zoom
+                                    end
+
+                                    // Se estamos em 1x (3'b011) E é um ZOOM IN (não PAN),
+                                    // precisamos copiar a imagem original (mem1) para a memória de trabalho (mem3) primeiro.
+                                    if (current_zoom == 3'b011 && !SEL_MEM) begin
+                                        uc_state <= COPY_READ;
+                                        last_instruction <= RESET_INST; // RESET_INST copia mem1 -> mem3 (se não for STORE) -> mem2
+                                    end
+                                    else begin // Se já estamos com zoom OU se é um comando PAN
+                                        last_instruction <= PR_ALG; // Aplica o algoritmo direto
+                                        uc_state         <= ALGORITHM;
+                                    end
+                                end
+                            end
+
+                        endcase
+                        
+                        counter_address <= 17'd0;
+                        counter_rd_wr <= 2'b0;
+                        
+                    end else if (INSTRUCTION == RESET_INST) begin
+                        last_instruction <= 3'b111;
+                        uc_state <= RESET;
+                        counter_address <= 17'd0;
+                        counter_rd_wr <= 2'b0;
+                    end else if (INSTRUCTION == REFRESH_SCREEN && SEL_MEM) begin
+                        // Instruções estendidas: ORIGIN/SIZE só atualizam registradores (DONE continua em 1)
+                        case (MEM_ADDR[16:15])
+                            EXT_RECT_ORIGIN: begin
+                                rect_x      <= MEM_ADDR[8:0];
+                                rect_y      <= DATA_IN;
+                                rect_active <= 1'b0;
+                            end
+                            EXT_RECT_SIZE: begin
+                                if ({1'b0, rect_x} + MEM_ADDR[8:0] > 10'd319 || {1'b0, rect_y} + DATA_IN > 9'd239) begin
+                                    FLAG_ERROR  <= 1'b1;
+                                    rect_active <= 1'b0;
+                                end else begin
+                                    rect_w_m1   <= MEM_ADDR[8:0];
+                                    rect_h_m1   <= DATA_IN;
+                                    rect_col    <= 9'd0;
+                                    rect_row    <= 8'd0;
+                                    rect_bank   <= rect_y[LANE_BITS-1:0];
+                                    rect_local  <= ((rect_y >> LANE_BITS) << 8) + ((rect_y >> LANE_BITS) << 6) + rect_x;
+                                    rect_active <= 1'b1;
+                                end
+                            end
+                            EXT_CTRL: begin
+                                casez (MEM_ADDR[14:11])
+                                    CTRL_PYRAMID_BUILD: begin
+                                        pyr_valid <= 1'b0;
+                                        FLAG_DONE <= 1'b0;
+                                        uc_state  <= PYR_BUILD;
+                                    end
+                                    CTRL_ABORT: begin
+                                        // Nada em execução: o algoritmo já terminou
+                                    end
+                                    CTRL_FILTER_COEF: begin
+                                        // Coeficiente MEM_ADDR[10:7] (0..8) = DATA_IN com sinal
+                                        if (MEM_ADDR[10:7] > 4'd8) begin
+                                            FLAG_ERROR <= 1'b1;
+                                        end else begin
+                                            filt_k[MEM_ADDR[10:7]] <= DATA_IN;
+                                        end
+                                    end
+                                    CTRL_FILTER_RUN: begin
+                                        // Filtra a mem1 (MEM_ADDR[10] = 0) ou a própria mem3 para a
+                                        // mem3 e copia para a tela, sem mudar o nível de zoom
+                                        filt_from_mem3   <= MEM_ADDR[10];
+                                        filt_abs         <= MEM_ADDR[4];
+                                        filt_shift       <= MEM_ADDR[3:0];
+                                        filt_x           <= 10'd0;
+                                        filt_y           <= 10'd0;
+                                        filt_local       <= {BANK_AW{1'b0}};
+                                        filt_issuing     <= 1'b1;
+                                        filt_v_d1        <= 1'b0;
+                                        filt_v_d2        <= 1'b0;
+                                        filt_v_d3        <= 1'b0;
+                                        filt_v_d4        <= 1'b0;
+                                        filt_v_d5        <= 1'b0;
+                                        filt_v_d6        <= 1'b0;
+                                        filt_v_d7        <= 1'b0;
+                                        next_zoom        <= current_zoom;
+                                        last_instruction <= REFRESH_SCREEN; // A cópia no fim lê a mem3
+                                        FLAG_DONE        <= 1'b0;
+                                        uc_state         <= FILTER;
+                                    end
+                                    CTRL_STATS_START: begin
+                                        // Zera histograma e estatísticas. MEM_ADDR[10:9]: 00 = só zera,
+                                        // 01 = passa a contar cada pixel escrito na mem1,
+                                        // 10/11 = varre a mem1/mem3 uma vez
+                                        stats_stream    <= (MEM_ADDR[10:9] == 2'b01);
+                                        stats_issuing   <= MEM_ADDR[10];
+                                        stats_from_mem3 <= MEM_ADDR[9];
+                                        stats_clearing  <= 1'b1;
+                                        stats_clr       <= 8'd0;
+                                        stats_local     <= {BANK_AW{1'b0}};
+                                        stats_v_d1      <= 1'b0;
+                                        stats_v_d2      <= 1'b0;
+                                        FLAG_DONE       <= 1'b0;
+                                        uc_state        <= STATS;
+                                    end
+                                    CTRL_STATS_READ: begin
+                                        // MEM_ADDR[10:9] = registrador, MEM_ADDR[8:7] = byte,
+                                        // DATA_IN = valor do pixel (contador)
+                                        stats_rd_sel  <= MEM_ADDR[10:9];
+                                        stats_rd_byte <= MEM_ADDR[8:7];
+                                        stats_rd_bin <= DATA_IN;
+                                        FLAG_DONE    <= 1'b0;
+                                        uc_state     <= STATS_READ;
+                                    end
+                                    CTRL_LUT: begin
+                                        // DATA_IN na entrada MEM_ADDR[7:0] dos canais MEM_ADDR[10:8]
+                                        // ({R, G, B}); sem canal, MEM_ADDR[0] liga ou desliga a LUT
+                                        lut_wren   <= MEM_ADDR[10:8];
+                                        lut_wraddr <= MEM_ADDR[7:0];
+                                        lut_wrdata <= DATA_IN;
+                                        if (MEM_ADDR[10:8] == 3'b000) begin
+                                            lut_on <= MEM_ADDR[0];
+                                        end
+                                    end
+                                    CTRL_CONFIG: begin
+                                        // Registrador MEM_ADDR[10:8] = MEM_ADDR[7:0]. A pirâmide
+                                        // guarda médias do BA no formato antigo: é descartada.
+                                        if (MEM_ADDR[10:8] == CONFIG_PIXEL_FORMAT &&
+                                            (MEM_ADDR[7:0] == PIXEL_GRAY8 || MEM_ADDR[7:0] == PIXEL_RGB332)) begin
+                                            pixel_rgb332 <= (MEM_ADDR[7:0] == PIXEL_RGB332);
+                                            pyr_valid    <= 1'b0;
+                                        end else if (MEM_ADDR[10:8] == CONFIG_ORIENTATION && MEM_ADDR[7:3] == 5'd0) begin
+                                            orientation <= MEM_ADDR[2:0];
+                                        end else if (MEM_ADDR[10:8] == CONFIG_SCANOUT && MEM_ADDR[7:0] <= SCANOUT_2X_BILINEAR) begin
+                                            scanout <= MEM_ADDR[1:0];
+                                        end else if (MEM_ADDR[10:8] == CONFIG_OVERLAY && MEM_ADDR[7:1] == 7'd0) begin
+                                            overlay_on <= MEM_ADDR[0];
+                                        end else if (MEM_ADDR[10:9] == CONFIG_OVERLAY_POS && MEM_ADDR[8:0] < 9'd320 && DATA_IN < 8'd240) begin
+                                            // x em MEM_ADDR[8:0], y em DATA_IN
+                                            overlay_x <= MEM_ADDR[8:0];
+                                            overlay_y <= DATA_IN;
+                                        end else if (MEM_ADDR[10:9] == CONFIG_OVERLAY_SIZE && MEM_ADDR[8:0] < 9'd320 && DATA_IN < 8'd240) begin
+                                            // w - 1 em MEM_ADDR[8:0], h - 1 em DATA_IN
+                                            overlay_w_m1 <= MEM_ADDR[8:0];
+                                            overlay_h_m1 <= DATA_IN;
+                                        end else begin
+                                            FLAG_ERROR <= 1'b1;
+                                        end
+                                    end
+                                    4'b1???: begin
+                                        // SET_ZOOM: uma passada a partir da mem1, sem passar pelos níveis intermediários
+                                        if (!set_zoom_ok) begin
+                                            FLAG_ERROR <= 1'b1;
+                                        end else begin
+                                            next_zoom     <= set_zoom_level;
+                                            zoom_x_offset <= {8'd0, MEM_ADDR[8:0]};
+                                            zoom_y_offset <= DATA_IN;
+                                            FLAG_DONE     <= 1'b0;
+                                            if (set_zoom_level == 3'b100) begin
+                                                last_instruction <= RESET_INST; // Cópia mem1 -> mem2
+                                                uc_state         <= COPY_READ;
+                                            end else begin
+                                                last_instruction <= set_zoom_alg;
+                                                if (set_zoom_level < 3'b100 && pyr_valid) begin
+                                                    uc_state        <= PYR_COPY;
+                                                end else begin
+                                                    uc_state        <= ALGORITHM;
+                                                end
+                                            end
+                                        end
+                                    end
+                                    default: FLAG_ERROR <= 1'b1;
+                                endcase
+                            end
+                            EXT_RECT_RUN: begin
+                                // Corrida: DATA_IN repetido em MEM_ADDR[14:0] + 1 pixels do retângulo aberto
+                                if (rect_active) begin
+                                    rect_data <= {16'd0, DATA_IN};
+                                    rect_left <= MEM_ADDR[14:0];
+                                    rect_run  <= 1'b1;
+                                    FLAG_DONE <= 1'b0;
+                                    uc_state  <= RECT_WRITE;
+                                end else begin
+                                    FLAG_ERROR <= 1'b1;
+                                end
+                            end
+                            default: FLAG_ERROR <= 1'b1;
+                        endcase
+                    end else if (INSTRUCTION == REFRESH_SCREEN) begin
+                        last_instruction <= 3'b111;
+                        uc_state <= COPY_READ;
+                        counter_address <= 17'd0;
+                        counter_rd_wr <= 2'b0;
+                    end
+                end
+            end
+            
+            READ_AND_WRITE: begin
+                if (MEM_ADDR > 17'd76799) begin
+                    FLAG_ERROR <= 1'b1;
+                end
+                FLAG_DONE <= 1'b0;
+                // Espera MEM_ADDR chegar a banco/endereço local (hps_*)
+                if (counter_rd_wr == 2'b10) begin
+                    if (last_instruction == STORE) begin
+                        wr_bank_mem1  <= hps_bank;
+                        wr_local_mem1 <= hps_local;
+                        data_in_mem1  <= DATA_IN;
+                        wren_mem1     <= hps_in_frame;
+                        pyr_valid     <= 1'b0; // mem1 mudou
+                        stats_tap     <= stats_stream && hps_in_frame;
+                        stats_tap_px  <= DATA_IN;
+                    end
+                    // LOAD: as memórias já leem hps_local em todos os bancos
+                    counter_rd_wr <= 2'b00;
+                    uc_state      <= WAIT_WR_OR_RD;
+                end else begin
+                    counter_rd_wr <= counter_rd_wr + 1;
+                end
+            end
+
+            ALGORITHM: begin
+                // As posições andam no motor de faixas (seção 4); aqui só a
+                // inicialização e o fim, quando a última escrita já saiu
+                wren_mem1 <= 1'b0;
+                FLAG_DONE <= 1'b0;
+                if (!has_alg_on_exec) begin
+                    has_alg_on_exec <= 1'b1;
+                end else if (eng_done) begin
+                    counter_address <= 17'd0;
+                    counter_rd_wr   <= 2'b0;
+                    has_alg_on_exec <= 1'b0;
+                    uc_state        <= COPY_READ;
+                end
+            end
+
+            RESET: begin
+                FLAG_DONE <= 1'b0;
+                next_zoom <= 3'b100;
+                FLAG_ERROR <= 1'b0;
+                last_instruction <= RESET_INST;
+                
+                counter_address <= 17'd0;
+                counter_rd_wr <= 2'b0;
+                uc_state       <= COPY_READ;
+
+            end
+
+            COPY_READ: begin
+                // Um endereço local por ciclo em todos os bancos; a escrita na
+                // memory2 (2 ciclos depois) está no fim do always
+                if (counter_address[BANK_AW-1:0] == LAST_LOCAL) begin
+                    counter_rd_wr <= 2'b00;
+                    uc_state      <= COPY_WRITE;
+                end else begin
+                    counter_address <= counter_address + 1'b1;
+                end
+            end
+
+            COPY_WRITE: begin
+                // Espera as 2 últimas leituras da cópia chegarem à memory2
+                if (counter_rd_wr == 2'b01) begin
+                    current_zoom <= next_zoom;
+                    FLAG_DONE <= 1'b1;
+                    uc_state <= IDLE; // Cópia concluída; a última escrita sai no ciclo do IDLE
+                end else begin
+                    counter_rd_wr <= counter_rd_wr + 1;
+                end
+            end
+
+            RECT_WRITE: begin
+                // Um pixel por ciclo; a mem1 registra endereço/dado e grava no ciclo seguinte
+                FLAG_DONE     <= 1'b0;
+                wr_bank_mem1  <= rect_bank;
+                wr_local_mem1 <= rect_local;
+                data_in_mem1  <= rect_data[7:0];
+                wren_mem1     <= 1'b1;
+                pyr_valid    <= 1'b0; // mem1 mudou
+                stats_tap    <= stats_stream;
+                stats_tap_px <= rect_data[7:0];
+                rect_left    <= rect_left - 1'b1;
+                if (!rect_run) begin
+                    rect_data <= rect_data >> 8;
+                end
+
+                if (rect_col == rect_w_m1) begin
+                    rect_col  <= 9'd0;
+                    rect_row  <= rect_row + 1'b1;
+                    // Linha seguinte no banco seguinte; depois do último banco, na linha local seguinte
+                    rect_bank  <= rect_bank + 1'b1;
+                    rect_local <= rect_local - rect_w_m1 + ((rect_bank == LAST_BANK) ? 9'd320 : 9'd0);
+                    if (rect_row == rect_h_m1) begin
+                        rect_active <= 1'b0; // Último pixel do retângulo
+                    end
+                end else begin
+                    rect_col   <= rect_col + 1'b1;
+                    rect_local <= rect_local + 1'b1;
+                end
+
+                if (rect_left == 15'd0 || (rect_col == rect_w_m1 && rect_row == rect_h_m1)) begin
+                    uc_state <= IDLE; // IDLE desliga wren_mem1 e volta o DONE
+                end
+            end
+
+            PYR_BUILD: begin
+                // Lê a mem1 em ordem de varredura, um pixel por ciclo; cada pixel
+                // chega 2 ciclos depois (pyr_*_d2) e vai para os níveis em que é amostra.
+                // BA: o byte escrito é data_to_avg >> 2 do BA_ALG, que só depende
+                // dos dois primeiros pixels do bloco: {p1[1:0], p0[7:2]}.
+                FLAG_DONE  <= 1'b0;
+                pyr_wren_2 <= 1'b0;
+                pyr_wren_4 <= 1'b0;
+                pyr_wren_8 <= 1'b0;
+
+                if (pyr_issuing) begin
+                    if (pyr_x == 10'd319 && pyr_y == 10'd239) begin
+                        pyr_issuing <= 1'b0;
+                    end
+                    if (pyr_x == 10'd319) begin
+                        pyr_x <= 10'd0;
+                        pyr_y <= pyr_y + 1'b1;
+                        // Linha seguinte: depois do último banco continua o endereço local, senão volta ao início da linha
+                        pyr_local <= (pyr_y[LANE_BITS-1:0] == LAST_BANK) ? pyr_local + 1'b1 : pyr_local - 9'd319;
+                    end else begin
+                        pyr_x     <= pyr_x + 1'b1;
+                        pyr_local <= pyr_local + 1'b1;
+                    end
+                end
+                pyr_v_d1 <= pyr_issuing;
+                pyr_x_d1 <= pyr_x;
+                pyr_y_d1 <= pyr_y;
+                pyr_v_d2 <= pyr_v_d1;
+                pyr_x_d2 <= pyr_x_d1;
+                pyr_y_d2 <= pyr_y_d1;
+
+                if (pyr_v_d2) begin
+                    // 1/2: blocos 2x2, amostras BA em x+1
+                    if (pyr_y_d2[0] == 1'b0) begin
+                        if (pyr_x_d2[0] == 1'b0) begin
+                            pyr_p0_2     <= pyr_pixel;
+                            pyr_wraddr_2 <= PYR_NH_BASE_2 + pyr_nh_ptr_2;
+                            pyr_wrdata_2 <= pyr_pixel;
+                            pyr_wren_2   <= 1'b1;
+                            pyr_nh_ptr_2 <= pyr_nh_ptr_2 + 1'b1;
+                        end else begin
+                            pyr_wraddr_2 <= pyr_ba_ptr_2;
+                            pyr_wrdata_2 <= ba_pixel(pyr_p0_2, pyr_pixel, pixel_rgb332);
+                            pyr_wren_2   <= 1'b1;
+                            pyr_ba_ptr_2 <= pyr_ba_ptr_2 + 1'b1;
+                        end
+                    end
+                    // 1/4: blocos 4x4, amostras BA em x+2
+                    if (pyr_y_d2[1:0] == 2'd0) begin
+                        if (pyr_x_d2[1:0] == 2'd0) begin
+                            pyr_p0_4     <= pyr_pixel;
+                            pyr_wraddr_4 <= PYR_NH_BASE_4 + pyr_nh_ptr_4;
+                            pyr_wrdata_4 <= pyr_pixel;
+                            pyr_wren_4   <= 1'b1;
+                            pyr_nh_ptr_4 <= pyr_nh_ptr_4 + 1'b1;
+                        end else if (pyr_x_d2[1:0] == 2'd2) begin
+                            pyr_wraddr_4 <= pyr_ba_ptr_4;
+                            pyr_wrdata_4 <= ba_pixel(pyr_p0_4, pyr_pixel, pixel_rgb332);
+                            pyr_wren_4   <= 1'b1;
+                            pyr_ba_ptr_4 <= pyr_ba_ptr_4 + 1'b1;
+                        end
+                    end
+                    // 1/8: blocos 8x8, amostras BA em x+4
+                    if (pyr_y_d2[2:0] == 3'd0) begin
+                        if (pyr_x_d2[2:0] == 3'd0) begin
+                            pyr_p0_8     <= pyr_pixel;
+                            pyr_wraddr_8 <= PYR_NH_BASE_8 + pyr_nh_ptr_8;
+                            pyr_wrdata_8 <= pyr_pixel;
+                            pyr_wren_8   <= 1'b1;
+                            pyr_nh_ptr_8 <= pyr_nh_ptr_8 + 1'b1;
+                        end else if (pyr_x_d2[2:0] == 3'd4) begin
+                            pyr_wraddr_8 <= pyr_ba_ptr_8;
+                            pyr_wrdata_8 <= ba_pixel(pyr_p0_8, pyr_pixel, pixel_rgb332);
+                            pyr_wren_8   <= 1'b1;
+                            pyr_ba_ptr_8 <= pyr_ba_ptr_8 + 1'b1;
+                        end
+                    end
+
+                    if (pyr_x_d2 == 10'd319 && pyr_y_d2 == 10'd239) begin
+                        pyr_valid <= 1'b1;
+                        uc_state  <= IDLE; // A última escrita sai no ciclo do IDLE
+                    end
+                end
+            end
+
+            PYR_COPY: begin
+                // Substitui BA_ALG/NH_ALG + COPY_READ/COPY_WRITE: um pixel por ciclo,
+                // escrito ao mesmo tempo na mem3 e na mem2. Fora da janela, 0.
+                // Como no algoritmo, o pixel 76799 da mem3 não é escrito e a mem2
+                // recebe o valor que já estava lá (a mem3 lê LAST_LOCAL neste estado).
+                FLAG_DONE <= 1'b0;
+                wren_mem2 <= {LANES{1'b0}};
+                wren_mem3 <= {LANES{1'b0}};
+
+                if (pyr_issuing) begin
+                    if (pyr_x == 10'd319 && pyr_y == 10'd239) begin
+                        pyr_issuing <= 1'b0;
+                    end
+                    if (pyr_inside) begin
+                        pyr_rd_ptr <= pyr_rd_ptr + 1'b1;
+                    end
+                    if (pyr_x == 10'd319) begin
+                        pyr_x <= 10'd0;
+                        pyr_y <= pyr_y + 1'b1;
+                        pyr_local <= (pyr_y[LANE_BITS-1:0] == LAST_BANK) ? pyr_local + 1'b1 : pyr_local - 9'd319;
+                    end else begin
+                        pyr_x     <= pyr_x + 1'b1;
+                        pyr_local <= pyr_local + 1'b1;
+                    end
+                end
+                pyr_v_d1     <= pyr_issuing;
+                pyr_in_d1    <= pyr_inside;
+                pyr_local_d1 <= pyr_local;
+                pyr_x_d1     <= pyr_x;
+                pyr_y_d1     <= pyr_y;
+                pyr_v_d2     <= pyr_v_d1;
+                pyr_in_d2    <= pyr_in_d1;
+                pyr_local_d2 <= pyr_local_d1;
+                pyr_x_d2     <= pyr_x_d1;
+                pyr_y_d2     <= pyr_y_d1;
+
+                if (pyr_v_d2) begin
+                    // Só o banco da linha pyr_y_d2 é escrito
+                    wr_local_mem2 <= pyr_local_d2;
+                    wren_mem2     <= {{(LANES-1){1'b0}}, 1'b1} << pyr_y_d2[LANE_BITS-1:0];
+                    if (pyr_x_d2 == 10'd319 && pyr_y_d2 == 10'd239) begin
+                        for (bk = 0; bk < LANES; bk = bk + 1) begin
+                            data_in_mem2[bk] <= q_mem3[LAST_BANK];
+                        end
+                        current_zoom <= next_zoom;
+                        uc_state     <= IDLE; // IDLE desliga os wren e volta o DONE
+                    end else begin
+                        for (bk = 0; bk < LANES; bk = bk + 1) begin
+                            data_in_mem2[bk] <= pyr_in_d2 ? pyr_q : 8'd0;
+                        end
+                        wr_local_mem3 <= pyr_local_d2;
+                        data_to_write <= pyr_in_d2 ? pyr_q : 8'd0;
+                        wren_mem3     <= {{(LANES-1){1'b0}}, 1'b1} << pyr_y_d2[LANE_BITS-1:0];
+                    end
+                end
+            end
+
+            FILTER: begin
+                // Janela 3x3 em fluxo, uma posição por ciclo. Fonte e linhas de
+                // atraso chegam em d2; depois janela (d3), produtos (d4), somas
+                // por linha (d5), soma (d6), deslocamento (d7) e a escrita na
+                // mem3, já saturada. Filtrar a mem3 nela mesma é seguro: cada
+                // pixel da fonte é lido uma só vez, antes de ser sobrescrito.
+                FLAG_DONE    <= 1'b0;
+                wren_mem3    <= {LANES{1'b0}};
+                filt_lb_wren <= 1'b0;
+
+                if (filt_issuing) begin
+                    if (filt_x == 10'd320) begin
+                        filt_x <= 10'd0;
+                        filt_y <= filt_y + 1'b1;
+                        if (filt_y == 10'd240) begin
+                            filt_issuing <= 1'b0;
+                        end
+                        // Mesma regra de linha do PYR_BUILD (filt_local parou na coluna 319)
+                        filt_local <= (filt_y[LANE_BITS-1:0] == LAST_BANK) ? filt_local + 1'b1 : filt_local - 9'd319;
+                    end else begin
+                        filt_x <= filt_x + 1'b1;
+                        if (filt_x != 10'd319) begin
+                            filt_local <= filt_local + 1'b1;
+                        end
+                    end
+                end
+                filt_v_d1 <= filt_issuing;
+                filt_x_d1 <= filt_x;
+                filt_y_d1 <= filt_y;
+                filt_v_d2 <= filt_v_d1;
+                filt_x_d2 <= filt_x_d1;
+                filt_y_d2 <= filt_y_d1;
+
+                // d2: coluna x entra na janela e nas linhas de atraso
+                filt_v_d3 <= 1'b0;
+                if (filt_v_d2) begin
+                    if (filt_x_d2 != 10'd320) begin
+                        filt_lb_wraddr  <= filt_x_d2[8:0];
+                        filt_lb1_wrdata <= filt_pixel;
+                        filt_lb2_wrdata <= filt_lb1_q;
+                        filt_lb_wren    <= 1'b1;
+                    end
+                    filt_col_l <= filt_col_c;
+                    filt_col_c <= filt_col;
+                    if (filt_x_d2 != 10'd0 && filt_y_d2 != 10'd0) begin
+                        filt_w[0] <= filt_left[23:16];  filt_w[1] <= filt_col_c[23:16]; filt_w[2] <= filt_right[23:16];
+                        filt_w[3] <= filt_left[15:8];   filt_w[4] <= filt_col_c[15:8];  filt_w[5] <= filt_right[15:8];
+                        filt_w[6] <= filt_left[7:0];    filt_w[7] <= filt_col_c[7:0];   filt_w[8] <= filt_right[7:0];
+                        filt_ox   <= filt_x_d2 - 1'b1;
+                        filt_oy   <= filt_y_d2 - 1'b1;
+                        filt_v_d3 <= 1'b1;
+                    end
+                end
+
+                // d3 -> d4: um multiplicador 9x8 com sinal por coeficiente
+                for (fk = 0; fk < 9; fk = fk + 1) begin
+                    filt_prod[fk] <= $signed({1'b0, filt_w[fk]}) * filt_k[fk];
+                end
+                filt_v_d4     <= filt_v_d3;
+                filt_bank_d4  <= filt_oy[LANE_BITS-1:0];
+                filt_local_d4 <= ((filt_oy >> LANE_BITS) << 8) + ((filt_oy >> LANE_BITS) << 6) + filt_ox;
+
+                // d4 -> d5 -> d6: soma em árvore
+                for (fk = 0; fk < 3; fk = fk + 1) begin
+                    filt_part[fk] <= filt_prod[3*fk] + filt_prod[3*fk+1] + filt_prod[3*fk+2];
+                end
+                filt_sum      <= filt_part[0] + filt_part[1] + filt_part[2];
+                filt_res      <= filt_sum >>> filt_shift;
+                filt_v_d5     <= filt_v_d4;
+                filt_v_d6     <= filt_v_d5;
+                filt_v_d7     <= filt_v_d6;
+                filt_bank_d5  <= filt_bank_d4;
+                filt_bank_d6  <= filt_bank_d5;
+                filt_bank_d7  <= filt_bank_d6;
+                filt_local_d5 <= filt_local_d4;
+                filt_local_d6 <= filt_local_d5;
+                filt_local_d7 <= filt_local_d6;
+
+                if (filt_v_d7) begin
+                    wr_local_mem3 <= filt_local_d7;
+                    data_to_write <= filt_out;
+                    wren_mem3     <= {{(LANES-1){1'b0}}, 1'b1} << filt_bank_d7;
+                end
+
+                if (!filt_busy) begin
+                    // A última escrita sai neste ciclo; a cópia começa no seguinte
+                    counter_address <= 17'd0;
+                    counter_rd_wr   <= 2'b0;
+                    uc_state        <= COPY_READ;
+                end
+            end
+
+            STATS: begin
+                // 256 ciclos zerando os contadores; na varredura, depois um
+                // endereço local por ciclo em todos os bancos, que chega ao
+                // histograma (LANES pixels) 2 ciclos depois
+                FLAG_DONE <= 1'b0;
+                if (stats_clearing) begin
+                    stats_clr <= stats_clr + 1'b1;
+                    if (stats_clr == 8'd255) begin
+                        stats_clearing <= 1'b0;
+                    end
+                end else if (stats_issuing) begin
+                    if (stats_local == LAST_LOCAL) begin
+                        stats_issuing <= 1'b0;
+                    end else begin
+                        stats_local <= stats_local + 1'b1;
+                    end
+                end
+                stats_v_d1 <= !stats_clearing && stats_issuing;
+                stats_v_d2 <= stats_v_d1;
+
+                if (!stats_busy) begin
+                    uc_state <= IDLE; // Última contagem já gravada
+                end
+            end
+
+            STATS_READ: begin
+                // O contador do valor stats_rd_bin chega 2 ciclos depois, já somado entre as faixas
+                FLAG_DONE <= 1'b0;
+                if (counter_rd_wr == 2'b10) begin
+                    case (stats_rd_byte)
+                        2'b00:   DATA_OUT <= stats_rd_word[7:0];
+                        2'b01:   DATA_OUT <= stats_rd_word[15:8];
+                        2'b10:   DATA_OUT <= stats_rd_word[23:16];
+                        default: DATA_OUT <= stats_rd_word[31:24];
+                    endcase
+                    counter_rd_wr <= 2'b00;
+                    FLAG_DONE     <= 1'b1;
+                    uc_state      <= IDLE;
+                end else begin
+                    counter_rd_wr <= counter_rd_wr + 1;
+                end
+            end
+
+            WAIT_WR_OR_RD: begin
+                if (counter_rd_wr == 2'b10) begin
+                    counter_rd_wr <= 2'b00;
+                    if (last_instruction == LOAD) begin
+                        uc_state <= IDLE;
+                        if (!hps_in_frame) begin
+                            DATA_OUT <= 8'd0;
+                        end else if (SEL_MEM) begin
+                            DATA_OUT <= q_mem3[hps_bank];
+                        end else begin
+                            DATA_OUT <= q_mem1[hps_bank];
+                        end
+                        FLAG_DONE <= 1'b1;
+                    end else begin // STORE
+                        uc_state <= IDLE;
+                        wren_mem1 <= 1'b0;
+                        counter_rd_wr <= 2'b0;
+                        counter_address <= 17'd0;
+                    end
+                end else begin
+                    counter_rd_wr <= counter_rd_wr + 1;
+                end
+            end
+            
+            default: uc_state <= IDLE;
+        endcase
+
+        // Escrita da cópia na memory2, 2 ciclos depois da leitura do COPY_READ
+        if (uc_state == COPY_READ || uc_state == COPY_WRITE) begin
+            wr_local_mem2 <= copy_local_d2;
+            wren_mem2     <= {LANES{copy_v_d2}};
+            for (bk = 0; bk < LANES; bk = bk + 1) begin
+                // RESET/STORE (e REFRESH_SCREEN) copiam a mem1; os algoritmos, a mem3
+                data_in_mem2[bk] <= copy_from_mem1 ? q_mem1[bk] : q_mem3[bk];
+            end
+        end
+
+        // ABORT durante o algoritmo: sobrepõe o que o estado atual decidiu.
+        // A mem3 fica pela metade e a tela (mem2) e o current_zoom continuam
+        // os da operação anterior.
+        if (abort_taken) begin
+            has_alg_on_exec <= 1'b0;
+            counter_address <= 17'd0;
+            counter_rd_wr   <= 2'b0;
+            uc_state        <= IDLE;
+        end
+    
+    end
+
+    //================================================================
+    // 6. Instâncias de Módulos
+    //================================================================
+
+    vga_module vga_out(.clock(clk_25_vga), 
+    .reset(1'b0), 
+    .color_in(data_to_vga_pipe), 
+    .next_x(next_x), 
+    .next_y(next_y), 
+    .hsync(VGA_H_SYNC_N), 
+    .vsync(VGA_V_SYNC_N), 
+    .red(VGA_R), 
+    .green(VGA_G), 
+    .blue(VGA_B), 
+    .sync(VGA_SYNC), 
+    .clk(VGA_CLK), 
+    .blank(VGA_BLANK_N));
+    
 endmodule
\ No newline at end of file
@@ -1,395 +1,251 @@
+// Unidade de geração de endereços (AGU) do motor de zoom em faixas.
+// A cada ciclo com advance, emite uma posição para as LANES faixas: o
+// endereço de leitura de cada faixa na memory1 (banco e endereço local)
+// e o endereço local de escrita na memory3 (a faixa i escreve no banco i).
+// Vale para os quatro algoritmos, qualquer nível e qualquer offset: o que
+// depende do nível fica em registradores lvl_*/win_*, e o que depende do
+// algoritmo, em três comparações de operation.
+// Pipeline: eng_* (posição) -> a_* (origem em x/y) -> r_* (banco e
+// endereço local, as saídas). Quem consome as saídas (a crossbar do main)
+// segura o r_* com advance = 0 enquanto alguma faixa não foi atendida.
 module memory_control (
-    addr_base,
     clock,
+    start,
+    run,
+    advance,
     operation,
-    current_zoom,
-    enable,
+    zoom_level,
+    x_offset,
+    y_offset,
+    addr_valid,
+    addr_sub,
     addr_out_rd,
+    bank_out_rd,
+    rd_need,
     addr_out_wr,
-    done,
-    wr_enable,
-    counter_op,
-    color_in,
-    color_out,
-    finish_state,
-
-    current_state
-
-
+    wr_need,
+    done
 );
-output reg finish_state;
-
-    output [2:0] current_state;
-    input [7:0] color_in;
-    output reg [7:0] color_out;
-
-    assign current_state = state;
-    // estado de aguardar uma nova instrução
-    localparam IDLE = 3'b000;
-
-    //operações de leitura ou escrita na memoria
-    localparam RD_DATA = 3'b001;
-    localparam WR_DATA = 3'b010;
-
-    //algoritmos
-    localparam NHI_ALG = 3'b011;
-    localparam PR_ALG = 3'b100;
-    localparam NH_ALG = 3'b101;
-    localparam BA_ALG = 3'b110;
-    
-    //estado apenas para aguardar finalizar a operação de leitura ou escrita
-    localparam WAIT_WR_RD = 3'b111;
-
-    input [16:0] addr_base;
-    input [2:0] operation;
-    input [2:0] current_zoom;
-    input enable, clock;
-    output reg [16:0] addr_out_rd;
-    output reg [16:0] addr_out_wr;
-    output reg done;
-    output reg wr_enable;
-    output [2:0] counter_op;
-
-    reg [2:0] state;
-
-    reg [1:0] wr_wait_counter;
-    reg [16:0] algorithm_needed_steps;
-    reg [16:0] algorithm_current_step;
-
-
-
-    reg [2:0] current_operation_step;
-    reg has_alg_on_exec;
+    parameter LANES = 4; // Mesmo LANES do main
+    localparam LANE_BITS = $clog2(LANES);
+    localparam BANK_ROWS = 240 / LANES;
+    localparam BANK_AW   = $clog2(BANK_ROWS * 320);
+
+    // Mesmos códigos de instrução do main
+    localparam NHI_ALG = 3'b011, PR_ALG = 3'b100, BA_ALG = 3'b101, NH_ALG = 3'b110;
+
+    input clock;
+    input start;            // Primeiro ciclo do ALGORITHM: pipeline vazio, posição (0, 0)
+    input run;              // ALGORITHM em execução
+    input advance;          // r_* foi consumido: o pipeline anda uma posição
+    input [2:0] operation;  // PR_ALG, NHI_ALG, BA_ALG ou NH_ALG
+    input [2:0] zoom_level; // next_zoom
+    input [9:0] x_offset;
+    input [7:0] y_offset;
+
+    output addr_valid;                          // Há uma posição em r_*
+    output addr_sub;                            // BA: 0 = p0, 1 = p1
+    output [LANES*BANK_AW-1:0]   addr_out_rd;   // Faixa i em [i*BANK_AW +: BANK_AW]
+    output [LANES*LANE_BITS-1:0] bank_out_rd;   // Faixa i em [i*LANE_BITS +: LANE_BITS]
+    output [LANES-1:0]           rd_need;       // Lê a memory1 (senão, 0)
+    output [BANK_AW-1:0]         addr_out_wr;   // O mesmo em todas as faixas
+    output [LANES-1:0]           wr_need;       // Escreve na memory3
+    output done;                                // Todas as posições já saíram de r_*
+
+    // --- Parâmetros do nível (registrados a partir de zoom_level) ---
+    // Só estes registradores são usados a cada posição. next_zoom muda em
+    // IDLE/RESET, e a primeira posição que os lê vem 2 ciclos depois
+    // (IDLE -> inicialização do ALGORITHM -> eng_*).
+    reg       lvl_up;        // PR/NHI ampliando (2x, 4x, 8x)
+    reg [1:0] lvl_shift;     // log2 da escala (0 em 1x)
+    reg [2:0] lvl_step;      // BA: distância entre os pixels do bloco (0 fora da redução)
+    reg [9:0] win_x0, win_x1, win_y0, win_y1; // BA/NH: janela central (fora dela, 0)
 
-    reg [10:0] old_x, old_y, new_x, new_y;
-
-    reg [2:0] offset;
-    
-    assign counter_op = current_operation_step;
-
-    reg [16:0] addr_base_wr;
-    reg [16:0] addr_base_rd;
-    
     always @(posedge clock) begin
-        case (state)
-            IDLE:   begin
-                done <= 1'b1;
-                has_alg_on_exec <= 1'b0;
-                wr_enable <= 1'b0;
-                addr_out_rd <= 17'b0;
-                addr_out_wr <= 17'b0;
-                if (enable) begin
-                    state <= operation;
-                    done <= 1'b0;
-                end else begin
-                    state <= IDLE;
-                end
+        lvl_up    <= zoom_level[2] && zoom_level[1:0] != 2'b00;
+        lvl_shift <= zoom_level[2] ? zoom_level[1:0] : -zoom_level[1:0]; // 1/2 -> 1, 1/4 -> 2, 1/8 -> 3
+        case (zoom_level)
+            3'b011: begin
+                lvl_step <= 3'd1;
+                win_x0 <= 10'd80;  win_x1 <= 10'd239; win_y0 <= 10'd60;  win_y1 <= 10'd179;
+            end
+            3'b010: begin
+                lvl_step <= 3'd2;
+                win_x0 <= 10'd120; win_x1 <= 10'd199; win_y0 <= 10'd90;  win_y1 <= 10'd149;
+            end
+            3'b001: begin
+                lvl_step <= 3'd4;
+                win_x0 <= 10'd140; win_x1 <= 10'd179; win_y0 <= 10'd105; win_y1 <= 10'd134;
             end
+            default: begin
+                // Sem redução: não há janela
+                lvl_step <= 3'd0;
+                win_x0 <= 10'd0;   win_x1 <= 10'h3FF; win_y0 <= 10'd0;   win_y1 <= 10'h3FF;
+            end
+        endcase
+    end
 
-            WAIT_WR_RD: begin // adicionar a veri
-                if ( wr_wait_counter == 2'b01) begin
-                    if(operation == PR_ALG) begin
-                        if (current_operation_step == 3'b000) begin //guarda a cor a ser escrita
-                            color_out <= color_in;
-                        end else begin
-                            color_out <= color_out; //mantem salva a cor a ser escrita nas proximas operações
-                        end
-                    end else begin
-                        color_out <= color_in;
-                    end
-                    if (operation == RD_DATA || operation == WR_DATA) begin
-                        state <= IDLE;
-                        wr_wait_counter <= 2'b00;
-                        wr_enable <= 1'b0;
-                        done <= 1'b1;
-                    end else begin
-                        if (algorithm_current_step >= algorithm_needed_steps) begin
-                            state <= IDLE;
-                            wr_wait_counter <= 2'b00;
-                            wr_enable <= 1'b0;
-                            done <= 1'b1;
-                        end else begin 
-                            wr_enable <= 1'b0;
-                            state <= operation;
-                        end
-                    end
-                end else begin
-                    wr_wait_counter <= wr_wait_counter + 1;
-                    wr_enable <= wr_enable;
-                    state <= WAIT_WR_RD;
-                end
+    wire eng_pr      = (operation == PR_ALG);
+    wire eng_ba      = (operation == BA_ALG);
+    wire eng_zoom_in = (operation == PR_ALG || operation == NHI_ALG);
+
+    reg  [9:0]           eng_x;     // Próxima posição a entrar no pipeline
+    reg  [7:0]           eng_m;
+    reg                  eng_sub;
+    reg  [BANK_AW-1:0]   eng_local;
+    reg                  eng_more;  // Ainda há posições a entrar
+
+    reg                  a_valid, a_sub;
+    reg  [BANK_AW-1:0]   a_local;
+    reg  [9:0]           a_sx [0:LANES-1];
+    reg  [9:0]           a_sy [0:LANES-1];
+    reg  [LANES-1:0]     a_need, a_wr;
+
+    reg                  r_valid, r_sub;
+    reg  [BANK_AW-1:0]   r_local;
+    reg  [LANE_BITS-1:0] r_bank [0:LANES-1];
+    reg  [BANK_AW-1:0]   r_src  [0:LANES-1];
+    reg  [LANES-1:0]     r_need, r_wr;
+
+    //----------------------------------------------------------------
+    // Estágio 0: origem (old_x, old_y) de cada faixa na posição eng_*
+    //----------------------------------------------------------------
+    // A faixa i produz o pixel (x, eng_m*LANES + i). A origem só depende
+    // da posição e é o mesmo old_x/old_y (10 bits) da varredura sequencial:
+    //   PR/NHI: o pixel anterior da varredura, levado à escala (PR em blocos 2x2);
+    //   BA/NH:  a amostra ((x - x0) << escala, (y - y0) << escala) da janela
+    //           central; o BA lê também o pixel lvl_step à direita (eng_sub).
+    reg  [9:0]       f0_x, f0_y, f0_xq, f0_yq;
+    reg  [9:0]       f0_sx [0:LANES-1];
+    reg  [9:0]       f0_sy [0:LANES-1];
+    reg  [LANES-1:0] f0_need, f0_wr;
+    integer f0_i;
+
+    always @(*) begin
+        for (f0_i = 0; f0_i < LANES; f0_i = f0_i + 1) begin
+            f0_x  = eng_x;
+            f0_y  = (eng_m << LANE_BITS) + f0_i;
+            f0_xq = eng_pr ? {f0_x[9:1], 1'b0} : f0_x;
+            f0_yq = eng_pr ? {f0_y[9:1], 1'b0} : f0_y;
+            if (eng_zoom_in) begin
+                if (f0_yq == 10'd0)
+                    f0_sy[f0_i] = y_offset;
+                else if (lvl_up)
+                    f0_sy[f0_i] = ((f0_yq - 1'b1) >> lvl_shift) + y_offset;
+                else
+                    f0_sy[f0_i] = f0_yq - 1'b1;
+                if (f0_xq == 10'd0)
+                    f0_sx[f0_i] = (f0_yq == 10'd0 || lvl_up) ? x_offset : 10'd319;
+                else if (lvl_up)
+                    f0_sx[f0_i] = ((f0_xq - 1'b1) >> lvl_shift) + x_offset;
+                else
+                    f0_sx[f0_i] = f0_xq - 1'b1;
+                f0_need[f0_i] = 1'b1;
+                f0_wr[f0_i]   = eng_pr || !(f0_x == 10'd319 && f0_y == 10'd239); // NHI não escreve o pixel 76799
+            end else begin
+                f0_sx[f0_i]   = ((f0_x - win_x0) << lvl_shift) + (eng_sub ? lvl_step : 3'd0);
+                f0_sy[f0_i]   = (f0_y - win_y0) << lvl_shift;
+                f0_need[f0_i] = !(f0_x < win_x0 || f0_x > win_x1 || f0_y < win_y0 || f0_y > win_y1);
+                f0_wr[f0_i]   = !(f0_x == 10'd319 && f0_y == 10'd239) && (!eng_ba || eng_sub);
             end
+        end
+    end
 
-            RD_DATA: begin
-                addr_out_rd <= addr_base;
-                state <= WAIT_WR_RD;
-                wr_wait_counter <= 2'b00;
-                wr_enable <= 1'b0;
-                done <= 1'b0;
+    //----------------------------------------------------------------
+    // Estágio 1: banco/endereço local da origem
+    //----------------------------------------------------------------
+    // old_x vai até 1023: como no endereço linear old_x + old_y*320, as
+    // colunas a partir de 320 são as linhas seguintes
+    reg  [10:0]          f1_row;
+    reg  [9:0]           f1_col;
+    reg  [LANE_BITS-1:0] f1_bank [0:LANES-1];
+    reg  [BANK_AW-1:0]   f1_src  [0:LANES-1];
+    reg  [LANES-1:0]     f1_need;
+    integer f1_i;
+
+    always @(*) begin
+        for (f1_i = 0; f1_i < LANES; f1_i = f1_i + 1) begin
+            if (a_sx[f1_i] >= 10'd960) begin
+                f1_col = a_sx[f1_i] - 10'd960;
+                f1_row = a_sy[f1_i] + 2'd3;
+            end else if (a_sx[f1_i] >= 10'd640) begin
+                f1_col = a_sx[f1_i] - 10'd640;
+                f1_row = a_sy[f1_i] + 2'd2;
+            end else if (a_sx[f1_i] >= 10'd320) begin
+                f1_col = a_sx[f1_i] - 10'd320;
+                f1_row = a_sy[f1_i] + 2'd1;
+            end else begin
+                f1_col = a_sx[f1_i];
+                f1_row = a_sy[f1_i];
             end
+            f1_need[f1_i] = a_need[f1_i] && f1_row < 11'd240; // Fora do quadro: lido como 0
+            f1_bank[f1_i] = f1_row[LANE_BITS-1:0];
+            f1_src[f1_i]  = ((f1_row >> LANE_BITS) << 8) + ((f1_row >> LANE_BITS) << 6) + f1_col;
+        end
+    end
+
+    integer ln;
 
-            WR_DATA: begin
-                addr_out_wr <= addr_base;
-                state <= WAIT_WR_RD;
-                wr_wait_counter <= 2'b00;
-                wr_enable <= 1'b1;
-                done <= 1'b0;
+    always @(posedge clock) begin
+        if (start) begin
+            eng_x     <= 10'd0;
+            eng_m     <= 8'd0;
+            eng_sub   <= 1'b0;
+            eng_local <= {BANK_AW{1'b0}};
+            eng_more  <= 1'b1;
+            a_valid   <= 1'b0;
+            r_valid   <= 1'b0;
+        end else if (run && advance) begin
+            r_valid <= a_valid;
+            r_sub   <= a_sub;
+            r_local <= a_local;
+            r_need  <= f1_need;
+            r_wr    <= a_wr;
+            a_valid <= eng_more;
+            a_sub   <= eng_sub;
+            a_local <= eng_local;
+            a_need  <= f0_need;
+            a_wr    <= f0_wr;
+            for (ln = 0; ln < LANES; ln = ln + 1) begin
+                r_bank[ln] <= f1_bank[ln];
+                r_src[ln]  <= f1_src[ln];
+                a_sx[ln]   <= f0_sx[ln];
+                a_sy[ln]   <= f0_sy[ln];
             end
 
-            PR_ALG: begin
-                if (!has_alg_on_exec) begin
-                    has_alg_on_exec <= 1'b1;
-                    algorithm_needed_steps <= 19'd19200;
-                    algorithm_current_step <= 17'd0;
-                    current_operation_step <= 3'b0;
-                    old_x <= 10'd0;
-                    old_y <= 10'd0;
-                    new_x <= 10'd0;
-                    new_y <= 10'd0;
-                    state <= PR_ALG;
+            if (eng_more) begin
+                if (eng_ba && !eng_sub) begin
+                    eng_sub <= 1'b1;
                 end else begin
-                    case (current_operation_step)
-
-                        3'b000: begin //leitura
-                            addr_out_rd <= old_x + (old_y*10'd320);
-                            wr_wait_counter <= 2'b00;
-                            wr_enable <= 1'b0;
-                            state <= WAIT_WR_RD;
-                            current_operation_step <= 3'b001;
-                            done <= 1'b0;
-                        end
-                        3'b001: begin //escrita 00
-                            addr_out_wr <= new_x + (new_y*320);
-                            current_operation_step <= 3'b010;
-                            wr_enable <= 1'b1;
-                            wr_wait_counter <= 2'b00;
-                            done <= 1'b0;
-                            new_x <= new_x + 1'b1;
-                            state <= WAIT_WR_RD;
-                        end
-                        3'b010: begin //escrita 01
-                            addr_out_wr <= new_x + (new_y*320);
-                            current_operation_step <= 3'b011;
-                            wr_enable <= 1'b1;
-                            wr_wait_counter <= 2'b00;
-                            done <= 1'b0;
-                            new_x <= new_x - 1'b1;
-                            new_y <= new_y + 1'b1;
-                            state <= WAIT_WR_RD;
+                    eng_sub   <= 1'b0;
+                    eng_local <= eng_local + 1'b1;
+                    if (eng_x == 10'd319) begin
+                        eng_x <= 10'd0;
+                        eng_m <= eng_m + 1'b1;
+                        if (eng_m == BANK_ROWS - 1) begin
+                            eng_more <= 1'b0;
                         end
-                        3'b100: begin //escrita 10
-                            addr_out_wr <= new_x + (new_y*320);
-                            current_operation_step <= 3'b101;
-                            wr_enable <= 1'b1;
-                            wr_wait_counter <= 2'b00;
-                            done <= 1'b0;
-                            new_x <= new_x + 1'b1;
-                            state <= WAIT_WR_RD;
-                        end
-                        3'b101: begin //escrita 11
-                            addr_out_wr <= new_x + (new_y*320);
-                            current_operation_step <= 3'b000;
-                            wr_enable <= 1'b1;
-                            wr_wait_counter <= 2'b00;
-                            done <= 1'b0;
-                            if (new_x == 10'd319) begin
-                                new_x <= 10'd0;
-                                new_y <= new_y + 1'b1;
-                                old_x <= 10'd0;
-                                old_y <= old_y + 1'b1;
-                            end else begin
-                                new_x <= new_x + 1'b1;
-                                new_y <= new_y - 1'b1;
-                                old_x <= old_x + 1'b1;
-                            end
-                        end
-                    endcase
+                    end else begin
+                        eng_x <= eng_x + 1'b1;
+                    end
                 end
             end
-
-            // NHI_ALG: begin
-            //     if (!has_alg_on_exec) begin
-            //         has_alg_on_exec <= 1'b1;
-            //         algorithm_needed_steps <= 17'd19200;
-            //         algorithm_current_step <= 17'd0;
-            //         current_operation_step <= 3'b0;
-            //         addr_base_rd <= 17'd19200;
-            //         addr_base_wr <= 17'd0;
-            //         state <= NHI_ALG;
-            //         old_x <= 10'd0;
-            //         old_y <= 10'd0;
-            //         new_x <= 10'd0;
-            //         new_y <= 10'd0;
-            //     end else begin
-            //         case (current_operation_step)
-            //             3'b000: begin
-            //                 addr_out_rd <= ( old_x<<1) + ((old_y<<1)*10'd320);
-            //                 wr_wait_counter <= 2'b00;
-            //                 wr_enable <= 1'b0;
-            //                 state <= WAIT_WR_RD;
-            //                 current_operation_step <= 3'b010;
-            //                 // addr_base_rd <= addr_base_rd + 2'd2;
-            //                 // current_operation_step <= 3'b001;
-            //                 // wr_enable <= 1'b0;
-            //                 // state <= NHI_ALG;
-            //                 // done <= 1'b0;
-            //             end
-            //             3'b001: begin
-            //                 //addr_out_rd <= addr_out;
-            //                 wr_wait_counter <= 2'b00;
-            //                 wr_enable <= 1'b0;
-            //                 state <= WAIT_WR_RD;
-            //                 current_operation_step <= 3'b010;
-            //             end
-            //             3'b010: begin
-            //                 finish_state <= 1'b0;
-                            
-            //                 addr_out_wr <= new_x + (new_y*10'd320);
-
-            //                 algorithm_current_step <= algorithm_current_step + 1;
-            //                 //addr_out_wr <= addr_out;
-            //                 wr_enable <= 1'b1;
-            //                 wr_wait_counter <= 2'b00;
-            //                 // if (new_x == 10'd319) begin
-            //                 //     new_x <= 10'd0;
-            //                 //     new_y <= new_y + 1;
-            //                 //     old_y <= (new_y >> 1'b1) + 10'd60;
-            //                 //     old_x <= 10'd80;
-            //                 // end else begin
-            //                 //     new_x <= new_x + 1;
-            //                 //     old_x <= (new_x >> 1'b1) + 10'd80;
-            //                 // end
-            //                 // state <= WAIT_WR_RD;
-            //                 // state <= NHI_ALG;
-            //                 // current_operation_step <= 3'b000;
-            //                 // addr_base_wr <= addr_base_wr+1'b1;
-            //                 current_operation_step <= 3'b011;
-            //                 state <= WAIT_WR_RD;
-            //                 done <= 1'b0;
-                            
-            //             end
-
-            //             3'b011: begin
-            //                 //algorithm_current_step <= algorithm_current_step + 1;
-            //                 //addr_out_wr <= addr_out;
-            //                 wr_enable <= 1'b0;
-            //                 wr_wait_counter <= 2'b00;
-            //                 if (new_x == 10'd319) begin
-            //                     new_x <= 10'd0;
-            //                     new_y <= new_y + 1;
-            //                     old_y <= (new_y >> 1'b1);
-            //                     old_x <= 10'd0;
-            //                 end else begin
-            //                     new_x <= new_x + 1;
-            //                     old_x <= (new_x >> 1'b1);
-            //                 end
-            //                 state <= NHI_ALG;
-            //                 //state <= NHI_ALG;
-            //                 current_operation_step <= 3'b000;
-            //             end
-            //             default: begin
-            //                 finish_state <= 1'b0;
-            //                 current_operation_step <= 3'b0;
-            //                 state <= NHI_ALG;
-            //             end
-            //         endcase
-            //     end
-            // end
-            // NH_ALG: begin
-            //     if (!has_alg_on_exec) begin
-            //         algorithm_needed_steps <= (current_zoom == 3'b100) ? 19'd19200:19'd4800;
-            //         algorithm_current_step <= 17'd0;
-                    
-            //         old_x <= 10'd0;
-            //         old_y <= 10'd0;
-            //         new_x <= (current_zoom == 3'b100) ? 10'd80:10'd120;
-            //         new_y <= (current_zoom == 3'b100) ? 10'd60:10'd90;
-            //         has_alg_on_exec <= 1'b1;
-            //         offset <= (current_zoom == 3'b100) ? 3'd2:3'd4;
-            //         current_operation_step <= 3'b0;
-            //         state <= NH_ALG;
-            //     end else begin
-
-            //         case (current_operation_step)
-            //             3'b000: begin
-            //                 addr_out <= ((old_x) + ((old_y)*10'd320));
-                            
-                            
-            //                 wr_enable <= 1'b0;
-                            
-            //                 done <= 1'b0;
-            //                 if (old_x >= 10'd316) begin
-            //                     old_x <= 10'd0;
-            //                     old_y <= old_y + offset;
-            //                 end else begin
-            //                     old_x <= old_x + offset;
-            //                 end
-            //                 wr_wait_counter <= 2'b00;
-            //                 current_operation_step <= 3'b001;
-            //                 state <= WAIT_WR_RD;
-            //             end
-            //             3'b001: begin
-            //                 addr_out <= addr_out;
-            //                 wr_wait_counter <= 2'b00;
-            //                 wr_enable <= 1'b0;
-            //                 done <= 1'b0;
-            //                 current_operation_step <= 3'b010;
-            //                 state <= NH_ALG;
-                            
-            //             end
-            //             3'b010: begin
-            //                 addr_out <= new_x + (new_y*320);
-            //                 current_operation_step <= 3'b100;
-                            
-            //                 wr_enable <= 1'b1;
-            //                 wr_wait_counter <= 2'b00;
-            //                 done <= 1'b0;
-            //                 algorithm_current_step <= algorithm_current_step + 1;
-            //                 if ((new_x == 10'd200 && offset == 3'd4) || (new_x == 10'd240 && offset == 3'd2)) begin
-            //                     new_x <= 10'd0;
-            //                     new_y <= new_y + 1;
-            //                 end else begin
-            //                     new_x <= new_x + 1;
-            //                 end
-            //                 state <= WAIT_WR_RD;
-            //             end
-            //             3'b100: begin
-            //                 state <= NH_ALG;
-            //                 current_operation_step <= 3'b0;
-            //             end
-                        
-            //         endcase
-            //     end
-            // end
-            // PR_ALG: begin
-            //     if (!has_alg_on_exec) begin
-            //         has_alg_on_exec <= 1'b1;
-            //         algorithm_needed_steps <= 19'd19200;
-            //         algorithm_current_step <= 17'd0;
-            //         current_operation_step <= 3'b0;
-            //         old_x <= 10'd80;
-            //         old_y <= 10'd60;
-            //         new_x <= 10'd0;
-            //         new_y <= 10'd0;
-            //         state <= PR_ALG;
-            //     end else begin
-            //         case (current_operation_step)
-            //             3'b000: begin
-            //                 addr_out <= old_x + (old_y*10'd320);
-            //                 current_operation_step <= 3'b001;
-            //                 wr_wait_counter <= 2'b00;
-            //                 wr_enable <= 1'b0;
-            //                 state <= WAIT_WR_RD;
-                            
-            //                 done <= 1'b0;
-            //             end
-            //         endcase
-
-            //     end
-            // end
-
-        endcase
+        end
     end
 
-
-endmodule
\ No newline at end of file
+    assign addr_valid  = r_valid;
+    assign addr_sub    = r_sub;
+    assign rd_need     = r_need;
+    assign addr_out_wr = r_local;
+    assign wr_need     = r_wr;
+    assign done        = !eng_more && !a_valid && !r_valid;
+
+    genvar g;
+    generate
+        for (g = 0; g < LANES; g = g + 1) begin : lane_out
+            assign addr_out_rd[g*BANK_AW +: BANK_AW]     = r_src[g];
+            assign bank_out_rd[g*LANE_BITS +: LANE_BITS] = r_bank[g];
+        end
+    endgenerate
+
+endmodule
@@ -0,0 +1,176 @@
+// Testbench do motor de zoom em faixas: compara a memory3 do main.v com o
+// modelo em software (coproc_model.c), byte a byte, em todos os níveis.
+//
+// Os vetores saem do modelo (make vetores_sim, na raiz do repositório):
+// imagem.hex (enviada com STORE), instrucoes.hex (RESET, CTRL_SET_ZOOM em
+// todos os níveis e o BA em RGB332) e esperado.hex (a mem3 do modelo depois
+// de cada instrução). Depois de cada instrução o testbench lê a memory3
+// inteira com LOAD, como o coproc_read_block, e conta as divergências.
+// Também imprime os ciclos de clk_engine que a instrução levou e quantos
+// deles ficaram no ALGORITHM.
+//
+// O pll é substituído pelo módulo abaixo (clk_engine de 100 MHz e 25 MHz
+// para o VGA), então não entra o aux_files/pll.v. Os registradores e os
+// bancos não têm reset: como na FPGA, partem de zero (+initreg/+initmem).
+// No Questa/ModelSim, dentro de Coprocessador/sim:
+//
+//   vlib work
+//   vlog ../main.v ../memory_control.v ../aux_files/pyramid_ram.v \
+//        ../aux_files/vga_module.v ../aux_files/vga_controller.v tb_lanes.v
+//   vsim -c -gLANES=4 -voptargs="+acc +initreg+0 +initmem+0" work.tb_lanes \
+//        -do "run -all; quit -f"
+//
+// Termina com "PASSOU" ou "FALHOU"; repetir com LANES = 2, 8 e 16.
+`timescale 1ns / 1ps
+
+module tb_lanes;
+    parameter LANES = 4;
+
+    localparam PIXELS    = 76800;
+    localparam MAX_INSTR = 32;
+    localparam TIMEOUT   = 4000000; // Ciclos de clk_engine por instrução
+    localparam ALGORITHM = 4'b0010; // uc_state do main.v
+
+    reg         CLOCK_50 = 1'b0;
+    reg  [28:0] instruction = 29'd0; // pio_instruct
+    reg         ENABLE = 1'b0;
+    wire [7:0]  DATA_OUT;
+    wire        FLAG_DONE, FLAG_ERROR, FLAG_ZOOM_MAX, FLAG_ZOOM_MIN;
+    wire [27:0] STATUS;
+    wire [7:0]  VGA_R, VGA_G, VGA_B;
+    wire        VGA_BLANK_N, VGA_H_SYNC_N, VGA_V_SYNC_N, VGA_CLK, VGA_SYNC;
+
+    always #10 CLOCK_50 = !CLOCK_50;
+
+    // Mesma divisão do pio_instruct feita no ghrd_top.v
+    main #(.LANES(LANES)) dut(
+        .CLOCK_50(CLOCK_50),
+        .INSTRUCTION(instruction[2:0]),
+        .MEM_ADDR(instruction[19:3]),
+        .SEL_MEM(instruction[20]),
+        .DATA_IN(instruction[28:21]),
+        .ENABLE(ENABLE),
+        .DATA_OUT(DATA_OUT),
+        .FLAG_DONE(FLAG_DONE),
+        .FLAG_ERROR(FLAG_ERROR),
+        .FLAG_ZOOM_MAX(FLAG_ZOOM_MAX),
+        .FLAG_ZOOM_MIN(FLAG_ZOOM_MIN),
+        .STATUS(STATUS),
+        .VGA_R(VGA_R),
+        .VGA_B(VGA_B),
+        .VGA_G(VGA_G),
+        .VGA_BLANK_N(VGA_BLANK_N),
+        .VGA_H_SYNC_N(VGA_H_SYNC_N),
+        .VGA_V_SYNC_N(VGA_V_SYNC_N),
+        .VGA_CLK(VGA_CLK),
+        .VGA_SYNC(VGA_SYNC)
+    );
+
+    wire clk = dut.clk_engine;
+
+    reg  [7:0]  image    [0:PIXELS-1];
+    reg  [28:0] program  [0:MAX_INSTR-1];
+    reg  [7:0]  expected [0:MAX_INSTR*PIXELS-1];
+
+    // Nº de sequência da palavra de status (Gray no pio_flags[31:28])
+    wire [3:0] seq_gray = STATUS[27:24];
+    wire [3:0] seq = seq_gray ^ (seq_gray >> 1) ^ (seq_gray >> 2) ^ (seq_gray >> 3);
+    reg  [3:0] sent = 4'd0;
+
+    integer op_cycles, alg_cycles;
+    always @(posedge clk) begin
+        op_cycles <= op_cycles + 1;
+        if (dut.uc_state == ALGORITHM) alg_cycles <= alg_cycles + 1;
+    end
+
+    // Envia uma instrução como o HPS (pio_instruct, pulso no pio_enable) e
+    // espera a conclusão pelo nº de sequência, como o coproc_wait
+    task send;
+        input [28:0] word;
+        integer waited;
+        begin
+            @(negedge clk);
+            instruction = word;
+            ENABLE = 1'b1;
+            @(negedge clk);
+            ENABLE = 1'b0;
+            sent = sent + 1'b1;
+            waited = 0;
+            while (seq != sent && waited < TIMEOUT) begin
+                @(negedge clk);
+                waited = waited + 1;
+            end
+            if (seq != sent) begin
+                $display("FALHOU: instrução 0x%08x não terminou em %0d ciclos (uc_state %0d)",
+                         word, TIMEOUT, STATUS[6:3]);
+                $finish;
+            end
+        end
+    endtask
+
+    integer i, k, mismatches, first, failures;
+    reg [16:0] address;
+    reg [7:0]  first_got;
+
+    initial begin
+        for (k = 0; k < MAX_INSTR; k = k + 1) program[k] = 29'd0;
+        $readmemh("imagem.hex", image);
+        $readmemh("instrucoes.hex", program);
+        $readmemh("esperado.hex", expected);
+        failures = 0;
+
+        repeat (16) @(negedge clk);
+
+        // STORE de cada pixel na memory1
+        for (i = 0; i < PIXELS; i = i + 1) begin
+            address = i;
+            send({image[i], 1'b0, address, 3'b010});
+        end
+
+        for (k = 0; k < MAX_INSTR && program[k] != 29'd0; k = k + 1) begin
+            op_cycles  = 0;
+            alg_cycles = 0;
+            send(program[k]);
+            $write("instrução %0d (0x%08x): %0d ciclos, %0d no ALGORITHM", k, program[k],
+                   op_cycles, alg_cycles);
+
+            // LOAD de toda a memory3
+            mismatches = 0;
+            first      = -1;
+            for (i = 0; i < PIXELS; i = i + 1) begin
+                address = i;
+                send({8'd0, 1'b1, address, 3'b001});
+                if (DATA_OUT !== expected[k*PIXELS + i]) begin
+                    if (first < 0) begin
+                        first     = i;
+                        first_got = DATA_OUT;
+                    end
+                    mismatches = mismatches + 1;
+                end
+            end
+            if (mismatches) begin
+                $display(" - %0d pixels divergentes; primeiro em (%0d,%0d): %h != %h", mismatches,
+                         first % 320, first / 320, first_got, expected[k*PIXELS + first]);
+                failures = failures + 1;
+            end else begin
+                $display(" - ok");
+            end
+        end
+
+        if (failures) $display("FALHOU: %0d de %0d instruções divergiram do modelo (LANES = %0d)", failures, k, LANES);
+        else          $display("PASSOU: %0d instruções iguais ao modelo (LANES = %0d)", k, LANES);
+        $finish;
+    end
+
+endmodule
+
+// Substitui o IP do PLL na simulação: clk_engine (outclk_0) a 100 MHz e
+// clk_25_vga (outclk_1) a 25 MHz, alinhados como as saídas do mesmo VCO
+module pll(refclk, rst, outclk_0, outclk_1);
+    input  refclk, rst;
+    output reg outclk_0 = 1'b0;
+    output reg outclk_1 = 1'b0;
+
+    always #5  outclk_0 = !outclk_0;
+    always #20 outclk_1 = !outclk_1;
+endmodule
@@ -162,7 +162,7 @@ module soc_system (
 	input		memory_oct_rzqin;
 	input	[7:0]	pio_dataout_external_connection_export;
 	output		pio_enable_external_connection_export;
-	input	[3:0]	pio_flags_external_connection_export;
+	input	[31:0]	pio_flags_external_connection_export;
 	output	[28:0]	pio_instruct_external_connection_export;
 	input		reset_reset_n;
 endmodule
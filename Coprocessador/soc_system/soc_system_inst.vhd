@@ -79,7 +79,7 @@
 			memory_oct_rzqin                        : in    std_logic                     := 'X';             -- oct_rzqin
 			pio_dataout_external_connection_export  : in    std_logic_vector(7 downto 0)  := (others => 'X'); -- export
 			pio_enable_external_connection_export   : out   std_logic;                                        -- export
-			pio_flags_external_connection_export    : in    std_logic_vector(3 downto 0)  := (others => 'X'); -- export
+			pio_flags_external_connection_export    : in    std_logic_vector(31 downto 0)  := (others => 'X'); -- export
 			pio_instruct_external_connection_export : out   std_logic_vector(28 downto 0);                    -- export
 			reset_reset_n                           : in    std_logic                     := 'X'              -- reset_n
 		);
@@ -83,7 +83,7 @@ module soc_system (
 		input  wire        memory_oct_rzqin,                        //                                 .oct_rzqin
 		input  wire [7:0]  pio_dataout_external_connection_export,  //  pio_dataout_external_connection.export
 		output wire        pio_enable_external_connection_export,   //   pio_enable_external_connection.export
-		input  wire [3:0]  pio_flags_external_connection_export,    //    pio_flags_external_connection.export
+		input  wire [31:0] pio_flags_external_connection_export,    //    pio_flags_external_connection.export
 		output wire [28:0] pio_instruct_external_connection_export, // pio_instruct_external_connection.export
 		input  wire        reset_reset_n                            //                            reset.reset_n
 	);
@@ -0,0 +1,90 @@
+#ifndef API_FPGA_H
+#define API_FPGA_H
+
+/*
+ * =================================================================
+ * Declarações da API do Coprocessador
+ * =================================================================
+ * Protótipos das funções exportadas pelo backend do coprocessador.
+ * Dois backends implementam exatamente os mesmos símbolos:
+ *   - api_fpga.s      : driver em Assembly (MMIO via /dev/mem, placa)
+ *   - coproc_model.c  : modelo em software do main.v (x86, sem placa)
+ * O backend é escolhido na ligação (ver Makefile).
+ */
+
+#include <stdint.h>
+
+extern int setup_memory_map(void);
+extern void cleanup_memory_map(void);
+extern void coproc_write_pixel(uint32_t address, uint8_t value);
+extern uint8_t coproc_read_pixel(uint32_t address, uint32_t sel_mem);
+extern void coproc_read_block(uint32_t address, uint32_t count, uint32_t sel_mem, uint8_t *out);
+// Escrita por retângulo na mem1 (esperam o FLAG_DONE internamente)
+extern void coproc_rect_begin(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+extern void coproc_rect_data(const uint8_t *pixels, uint32_t count);
+extern void coproc_rect_run(uint8_t value, uint32_t count); // count <= RECT_RUN_MAX
+// Monta a pirâmide de zoom out a partir da mem1 (espera o FLAG_DONE)
+extern void coproc_pyramid_build(void);
+// coproc_apply_zoom*, coproc_pan_zoom_with_offset, coproc_set_view e
+// coproc_filter_run enviam sem esperar: não misturar com um ticket em
+// aberto do coproc_async.h (ver lá)
+extern void coproc_apply_zoom(uint32_t algorithm_code);
+extern void coproc_reset_image(void);
+extern uint32_t coproc_wait_done(void); // Retorna o nº de leituras do pio_flags
+// Palavra de status inteira (flags + campos STATUS_*), sem esperar. O
+// STATUS_SEQ já vem em binário (no pio_flags ele está em código Gray)
+extern uint32_t coproc_get_status(void);
+// Envia uma palavra de instrução já montada, sem esperar (ver coproc_async.h)
+extern void coproc_issue(uint32_t instruction);
+extern void coproc_apply_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset);
+extern void coproc_pan_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset);
+// Vai direto ao nível (ZOOM_*) em uma passada; algorithm_code = OP_*_ALG
+extern void coproc_set_view(uint32_t level, uint32_t x_offset, uint32_t y_offset, uint32_t algorithm_code);
+// Filtro 3x3: carrega os FILTER_TAPS coeficientes (espera o FLAG_DONE de cada
+// um) e aplica com flags = FILTER_FROM_MEM3 | FILTER_ABS (sem esperar)
+extern void coproc_filter_load(const int8_t *kernel);
+extern void coproc_filter_run(uint32_t flags, uint32_t shift);
+
+// Histograma e estatísticas (CTRL_STATS_*). coproc_stats_start zera e,
+// conforme o modo (STATS_*), conta as escritas na mem1 ou varre a
+// mem1/mem3; espera o FLAG_DONE. coproc_stats_read lê tudo de uma vez,
+// byte a byte pelo pio_dataout (STATS_BINS * 3 + 9 instruções).
+typedef struct {
+    uint32_t histogram[256]; // STATS_BINS: pixels com cada valor
+    uint32_t count;          // Pixels contados
+    uint32_t sum;            // Soma dos valores
+    uint8_t  min, max;       // 255 e 0 se count = 0
+} CoprocStats;
+extern void coproc_stats_start(uint32_t mode);
+extern void coproc_stats_read(CoprocStats *out);
+
+// LUT de exibição (CTRL_LUT): coproc_load_lut grava as LUT_ENTRIES
+// entradas de table nos canais LUT_* (LUT_GRAY = os três) e liga a LUT;
+// coproc_lut_enable(0) volta ao cinza sem LUT. Uma tabela por canal dá
+// falsa cor. Esperam o FLAG_DONE.
+extern void coproc_load_lut(uint32_t channels, const uint8_t *table);
+extern void coproc_lut_enable(uint32_t on);
+
+// Formato do pixel das memórias (CTRL_CONFIG/CONFIG_PIXEL_FORMAT):
+// PIXEL_GRAY8 ou PIXEL_RGB332. Vale para as próximas operações; a imagem
+// já carregada não é convertida. Espera o FLAG_DONE.
+extern void coproc_set_pixel_format(uint32_t format);
+
+// Orientação da imagem na tela (CTRL_CONFIG/CONFIG_ORIENTATION): ORIENT_*.
+// Só muda a leitura da memory2 pelo VGA, sem reprocessar a imagem. Espera
+// o FLAG_DONE.
+extern void coproc_set_orientation(uint32_t orientation);
+
+// Saída de vídeo (CTRL_CONFIG/CONFIG_SCANOUT): SCANOUT_BOX, SCANOUT_2X ou
+// SCANOUT_2X_BILINEAR. Também só muda o VGA. Espera o FLAG_DONE.
+extern void coproc_set_scanout(uint32_t mode);
+
+// Retângulo sobreposto à imagem na saída de vídeo (CONFIG_OVERLAY*), em
+// coordenadas da imagem (x < 320, y < 240, w e h de 1 a 320/240).
+// coproc_overlay_rect grava tamanho e posição e liga; coproc_overlay_move
+// só muda a posição (uma instrução). Esperam o FLAG_DONE.
+extern void coproc_overlay_rect(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+extern void coproc_overlay_move(uint32_t x, uint32_t y);
+extern void coproc_overlay_enable(uint32_t on);
+
+#endif // API_FPGA_H
@@ -34,9 +34,29 @@
 .global cleanup_memory_map
 .global coproc_write_pixel
 .global coproc_read_pixel
+.global coproc_read_block
+.global coproc_rect_begin
+.global coproc_rect_data
+.global coproc_rect_run
+.global coproc_pyramid_build
+.global coproc_set_view
+.global coproc_filter_load
+.global coproc_filter_run
+.global coproc_stats_start
+.global coproc_stats_read
+.global coproc_load_lut
+.global coproc_lut_enable
+.global coproc_set_pixel_format
+.global coproc_set_orientation
+.global coproc_set_scanout
+.global coproc_overlay_rect
+.global coproc_overlay_move
+.global coproc_overlay_enable
 .global coproc_apply_zoom
 .global coproc_reset_image
 .global coproc_wait_done
+.global coproc_get_status
+.global coproc_issue
 .global coproc_apply_zoom_with_offset
 .global coproc_pan_zoom_with_offset  @ <-- LINHA NOVA (PARA PAN)
 
@@ -200,24 +220,63 @@ cleanup_memory_map:
 
 @ ============================================================================
 @ Função: coproc_wait_done
+@ Retorna (r0) o número de leituras do pio_flags até ver o FLAG_DONE.
 @ ============================================================================
 .type coproc_wait_done, %function
 coproc_wait_done:
-    push    {r0, r1, lr}
+    push    {r1-r3, lr}
     
-    ldr     r0, =g_pio_flags_ptr
-    ldr     r0, [r0]        @ r0 = g_pio_flags_ptr
+    ldr     r1, =g_pio_flags_ptr
+    ldr     r1, [r1]        @ r1 = g_pio_flags_ptr
+    ldr     r2, =FLAG_DONE_MASK
+    mov     r0, #0          @ r0 = iterações de espera
     
 wait_loop$:
-    ldr     r1, [r0]        @ r1 = *g_pio_flags_ptr
-    ldr     r2, =FLAG_DONE_MASK
-    tst     r1, r2          @ (r1 & FLAG_DONE_MASK)
+    add     r0, r0, #1
+    ldr     r3, [r1]        @ r3 = *g_pio_flags_ptr
+    tst     r3, r2          @ (r3 & FLAG_DONE_MASK)
     beq     wait_loop$      @ Loop se for 0
     
-    pop     {r0, r1, pc}
+    pop     {r1-r3, pc}
 .size coproc_wait_done, .-coproc_wait_done
 
 
+@ ============================================================================
+@ Função: coproc_get_status
+@ Retorna (r0) a palavra inteira do pio_flags: flags em [3:0] e status
+@ em [31:4] (campos STATUS_* em constantes.h). Uma única leitura, sem espera.
+@ O nº de sequência [31:28] vem em código Gray e é devolvido em binário.
+@ ============================================================================
+.type coproc_get_status, %function
+coproc_get_status:
+    ldr     r0, =g_pio_flags_ptr
+    ldr     r0, [r0]
+    ldr     r0, [r0]        @ r0 = *g_pio_flags_ptr
+    lsr     r1, r0, #28     @ r1 = g (Gray, 4 bits)
+    eor     r1, r1, r1, lsr #1
+    eor     r1, r1, r1, lsr #2  @ r1 = g ^ g>>1 ^ g>>2 ^ g>>3 (binário)
+    bic     r0, r0, #0xF0000000
+    orr     r0, r0, r1, lsl #28
+    bx      lr
+.size coproc_get_status, .-coproc_get_status
+
+
+@ ============================================================================
+@ Função: coproc_issue
+@ Escreve a palavra de instrução já montada (r0) e pulsa o enable, sem
+@ esperar. Base do coproc_submit (coproc_async.c).
+@ ============================================================================
+.type coproc_issue, %function
+coproc_issue:
+    push    {r1, lr}
+    ldr     r1, =g_pio_instruct_ptr
+    ldr     r1, [r1]
+    str     r0, [r1]
+    bl      pio_pulse_enable
+    pop     {r1, pc}
+.size coproc_issue, .-coproc_issue
+
+
 @ ============================================================================
 @ Função: coproc_apply_zoom
 @ ============================================================================
@@ -325,6 +384,196 @@ coproc_read_pixel:
 .size coproc_read_pixel, .-coproc_read_pixel
 
 
+@ ============================================================================
+@ Função: coproc_read_block
+@ Lê count pixels consecutivos (LOAD) a partir de address para out.
+@ Mesmo protocolo de coproc_read_pixel, mas com os ponteiros dos PIOs e a
+@ instrução mantidos em registradores durante todo o laço.
+@ ============================================================================
+.type coproc_read_block, %function
+coproc_read_block:
+    push    {r4-r9, lr}
+    @ r0 = address, r1 = count, r2 = sel_mem, r3 = out
+
+    cmp     r1, #0
+    beq     read_block_end$
+
+    ldr     r4, =g_pio_instruct_ptr
+    ldr     r4, [r4]                @ r4 = g_pio_instruct_ptr
+    ldr     r5, =g_pio_enable_ptr
+    ldr     r5, [r5]                @ r5 = g_pio_enable_ptr
+    ldr     r6, =g_pio_flags_ptr
+    ldr     r6, [r6]                @ r6 = g_pio_flags_ptr
+    ldr     r7, =g_pio_dataout_ptr
+    ldr     r7, [r7]                @ r7 = g_pio_dataout_ptr
+
+    @ r8 = OP_LOAD | (address << 3) | (sel_mem << 20)
+    ldr     r8, =OP_LOAD
+    orr     r8, r8, r0, lsl #3
+    orr     r8, r8, r2, lsl #20
+
+    mov     r0, #0                  @ Constantes do pulso de enable
+    mov     r2, #1
+
+read_block_loop$:
+    str     r8, [r4]                @ Instrução
+    str     r2, [r5]                @ *g_pio_enable_ptr = 1;
+    str     r0, [r5]                @ *g_pio_enable_ptr = 0;
+
+read_block_wait$:
+    ldr     r9, [r6]
+    tst     r9, #FLAG_DONE_MASK
+    beq     read_block_wait$
+
+    ldr     r9, [r7]                @ Pixel lido
+    strb    r9, [r3], #1            @ *out++ = (uint8_t)pixel
+    add     r8, r8, #(1 << 3)       @ Próximo endereço (MEM_ADDR += 1)
+    subs    r1, r1, #1
+    bne     read_block_loop$
+
+read_block_end$:
+    pop     {r4-r9, pc}
+.size coproc_read_block, .-coproc_read_block
+
+
+@ ============================================================================
+@ Função: coproc_rect_begin
+@ Abre um retângulo de escrita na mem1: EXT_RECT_ORIGIN (x, y) seguido de
+@ EXT_RECT_SIZE (w - 1, h - 1), esperando o FLAG_DONE de cada um.
+@ ============================================================================
+.type coproc_rect_begin, %function
+coproc_rect_begin:
+    push    {r4-r6, lr}
+    @ r0 = x, r1 = y, r2 = w, r3 = h
+
+    ldr     r4, =g_pio_instruct_ptr
+    ldr     r4, [r4]                @ r4 = g_pio_instruct_ptr
+    ldr     r6, =g_pio_flags_ptr
+    ldr     r6, [r6]                @ r6 = g_pio_flags_ptr
+
+    @ r5 = OP_EXT | (EXT_RECT_ORIGIN << 18) | (x << 3) | (y << 21)
+    ldr     r5, =(OP_EXT | (EXT_RECT_ORIGIN << (EXT_SUBOP_SHIFT + 3)))
+    orr     r5, r5, r0, lsl #3
+    orr     r5, r5, r1, lsl #21
+    str     r5, [r4]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    @ r5 = OP_EXT | (EXT_RECT_SIZE << 18) | ((w - 1) << 3) | ((h - 1) << 21)
+    ldr     r5, =(OP_EXT | (EXT_RECT_SIZE << (EXT_SUBOP_SHIFT + 3)))
+    sub     r2, r2, #1
+    sub     r3, r3, #1
+    orr     r5, r5, r2, lsl #3
+    orr     r5, r5, r3, lsl #21
+    str     r5, [r4]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4-r6, pc}
+.size coproc_rect_begin, .-coproc_rect_begin
+
+
+@ ============================================================================
+@ Função: coproc_rect_data
+@ Envia count pixels ao retângulo aberto, três por instrução
+@ (OP_RECT_DATA: DATA_IN = p0, MEM_ADDR[7:0] = p1, MEM_ADDR[15:8] = p2),
+@ com os ponteiros dos PIOs em registradores durante todo o laço.
+@ ============================================================================
+.type coproc_rect_data, %function
+coproc_rect_data:
+    push    {r4-r9, lr}
+    @ r0 = pixels, r1 = count
+
+    cmp     r1, #0
+    beq     rect_data_end$
+
+    ldr     r4, =g_pio_instruct_ptr
+    ldr     r4, [r4]                @ r4 = g_pio_instruct_ptr
+    ldr     r5, =g_pio_enable_ptr
+    ldr     r5, [r5]                @ r5 = g_pio_enable_ptr
+    ldr     r6, =g_pio_flags_ptr
+    ldr     r6, [r6]                @ r6 = g_pio_flags_ptr
+    ldr     r7, =OP_RECT_DATA
+    mov     r8, #1                  @ Constantes do pulso de enable
+    mov     r9, #0
+
+rect_data_loop$:
+    ldrb    r3, [r0], #1            @ Pixel 0 -> DATA_IN
+    orr     r3, r7, r3, lsl #21
+    cmp     r1, #1
+    beq     rect_data_send$
+    ldrb    r2, [r0], #1            @ Pixel 1 -> MEM_ADDR[7:0]
+    orr     r3, r3, r2, lsl #3
+    cmp     r1, #2
+    beq     rect_data_send$
+    ldrb    r2, [r0], #1            @ Pixel 2 -> MEM_ADDR[15:8]
+    orr     r3, r3, r2, lsl #11
+
+rect_data_send$:
+    str     r3, [r4]                @ Instrução
+    str     r8, [r5]                @ *g_pio_enable_ptr = 1;
+    str     r9, [r5]                @ *g_pio_enable_ptr = 0;
+
+rect_data_wait$:
+    ldr     r2, [r6]
+    tst     r2, #FLAG_DONE_MASK
+    beq     rect_data_wait$
+
+    subs    r1, r1, #RECT_PIXELS_PER_BEAT
+    bgt     rect_data_loop$
+
+rect_data_end$:
+    pop     {r4-r9, pc}
+.size coproc_rect_data, .-coproc_rect_data
+
+
+@ ============================================================================
+@ Função: coproc_rect_run
+@ Escreve count pixels iguais a value no retângulo aberto com uma única
+@ instrução (EXT_RECT_RUN: MEM_ADDR[14:0] = count - 1, DATA_IN = value).
+@ ============================================================================
+.type coproc_rect_run, %function
+coproc_rect_run:
+    push    {r4, lr}
+    @ r0 = value, r1 = count
+
+    ldr     r4, =g_pio_instruct_ptr
+    ldr     r4, [r4]                @ r4 = g_pio_instruct_ptr
+
+    @ r2 = OP_EXT | (EXT_RECT_RUN << 18) | ((count - 1) << 3) | (value << 21)
+    ldr     r2, =(OP_EXT | (EXT_RECT_RUN << (EXT_SUBOP_SHIFT + 3)))
+    sub     r1, r1, #1
+    orr     r2, r2, r1, lsl #3
+    and     r0, r0, #0xFF
+    orr     r2, r2, r0, lsl #21
+    str     r2, [r4]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_rect_run, .-coproc_rect_run
+
+
+@ ============================================================================
+@ Função: coproc_pyramid_build
+@ EXT_CTRL / CTRL_PYRAMID_BUILD: a FPGA lê a mem1 uma vez e guarda as
+@ janelas de zoom out (BA e NH, 1/2, 1/4 e 1/8). Espera o FLAG_DONE.
+@ ============================================================================
+.type coproc_pyramid_build, %function
+coproc_pyramid_build:
+    push    {r4, lr}
+
+    ldr     r4, =g_pio_instruct_ptr
+    ldr     r4, [r4]                @ r4 = g_pio_instruct_ptr
+    ldr     r0, =(OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_PYRAMID_BUILD << (EXT_CTRL_SHIFT + 3)))
+    str     r0, [r4]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_pyramid_build, .-coproc_pyramid_build
+
+
 @ ============================================================================
 @ Função: coproc_apply_zoom_with_offset
 @ ============================================================================
@@ -392,4 +641,439 @@ coproc_pan_zoom_with_offset:
     bl      pio_pulse_enable
     
     pop     {r0-r4, pc}
-.size coproc_pan_zoom_with_offset, .-coproc_pan_zoom_with_offset
\ No newline at end of file
+.size coproc_pan_zoom_with_offset, .-coproc_pan_zoom_with_offset
+
+
+@ ============================================================================
+@ Função: coproc_set_view
+@ EXT_CTRL / CTRL_SET_ZOOM: vai direto ao nível (ZOOM_*) com o algoritmo e
+@ os offsets dados, numa única passada. Como coproc_apply_zoom, não espera.
+@ ============================================================================
+.type coproc_set_view, %function
+coproc_set_view:
+    push    {r4, lr}
+    @ r0 = level, r1 = x_offset, r2 = y_offset, r3 = algorithm_code
+
+    @ r4 = OP_EXT | (EXT_CTRL << 18) | ((CTRL_SET_ZOOM | level) << 14)
+    @      | ((algorithm_code - OP_NHI_ALG) << 12) | (x << 3) | (y << 21)
+    ldr     r4, =(OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_SET_ZOOM << (EXT_CTRL_SHIFT + 3)))
+    orr     r4, r4, r0, lsl #(EXT_CTRL_SHIFT + 3)
+    sub     r3, r3, #OP_NHI_ALG
+    orr     r4, r4, r3, lsl #(SET_ZOOM_ALG_SHIFT + 3)
+    orr     r4, r4, r1, lsl #3
+    orr     r4, r4, r2, lsl #21
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+
+    pop     {r4, pc}
+.size coproc_set_view, .-coproc_set_view
+
+
+@ ============================================================================
+@ Função: coproc_filter_load
+@ EXT_CTRL / CTRL_FILTER_COEF: carrega os FILTER_TAPS coeficientes do filtro
+@ 3x3 (int8_t, ordem de varredura), um por instrução, esperando o FLAG_DONE
+@ de cada um.
+@ ============================================================================
+.type coproc_filter_load, %function
+coproc_filter_load:
+    push    {r4-r8, lr}
+    @ r0 = kernel
+
+    mov     r5, r0                  @ r5 = kernel
+    ldr     r4, =g_pio_instruct_ptr
+    ldr     r4, [r4]                @ r4 = g_pio_instruct_ptr
+    mov     r6, #0                  @ r6 = índice
+
+filter_load_loop$:
+    @ r7 = OP_EXT | (EXT_CTRL << 18) | (CTRL_FILTER_COEF << 14)
+    @      | (índice << 10) | ((uint8_t)kernel[índice] << 21)
+    ldr     r7, =(OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_FILTER_COEF << (EXT_CTRL_SHIFT + 3)))
+    orr     r7, r7, r6, lsl #(FILTER_INDEX_SHIFT + 3)
+    ldrb    r0, [r5, r6]
+    orr     r7, r7, r0, lsl #21
+    str     r7, [r4]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    add     r6, r6, #1
+    cmp     r6, #FILTER_TAPS
+    blt     filter_load_loop$
+
+    pop     {r4-r8, pc}
+.size coproc_filter_load, .-coproc_filter_load
+
+
+@ ============================================================================
+@ Função: coproc_filter_run
+@ EXT_CTRL / CTRL_FILTER_RUN: aplica o filtro carregado (flags =
+@ FILTER_FROM_MEM3 | FILTER_ABS, shift = deslocamento da soma) e copia a
+@ mem3 para a tela. Como coproc_set_view, não espera.
+@ ============================================================================
+.type coproc_filter_run, %function
+coproc_filter_run:
+    push    {r4, lr}
+    @ r0 = flags, r1 = shift
+
+    @ r4 = OP_EXT | (EXT_CTRL << 18) | (CTRL_FILTER_RUN << 14) | ((flags | shift) << 3)
+    and     r1, r1, #FILTER_SHIFT_MASK
+    orr     r0, r0, r1
+    ldr     r4, =(OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_FILTER_RUN << (EXT_CTRL_SHIFT + 3)))
+    orr     r4, r4, r0, lsl #3
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+
+    pop     {r4, pc}
+.size coproc_filter_run, .-coproc_filter_run
+
+
+@ ============================================================================
+@ Função: coproc_stats_start
+@ EXT_CTRL / CTRL_STATS_START: zera o histograma e, conforme o modo
+@ (STATS_*), conta as escritas na mem1 ou varre a mem1/mem3. Espera o
+@ FLAG_DONE.
+@ ============================================================================
+.type coproc_stats_start, %function
+coproc_stats_start:
+    push    {r4, lr}
+    @ r0 = mode
+
+    @ r4 = OP_EXT | (EXT_CTRL << 18) | (CTRL_STATS_START << 14) | (mode << 12)
+    ldr     r4, =STATS_START_INSTRUCTION(0)
+    orr     r4, r4, r0, lsl #(STATS_MODE_SHIFT + 3)
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_stats_start, .-coproc_stats_start
+
+
+@ --- Função interna: stats_read_word ---
+@ Lê os r1 bytes do registrador da instrução CTRL_STATS_READ de r8 (byte 0),
+@ um por instrução, esperando o FLAG_DONE de cada, e devolve o valor em r9.
+@ Usa os ponteiros dos PIOs em r4-r7 (coproc_stats_read); altera r0, r1,
+@ r10 e r12.
+.type stats_read_word, %function
+stats_read_word:
+    mov     r0, r8                  @ Instrução do byte atual
+    mov     r9, #0
+    mov     r10, #0                 @ Deslocamento do byte atual
+
+stats_read_byte$:
+    mov     r12, #1
+    str     r0, [r4]                @ Instrução
+    str     r12, [r5]               @ *g_pio_enable_ptr = 1;
+    mov     r12, #0
+    str     r12, [r5]               @ *g_pio_enable_ptr = 0;
+
+stats_read_wait$:
+    ldr     r12, [r6]
+    tst     r12, #FLAG_DONE_MASK
+    beq     stats_read_wait$
+
+    ldr     r12, [r7]               @ Byte lido
+    and     r12, r12, #0xFF
+    orr     r9, r9, r12, lsl r10
+    add     r0, r0, #(1 << (STATS_BYTE_SHIFT + 3)) @ Próximo byte
+    add     r10, r10, #8
+    subs    r1, r1, #1
+    bne     stats_read_byte$
+    bx      lr
+.size stats_read_word, .-stats_read_word
+
+
+@ ============================================================================
+@ Função: coproc_stats_read
+@ Lê os STATS_BINS contadores do histograma e os registradores de
+@ contagem, soma e mínimo/máximo (CTRL_STATS_READ) para um CoprocStats,
+@ com os ponteiros dos PIOs em registradores durante todo o laço. Cada
+@ registrador vem em STATS_REG_BYTES(reg) bytes pelo pio_dataout.
+@ ============================================================================
+.type coproc_stats_read, %function
+coproc_stats_read:
+    push    {r4-r10, lr}
+    @ r0 = out
+
+    mov     r3, r0                  @ r3 = out
+    ldr     r4, =g_pio_instruct_ptr
+    ldr     r4, [r4]                @ r4 = g_pio_instruct_ptr
+    ldr     r5, =g_pio_enable_ptr
+    ldr     r5, [r5]                @ r5 = g_pio_enable_ptr
+    ldr     r6, =g_pio_flags_ptr
+    ldr     r6, [r6]                @ r6 = g_pio_flags_ptr
+    ldr     r7, =g_pio_dataout_ptr
+    ldr     r7, [r7]                @ r7 = g_pio_dataout_ptr
+
+    @ out->histogram[i], com o valor i em DATA_IN
+    ldr     r8, =STATS_READ_INSTRUCTION(STATS_REG_BIN, 0, 0)
+    mov     r2, #STATS_BINS
+
+stats_read_loop$:
+    mov     r1, #3                  @ STATS_REG_BYTES(STATS_REG_BIN)
+    bl      stats_read_word
+    str     r9, [r3], #4
+    add     r8, r8, #(1 << 21)      @ Próximo valor (DATA_IN += 1)
+    subs    r2, r2, #1
+    bne     stats_read_loop$
+
+    @ out->count, out->sum
+    ldr     r8, =STATS_READ_INSTRUCTION(STATS_REG_COUNT, 0, 0)
+    mov     r1, #3                  @ STATS_REG_BYTES(STATS_REG_COUNT)
+    bl      stats_read_word
+    str     r9, [r3], #4
+    ldr     r8, =STATS_READ_INSTRUCTION(STATS_REG_SUM, 0, 0)
+    mov     r1, #4                  @ STATS_REG_BYTES(STATS_REG_SUM)
+    bl      stats_read_word
+    str     r9, [r3], #4
+
+    @ out->min = [7:0], out->max = [15:8]
+    ldr     r8, =STATS_READ_INSTRUCTION(STATS_REG_MINMAX, 0, 0)
+    mov     r1, #2                  @ STATS_REG_BYTES(STATS_REG_MINMAX)
+    bl      stats_read_word
+    strb    r9, [r3], #1
+    lsr     r9, r9, #8
+    strb    r9, [r3]
+
+    pop     {r4-r10, pc}
+.size coproc_stats_read, .-coproc_stats_read
+
+
+@ ============================================================================
+@ Função: coproc_load_lut
+@ EXT_CTRL / CTRL_LUT: grava as LUT_ENTRIES entradas de table nos canais
+@ (LUT_RED | LUT_GREEN | LUT_BLUE), uma por instrução, e liga a LUT.
+@ Espera o FLAG_DONE de cada uma.
+@ ============================================================================
+.type coproc_load_lut, %function
+coproc_load_lut:
+    push    {r4-r8, lr}
+    @ r0 = channels, r1 = table
+
+    mov     r5, r1                  @ r5 = table
+    ldr     r4, =g_pio_instruct_ptr
+    ldr     r4, [r4]                @ r4 = g_pio_instruct_ptr
+    mov     r6, #0                  @ r6 = índice
+
+    @ r8 = OP_EXT | (EXT_CTRL << 18) | (CTRL_LUT << 14) | (channels << 11)
+    ldr     r8, =LUT_WRITE_INSTRUCTION(0, 0, 0)
+    orr     r8, r8, r0, lsl #(LUT_CHANNEL_SHIFT + 3)
+
+lut_load_loop$:
+    @ r7 = r8 | (índice << 3) | (table[índice] << 21)
+    orr     r7, r8, r6, lsl #3
+    ldrb    r0, [r5, r6]
+    orr     r7, r7, r0, lsl #21
+    str     r7, [r4]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    add     r6, r6, #1
+    cmp     r6, #LUT_ENTRIES
+    blt     lut_load_loop$
+
+    mov     r0, #1
+    bl      coproc_lut_enable
+
+    pop     {r4-r8, pc}
+.size coproc_load_lut, .-coproc_load_lut
+
+
+@ ============================================================================
+@ Função: coproc_lut_enable
+@ EXT_CTRL / CTRL_LUT sem canal: liga (on = 1) ou desliga a LUT de
+@ exibição. Espera o FLAG_DONE.
+@ ============================================================================
+.type coproc_lut_enable, %function
+coproc_lut_enable:
+    push    {r4, lr}
+    @ r0 = on
+
+    @ r4 = OP_EXT | (EXT_CTRL << 18) | (CTRL_LUT << 14) | ((on & 1) << 3)
+    and     r0, r0, #1
+    ldr     r4, =LUT_ENABLE_INSTRUCTION(0)
+    orr     r4, r4, r0, lsl #3
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_lut_enable, .-coproc_lut_enable
+
+
+@ ============================================================================
+@ Função: coproc_set_pixel_format
+@ EXT_CTRL / CTRL_CONFIG no registrador CONFIG_PIXEL_FORMAT: PIXEL_GRAY8 ou
+@ PIXEL_RGB332. Espera o FLAG_DONE.
+@ ============================================================================
+.type coproc_set_pixel_format, %function
+coproc_set_pixel_format:
+    push    {r4, lr}
+    @ r0 = format
+
+    @ r4 = OP_EXT | (EXT_CTRL << 18) | (CTRL_CONFIG << 14) | (CONFIG_PIXEL_FORMAT << 11) | ((format & 0xFF) << 3)
+    and     r0, r0, #0xFF
+    ldr     r4, =CONFIG_INSTRUCTION(CONFIG_PIXEL_FORMAT, 0)
+    orr     r4, r4, r0, lsl #3
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_set_pixel_format, .-coproc_set_pixel_format
+
+
+@ ============================================================================
+@ Função: coproc_set_orientation
+@ EXT_CTRL / CTRL_CONFIG no registrador CONFIG_ORIENTATION: ORIENT_* (3 bits,
+@ troca x/y, espelha x, espelha y). Espera o FLAG_DONE.
+@ ============================================================================
+.type coproc_set_orientation, %function
+coproc_set_orientation:
+    push    {r4, lr}
+    @ r0 = orientation
+
+    @ r4 = OP_EXT | (EXT_CTRL << 18) | (CTRL_CONFIG << 14) | (CONFIG_ORIENTATION << 11) | ((orientation & 0x7) << 3)
+    and     r0, r0, #0x7
+    ldr     r4, =CONFIG_INSTRUCTION(CONFIG_ORIENTATION, 0)
+    orr     r4, r4, r0, lsl #3
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_set_orientation, .-coproc_set_orientation
+
+
+@ ============================================================================
+@ Função: coproc_set_scanout
+@ EXT_CTRL / CTRL_CONFIG no registrador CONFIG_SCANOUT: SCANOUT_BOX,
+@ SCANOUT_2X ou SCANOUT_2X_BILINEAR. Espera o FLAG_DONE.
+@ ============================================================================
+.type coproc_set_scanout, %function
+coproc_set_scanout:
+    push    {r4, lr}
+    @ r0 = mode
+
+    @ r4 = OP_EXT | (EXT_CTRL << 18) | (CTRL_CONFIG << 14) | (CONFIG_SCANOUT << 11) | ((mode & 0xFF) << 3)
+    and     r0, r0, #0xFF
+    ldr     r4, =CONFIG_INSTRUCTION(CONFIG_SCANOUT, 0)
+    orr     r4, r4, r0, lsl #3
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_set_scanout, .-coproc_set_scanout
+
+
+@ ============================================================================
+@ Função: coproc_overlay_rect
+@ Retângulo sobreposto: CONFIG_OVERLAY_SIZE com (w - 1, h - 1), depois
+@ coproc_overlay_move(x, y) e coproc_overlay_enable(1). Espera o FLAG_DONE.
+@ ============================================================================
+.type coproc_overlay_rect, %function
+coproc_overlay_rect:
+    push    {r4-r6, lr}
+    @ r0 = x, r1 = y, r2 = w, r3 = h
+    mov     r5, r0
+    mov     r6, r1
+
+    @ r4 = CONFIG_INSTRUCTION(CONFIG_OVERLAY_SIZE, 0) | (((w - 1) & 0x1FF) << 3) | (((h - 1) & 0xFF) << 21)
+    sub     r2, r2, #1
+    sub     r3, r3, #1
+    ldr     r4, =CONFIG_INSTRUCTION(CONFIG_OVERLAY_SIZE, 0)
+    ldr     r0, =0x1FF
+    and     r2, r2, r0
+    orr     r4, r4, r2, lsl #3
+    and     r3, r3, #0xFF
+    orr     r4, r4, r3, lsl #21
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    mov     r0, r5
+    mov     r1, r6
+    bl      coproc_overlay_move
+    mov     r0, #1
+    bl      coproc_overlay_enable
+
+    pop     {r4-r6, pc}
+.size coproc_overlay_rect, .-coproc_overlay_rect
+
+
+@ ============================================================================
+@ Função: coproc_overlay_move
+@ CONFIG_OVERLAY_POS: x em MEM_ADDR[8:0] (o bit 8 cai no registrador 0x5),
+@ y em DATA_IN. Espera o FLAG_DONE.
+@ ============================================================================
+.type coproc_overlay_move, %function
+coproc_overlay_move:
+    push    {r4, lr}
+    @ r0 = x, r1 = y
+
+    @ r4 = CONFIG_INSTRUCTION(CONFIG_OVERLAY_POS, 0) | ((x & 0x1FF) << 3) | ((y & 0xFF) << 21)
+    ldr     r4, =CONFIG_INSTRUCTION(CONFIG_OVERLAY_POS, 0)
+    ldr     r2, =0x1FF
+    and     r0, r0, r2
+    orr     r4, r4, r0, lsl #3
+    and     r1, r1, #0xFF
+    orr     r4, r4, r1, lsl #21
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_overlay_move, .-coproc_overlay_move
+
+
+@ ============================================================================
+@ Função: coproc_overlay_enable
+@ CONFIG_OVERLAY: liga (on = 1) ou desliga o retângulo sobreposto.
+@ Espera o FLAG_DONE.
+@ ============================================================================
+.type coproc_overlay_enable, %function
+coproc_overlay_enable:
+    push    {r4, lr}
+    @ r0 = on
+
+    @ r4 = CONFIG_INSTRUCTION(CONFIG_OVERLAY, 0) | ((on & 1) << 3)
+    and     r0, r0, #1
+    ldr     r4, =CONFIG_INSTRUCTION(CONFIG_OVERLAY, 0)
+    orr     r4, r4, r0, lsl #3
+
+    ldr     r3, =g_pio_instruct_ptr
+    ldr     r3, [r3]
+    str     r4, [r3]
+    bl      pio_pulse_enable
+    bl      coproc_wait_done
+
+    pop     {r4, pc}
+.size coproc_overlay_enable, .-coproc_overlay_enable
@@ -0,0 +1,412 @@
+/*
+ * =================================================================
+ * bench.c
+ * =================================================================
+ * Suíte de benchmark do coprocessador (make bench).
+ *
+ * Exercita cada caminho da API muitas vezes e reporta latência
+ * (p50/p95/p99, média, mínimo e máximo) e vazão, em JSON ou CSV, para
+ * que os números possam ser versionados e comparados entre releases.
+ *
+ * Casos medidos:
+ *   upload          : envio da imagem inteira (76.800 x STORE + espera)
+ *   <alg>_<nível>   : cada algoritmo em cada nível de zoom
+ *                     (pr/nhi: 2x, 4x, 8x; ba/nh: 1/2, 1/4, 1/8)
+ *   pan_<alg>_2x    : passos de pan de MOVE_STEP pixels em 2x
+ *   reset           : RESET (cópia mem1 -> exibição)
+ *   readback        : leitura de uma linha (320 pixels) com LOAD
+ *   view_<alg>_<nível>: CTRL_SET_ZOOM direto da mem1 ao nível
+ *   filter          : filtro 3x3 sobre a mem1 (coeficientes já carregados)
+ *   stats           : histograma da mem1 (varredura + leitura dos contadores)
+ *   ticket_pr_2x    : zoom in 2x por coproc_submit + coproc_wait
+ *   pyramid         : montagem da pirâmide de zoom out
+ *   upload_rect     : envio da imagem inteira por retângulo (3 pixels/STORE)
+ *   upload_rle      : envio da imagem inteira em corridas (RECT_RUN)
+ *
+ * O mesmo código é ligado ao backend da placa (api_fpga.s) ou ao
+ * modelo em software (coproc_model.c); ver Makefile. Com o modelo, os
+ * tempos são do software no PC e não dizem nada da latência da FPGA:
+ * a saída traz o campo "source" para que não sejam confundidos.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "constantes.h"
+#include "api_fpga.h"
+#include "coproc_async.h"
+
+#ifndef COPROC_BACKEND
+#define COPROC_BACKEND "fpga"
+#endif
+
+#define IMG_WIDTH  320
+#define IMG_HEIGHT 240
+#define NUM_PIXELS (IMG_WIDTH * IMG_HEIGHT)
+#define MOVE_STEP  10
+
+#define DEFAULT_ITERATIONS 50
+
+typedef enum {
+    CASE_UPLOAD,
+    CASE_ZOOM_IN,
+    CASE_ZOOM_OUT,
+    CASE_PAN,
+    CASE_RESET,
+    CASE_READBACK,
+    CASE_SET_VIEW,
+    CASE_FILTER,
+    CASE_STATS,
+    CASE_TICKET,
+    CASE_PYRAMID,
+    CASE_UPLOAD_RECT,
+    CASE_UPLOAD_RLE
+} CaseKind;
+
+typedef struct {
+    const char *name;
+    CaseKind    kind;
+    uint32_t    algorithm; // Opcode usado pelo caso
+    int         steps;     // Nº de passos de zoom até o nível medido (inclui o medido)
+    uint32_t    pixels;    // Pixels produzidos/transferidos por operação
+    uint32_t    level;     // CASE_SET_VIEW: nível pedido (ZOOM_*)
+} BenchCase;
+
+static const BenchCase g_cases[] = {
+    { "upload",     CASE_UPLOAD,   OP_STORE,   0, NUM_PIXELS },
+    { "pr_2x",      CASE_ZOOM_IN,  OP_PR_ALG,  1, NUM_PIXELS },
+    { "pr_4x",      CASE_ZOOM_IN,  OP_PR_ALG,  2, NUM_PIXELS },
+    { "pr_8x",      CASE_ZOOM_IN,  OP_PR_ALG,  3, NUM_PIXELS },
+    { "nhi_2x",     CASE_ZOOM_IN,  OP_NHI_ALG, 1, NUM_PIXELS },
+    { "nhi_4x",     CASE_ZOOM_IN,  OP_NHI_ALG, 2, NUM_PIXELS },
+    { "nhi_8x",     CASE_ZOOM_IN,  OP_NHI_ALG, 3, NUM_PIXELS },
+    { "ba_1_2",     CASE_ZOOM_OUT, OP_BA_ALG,  1, NUM_PIXELS },
+    { "ba_1_4",     CASE_ZOOM_OUT, OP_BA_ALG,  2, NUM_PIXELS },
+    { "ba_1_8",     CASE_ZOOM_OUT, OP_BA_ALG,  3, NUM_PIXELS },
+    { "nh_1_2",     CASE_ZOOM_OUT, OP_NH_ALG,  1, NUM_PIXELS },
+    { "nh_1_4",     CASE_ZOOM_OUT, OP_NH_ALG,  2, NUM_PIXELS },
+    { "nh_1_8",     CASE_ZOOM_OUT, OP_NH_ALG,  3, NUM_PIXELS },
+    { "pan_pr_2x",  CASE_PAN,      OP_PR_ALG,  1, NUM_PIXELS },
+    { "pan_nhi_2x", CASE_PAN,      OP_NHI_ALG, 1, NUM_PIXELS },
+    { "reset",      CASE_RESET,    OP_RESET,   0, NUM_PIXELS },
+    { "readback",   CASE_READBACK, OP_LOAD,    0, IMG_WIDTH  },
+    { "view_pr_8x",   CASE_SET_VIEW,    OP_PR_ALG,  0, NUM_PIXELS, ZOOM_8X   },
+    { "view_nhi_4x",  CASE_SET_VIEW,    OP_NHI_ALG, 0, NUM_PIXELS, ZOOM_4X   },
+    { "view_ba_1_8",  CASE_SET_VIEW,    OP_BA_ALG,  0, NUM_PIXELS, ZOOM_1_8X },
+    { "view_nh_1_4",  CASE_SET_VIEW,    OP_NH_ALG,  0, NUM_PIXELS, ZOOM_1_4X },
+    { "filter",       CASE_FILTER,      0,          0, NUM_PIXELS },
+    { "stats",        CASE_STATS,       0,          0, NUM_PIXELS },
+    { "ticket_pr_2x", CASE_TICKET,      OP_PR_ALG,  0, NUM_PIXELS },
+    // Depois dos zoom out: com a pirâmide montada, o BA/NH só copia
+    { "pyramid",      CASE_PYRAMID,     0,          0, NUM_PIXELS },
+    // Por último: reescrevem a mem1 (o RLE com outra imagem)
+    { "upload_rect",  CASE_UPLOAD_RECT, OP_RECT_DATA, 0, NUM_PIXELS },
+    { "upload_rle",   CASE_UPLOAD_RLE,  OP_RECT_DATA, 0, NUM_PIXELS },
+};
+#define NUM_CASES ((int)(sizeof(g_cases) / sizeof(g_cases[0])))
+
+typedef struct {
+    const BenchCase *bench;
+    int    count;
+    double total_us;
+    double min_us, max_us, mean_us;
+    double p50_us, p95_us, p99_us;
+} BenchResult;
+
+// =================================================================
+// Utilidades
+// =================================================================
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+// Percentil pelo método "nearest rank" sobre amostras ordenadas
+static double percentile(const double *sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+// Padrão determinístico (gradiente + grade) para o upload
+static uint8_t pattern_pixel(uint32_t address) {
+    uint32_t x = address % IMG_WIDTH, y = address / IMG_WIDTH;
+    return ((x % 40) == 0 || (y % 40) == 0) ? 255 : (uint8_t)((x + y) & 0xFF);
+}
+
+static void upload_pattern(void) {
+    for (uint32_t address = 0; address < NUM_PIXELS; address++) {
+        coproc_write_pixel(address, pattern_pixel(address));
+        coproc_wait_done();
+    }
+}
+
+// Mesmo padrão, por retângulo (coproc_rect_data envia 3 pixels por STORE)
+static void upload_pattern_rect(void) {
+    static uint8_t pixels[NUM_PIXELS];
+    for (uint32_t address = 0; address < NUM_PIXELS; address++) {
+        pixels[address] = pattern_pixel(address);
+    }
+    coproc_rect_begin(0, 0, IMG_WIDTH, IMG_HEIGHT);
+    coproc_rect_data(pixels, NUM_PIXELS);
+}
+
+// Faixas horizontais de 8 linhas: 30 corridas de 2.560 pixels
+static void upload_runs(void) {
+    coproc_rect_begin(0, 0, IMG_WIDTH, IMG_HEIGHT);
+    for (uint32_t band = 0; band < IMG_HEIGHT / 8; band++) {
+        coproc_rect_run((uint8_t)(band * 8), IMG_WIDTH * 8);
+    }
+}
+
+static void reset_image(void) {
+    coproc_reset_image();
+    coproc_wait_done();
+}
+
+static void zoom_step(const BenchCase *bench, uint32_t x, uint32_t y) {
+    if (bench->kind == CASE_ZOOM_OUT) {
+        coproc_apply_zoom(bench->algorithm);
+    } else {
+        coproc_apply_zoom_with_offset(bench->algorithm, x, y);
+    }
+    coproc_wait_done();
+}
+
+// =================================================================
+// Execução de um caso
+// =================================================================
+static void run_case(const BenchCase *bench, int iterations, double *samples, BenchResult *result) {
+    uint32_t pan_x = 0;
+    volatile uint32_t sink = 0;
+
+    // Preparação única: o pan parte de 2x na origem; o filtro usa um
+    // kernel de média (soma 8, shift 3) carregado uma vez
+    if (bench->kind == CASE_PAN) {
+        reset_image();
+        zoom_step(bench, 0, 0);
+    }
+    if (bench->kind == CASE_FILTER) {
+        static const int8_t box[FILTER_TAPS] = { 1, 1, 1, 1, 0, 1, 1, 1, 1 };
+        coproc_filter_load(box);
+    }
+
+    for (int i = 0; i < iterations; i++) {
+        // Preparação não medida: leva a imagem ao nível anterior ao medido
+        if (bench->kind == CASE_ZOOM_IN || bench->kind == CASE_ZOOM_OUT ||
+            bench->kind == CASE_SET_VIEW || bench->kind == CASE_TICKET) {
+            reset_image();
+            for (int s = 1; s < bench->steps; s++) {
+                zoom_step(bench, 0, 0);
+            }
+        }
+        if (bench->kind == CASE_PAN) {
+            pan_x = (pan_x + MOVE_STEP < IMG_WIDTH / 2) ? pan_x + MOVE_STEP : 0;
+        }
+
+        double t0 = now_us();
+        switch (bench->kind) {
+            case CASE_UPLOAD:
+                upload_pattern();
+                break;
+            case CASE_ZOOM_IN:
+            case CASE_ZOOM_OUT:
+                zoom_step(bench, 0, 0);
+                break;
+            case CASE_PAN:
+                coproc_pan_zoom_with_offset(bench->algorithm, pan_x, 0);
+                coproc_wait_done();
+                break;
+            case CASE_RESET:
+                reset_image();
+                break;
+            case CASE_READBACK:
+                for (uint32_t x = 0; x < IMG_WIDTH; x++) {
+                    sink += coproc_read_pixel((uint32_t)(i % IMG_HEIGHT) * IMG_WIDTH + x, 0);
+                }
+                break;
+            case CASE_SET_VIEW:
+                coproc_set_view(bench->level, 0, 0, bench->algorithm);
+                coproc_wait_done();
+                break;
+            case CASE_FILTER:
+                coproc_filter_run(0, 3);
+                coproc_wait_done();
+                break;
+            case CASE_STATS: {
+                static CoprocStats stats;
+                coproc_stats_start(STATS_SCAN_MEM1);
+                coproc_stats_read(&stats);
+                sink += stats.count;
+                break;
+            }
+            case CASE_TICKET:
+                coproc_wait(coproc_submit(bench->algorithm, COPROC_WAIT_FOREVER), COPROC_WAIT_FOREVER);
+                break;
+            case CASE_PYRAMID:
+                coproc_pyramid_build();
+                break;
+            case CASE_UPLOAD_RECT:
+                upload_pattern_rect();
+                break;
+            case CASE_UPLOAD_RLE:
+                upload_runs();
+                break;
+        }
+        samples[i] = now_us() - t0;
+    }
+    (void)sink;
+
+    result->bench = bench;
+    result->count = iterations;
+    result->total_us = 0;
+    for (int i = 0; i < iterations; i++) {
+        result->total_us += samples[i];
+    }
+    qsort(samples, iterations, sizeof(double), compare_double);
+    result->min_us  = samples[0];
+    result->max_us  = samples[iterations - 1];
+    result->mean_us = result->total_us / iterations;
+    result->p50_us  = percentile(samples, iterations, 50);
+    result->p95_us  = percentile(samples, iterations, 95);
+    result->p99_us  = percentile(samples, iterations, 99);
+}
+
+// =================================================================
+// Saída (JSON ou CSV)
+// =================================================================
+static double ops_per_s(const BenchResult *r) {
+    return (r->mean_us > 0) ? 1e6 / r->mean_us : 0;
+}
+
+static double mpixels_per_s(const BenchResult *r) {
+    return (r->mean_us > 0) ? r->bench->pixels / r->mean_us : 0;
+}
+
+// De onde vêm os tempos: só o backend "fpga" mede o hardware
+static const char *timing_source(void) {
+    return strcmp(COPROC_BACKEND, "modelo") == 0 ? "coproc_model.c (modelo em C no PC, não é latência da FPGA)"
+                                                 : "api_fpga.s (FPGA)";
+}
+
+static void write_json(FILE *out, const BenchResult *results, int count, int iterations) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"backend\": \"%s\",\n", COPROC_BACKEND);
+    fprintf(out, "  \"source\": \"%s\",\n", timing_source());
+    fprintf(out, "  \"iterations\": %d,\n", iterations);
+    fprintf(out, "  \"unit\": \"us\",\n");
+    fprintf(out, "  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"ops\": %d, \"pixels_per_op\": %u, "
+                     "\"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f, "
+                     "\"ops_per_s\": %.2f, \"mpixels_per_s\": %.3f}%s\n",
+                r->bench->name, r->count, r->bench->pixels,
+                r->min_us, r->mean_us, r->p50_us, r->p95_us, r->p99_us, r->max_us,
+                ops_per_s(r), mpixels_per_s(r), (i + 1 < count) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void write_csv(FILE *out, const BenchResult *results, int count) {
+    fprintf(out, "backend,name,ops,pixels_per_op,min_us,mean_us,p50_us,p95_us,p99_us,max_us,ops_per_s,mpixels_per_s,source\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(out, "%s,%s,%d,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.3f,\"%s\"\n",
+                COPROC_BACKEND, r->bench->name, r->count, r->bench->pixels,
+                r->min_us, r->mean_us, r->p50_us, r->p95_us, r->p99_us, r->max_us,
+                ops_per_s(r), mpixels_per_s(r), timing_source());
+    }
+}
+
+static void print_usage(const char *prog) {
+    printf("Uso: %s [-n iteracoes] [-f json|csv] [-o arquivo] [-k caso]\n", prog);
+    printf("  -n : repetições por caso (padrão %d)\n", DEFAULT_ITERATIONS);
+    printf("  -f : formato da saída (padrão json)\n");
+    printf("  -o : arquivo de saída (padrão: stdout)\n");
+    printf("  -k : executa apenas os casos cujo nome começa com o prefixo dado\n");
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = DEFAULT_ITERATIONS;
+    const char *format = "json";
+    const char *output = NULL;
+    const char *filter = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            format = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (iterations < 1 || (strcmp(format, "json") != 0 && strcmp(format, "csv") != 0)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (setup_memory_map() != 0) {
+        printf("Falha ao mapear a memória de hardware.\n");
+        return 1;
+    }
+
+    if (strcmp(COPROC_BACKEND, "modelo") == 0) {
+        fprintf(stderr, "[bench] Backend: modelo em C (coproc_model.c). Os tempos são do PC, não da FPGA.\n");
+    }
+
+    double *samples = malloc(sizeof(double) * iterations);
+    BenchResult results[NUM_CASES];
+    int count = 0;
+
+    // Todos os casos de zoom/pan/reset operam sobre o mesmo padrão
+    reset_image();
+    upload_pattern();
+    reset_image();
+
+    for (int c = 0; c < NUM_CASES; c++) {
+        if (filter && strncmp(g_cases[c].name, filter, strlen(filter)) != 0) {
+            continue;
+        }
+        fprintf(stderr, "[bench] %-12s (%d iteracoes)...\n", g_cases[c].name, iterations);
+        run_case(&g_cases[c], iterations, samples, &results[count++]);
+    }
+
+    reset_image();
+    cleanup_memory_map();
+    free(samples);
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror("Erro ao abrir o arquivo de saída");
+        return 1;
+    }
+    if (strcmp(format, "json") == 0) {
+        write_json(out, results, count, iterations);
+    } else {
+        write_csv(out, results, count);
+    }
+    if (output) {
+        fclose(out);
+        fprintf(stderr, "[bench] Resultados gravados em %s\n", output);
+    }
+    return 0;
+}
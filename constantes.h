@@ -47,6 +47,178 @@
 #define OP_NH_ALG         0x6 // 3'b110 (Zoom Out - Vizinho Mais Próximo)
 #define OP_RESET          0x7 // 3'b111 (RESET_OPCODE)
 
+// =================================================================
+// Instruções Estendidas e Escrita por Retângulo
+// =================================================================
+// OP_EXT: OP_REFRESH_SCREEN com SEL_MEM = 1. MEM_ADDR[16:15] escolhe a
+// sub-operação; os argumentos vão em MEM_ADDR[14:0] e DATA_IN.
+#define SEL_MEM_BIT       (1 << 20)
+#define OP_EXT            (OP_REFRESH_SCREEN | SEL_MEM_BIT)
+#define EXT_SUBOP_SHIFT   15 // Dentro de MEM_ADDR
+#define EXT_RECT_ORIGIN   0x0 // MEM_ADDR[8:0] = x, DATA_IN = y
+#define EXT_RECT_SIZE     0x1 // MEM_ADDR[8:0] = w - 1, DATA_IN = h - 1; abre o retângulo
+#define EXT_RECT_RUN      0x2 // MEM_ADDR[14:0] = n - 1, DATA_IN = valor; n pixels iguais no retângulo
+#define RECT_RUN_MAX      (1 << 15)
+#define EXT_CTRL          0x3 // Comando em MEM_ADDR[14:11] (EXT_CTRL_SHIFT)
+#define EXT_CTRL_SHIFT    11  // Dentro de MEM_ADDR
+
+// Comandos de EXT_CTRL
+#define CTRL_PYRAMID_BUILD 0x0 // Monta a pirâmide de zoom out a partir da mem1
+#define CTRL_ABORT         0x1 // Interrompe o algoritmo em execução (ver coproc_abort)
+#define CTRL_FILTER_COEF   0x2 // Coeficiente do filtro 3x3, ver abaixo
+#define CTRL_FILTER_RUN    0x3 // Aplica o filtro 3x3 e mostra o resultado
+#define CTRL_STATS_START   0x4 // Zera o histograma e começa a contar, ver abaixo
+#define CTRL_STATS_READ    0x5 // Lê um contador do histograma para o pio_dataout
+#define CTRL_LUT           0x6 // Entrada da LUT de exibição, ou liga/desliga a LUT
+#define CTRL_CONFIG        0x7 // Escreve um registrador de configuração, ver abaixo
+#define CTRL_SET_ZOOM      0x8 // | nível (ZOOM_*): vai direto ao nível, ver abaixo
+
+// CTRL_ABORT: aceito também com a FSM ocupada. Se interrompe um algoritmo,
+// conta como instrução junto com ele (STATUS_SEQ + 2); senão não conta.
+#define ABORT_INSTRUCTION \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_ABORT << (EXT_CTRL_SHIFT + 3)))
+
+// CTRL_SET_ZOOM: MEM_ADDR[13:11] = nível, MEM_ADDR[10:9] = algoritmo -
+// OP_NHI_ALG, MEM_ADDR[8:0] = x, DATA_IN = y (offsets do zoom in).
+// Nível acima de 1x exige OP_PR_ALG/OP_NHI_ALG, abaixo exige
+// OP_BA_ALG/OP_NH_ALG; 1x aceita qualquer um (cópia da mem1).
+#define SET_ZOOM_ALG_SHIFT 9 // Dentro de MEM_ADDR
+#define SET_ZOOM_INSTRUCTION(level, alg, x, y) \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | \
+     ((CTRL_SET_ZOOM | (level)) << (EXT_CTRL_SHIFT + 3)) | \
+     (((alg) - OP_NHI_ALG) << (SET_ZOOM_ALG_SHIFT + 3)) | ((x) << 3) | ((y) << 21))
+
+// CTRL_FILTER_COEF: MEM_ADDR[10:7] = índice 0..8 (ordem de varredura da
+// janela, 4 = centro), DATA_IN = coeficiente com sinal. Índice > 8 acende
+// o FLAG_ERROR. Só atualiza o registrador (DONE continua em 1).
+// CTRL_FILTER_RUN: soma da janela deslocada de MEM_ADDR[3:0] à direita
+// (aritmético), |soma| se FILTER_ABS, saturada em 0..255. Lê a mem1 ou,
+// com FILTER_FROM_MEM3, a imagem da mem3; escreve a mem3 e a copia para a
+// tela. O nível de zoom não muda. Bordas repetem a linha/coluna da borda.
+#define FILTER_INDEX_SHIFT 7          // Dentro de MEM_ADDR
+#define FILTER_FROM_MEM3   (1 << 10)  // Dentro de MEM_ADDR
+#define FILTER_ABS         (1 << 4)   // Dentro de MEM_ADDR
+#define FILTER_SHIFT_MASK  0xF
+#define FILTER_TAPS        9
+#define FILTER_COEF_INSTRUCTION(index, coef) \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_FILTER_COEF << (EXT_CTRL_SHIFT + 3)) | \
+     ((index) << (FILTER_INDEX_SHIFT + 3)) | (((coef) & 0xFF) << 21))
+#define FILTER_RUN_INSTRUCTION(flags, shift) \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_FILTER_RUN << (EXT_CTRL_SHIFT + 3)) | \
+     (((flags) | ((shift) & FILTER_SHIFT_MASK)) << 3))
+
+// CTRL_STATS_START: MEM_ADDR[10:9] = modo. Zera os STATS_BINS contadores
+// (256 ciclos) e o mínimo/máximo/soma; STATS_STREAM passa a contar cada
+// pixel escrito na mem1 (OP_STORE e retângulo) até o próximo
+// CTRL_STATS_START, e STATS_SCAN_MEM1/MEM3 varrem o buffer uma vez
+// (LANES pixels por ciclo). Espera-se o FLAG_DONE. No modo stream uma
+// reescrita conta de novo: zera-se antes de cada envio.
+// CTRL_STATS_READ: MEM_ADDR[10:9] = registrador (STATS_REG_*), MEM_ADDR[8:7]
+// = byte do registrador, DATA_IN = valor do pixel (STATS_REG_BIN). O byte
+// fica no pio_dataout (8 bits): um registrador de STATS_REG_BYTES bytes
+// custa STATS_REG_BYTES instruções.
+#define STATS_MODE_SHIFT   9 // Dentro de MEM_ADDR
+#define STATS_BYTE_SHIFT   7 // Dentro de MEM_ADDR
+#define STATS_CLEAR        0x0
+#define STATS_STREAM       0x1
+#define STATS_SCAN_MEM1    0x2
+#define STATS_SCAN_MEM3    0x3
+#define STATS_REG_BIN      0x0 // [16:0] pixels com o valor DATA_IN
+#define STATS_REG_COUNT    0x1 // [16:0] pixels contados
+#define STATS_REG_SUM      0x2 // [24:0] soma dos pixels contados
+#define STATS_REG_MINMAX   0x3 // [7:0] mínimo, [15:8] máximo (255 e 0 sem pixels)
+#define STATS_REG_BYTES(reg) \
+    ((reg) == STATS_REG_SUM ? 4 : (reg) == STATS_REG_MINMAX ? 2 : 3)
+#define STATS_BINS         256
+#define STATS_START_INSTRUCTION(mode) \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_STATS_START << (EXT_CTRL_SHIFT + 3)) | \
+     ((mode) << (STATS_MODE_SHIFT + 3)))
+#define STATS_READ_INSTRUCTION(reg, bin, byte) \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_STATS_READ << (EXT_CTRL_SHIFT + 3)) | \
+     ((reg) << (STATS_MODE_SHIFT + 3)) | ((byte) << (STATS_BYTE_SHIFT + 3)) | ((bin) << 21))
+
+// CTRL_LUT: DATA_IN na entrada MEM_ADDR[7:0] das tabelas dos canais em
+// MEM_ADDR[10:8] (LUT_*), sem esperar a FSM. Sem canal, MEM_ADDR[0] liga
+// (1) ou desliga (0) a LUT entre a memória de exibição e o VGA; desligada
+// (power-up), o cinza vai igual aos três canais.
+#define LUT_CHANNEL_SHIFT  8 // Dentro de MEM_ADDR
+#define LUT_RED            0x4
+#define LUT_GREEN          0x2
+#define LUT_BLUE           0x1
+#define LUT_GRAY           (LUT_RED | LUT_GREEN | LUT_BLUE)
+#define LUT_ENTRIES        256
+#define LUT_WRITE_INSTRUCTION(channels, index, value) \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_LUT << (EXT_CTRL_SHIFT + 3)) | \
+     ((channels) << (LUT_CHANNEL_SHIFT + 3)) | ((index) << 3) | (((value) & 0xFF) << 21))
+#define LUT_ENABLE_INSTRUCTION(on) \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_LUT << (EXT_CTRL_SHIFT + 3)) | ((on) << 3))
+
+// CTRL_CONFIG: registrador MEM_ADDR[10:8] (CONFIG_*) = MEM_ADDR[7:0], sem
+// esperar a FSM. Registrador ou valor desconhecido acende o FLAG_ERROR.
+// CONFIG_PIXEL_FORMAT: PIXEL_GRAY8 (power-up) ou PIXEL_RGB332 (RRRGGGBB).
+// Em RGB332 o BA tira a média de cada canal e o VGA expande os canais;
+// PR/NHI/NH copiam bytes nos dois formatos. Filtro e histograma tratam o
+// byte como cinza. Mudar o formato descarta a pirâmide.
+#define CONFIG_REG_SHIFT    8 // Dentro de MEM_ADDR
+#define CONFIG_PIXEL_FORMAT 0x0
+#define PIXEL_GRAY8         0x0
+#define PIXEL_RGB332        0x1
+// CONFIG_ORIENTATION: como o VGA lê a memory2, {troca x/y, espelha x,
+// espelha y}. Com a troca (90/270 graus) a caixa fica em pé, 240x320.
+// É só na saída de vídeo: memórias, zoom e leituras do HPS não mudam.
+#define CONFIG_ORIENTATION  0x1
+#define ORIENT_FLIP_Y       0x1
+#define ORIENT_FLIP_X       0x2
+#define ORIENT_SWAP_XY      0x4
+#define ORIENT_NONE         0x0
+#define ORIENT_MIRROR_V     ORIENT_FLIP_Y
+#define ORIENT_MIRROR_H     ORIENT_FLIP_X
+#define ORIENT_ROT180       (ORIENT_FLIP_X | ORIENT_FLIP_Y)
+#define ORIENT_ROT90        (ORIENT_SWAP_XY | ORIENT_FLIP_Y) // Horário
+#define ORIENT_ROT270       (ORIENT_SWAP_XY | ORIENT_FLIP_X)
+// CONFIG_SCANOUT: caixa de 320x240 no centro da tela (power-up) ou a tela
+// toda (640x480, cada pixel lê (x/2, y/2)), com ou sem filtro bilinear.
+// Com troca de x/y (ORIENT_ROT90/270) a imagem continua na caixa.
+#define CONFIG_SCANOUT      0x2
+#define SCANOUT_BOX         0x0
+#define SCANOUT_2X          0x1
+#define SCANOUT_2X_BILINEAR 0x2
+// Retângulo sobreposto na saída de vídeo, nas coordenadas da imagem: a
+// borda de 1 pixel sai com as cores invertidas. CONFIG_OVERLAY liga (1) ou
+// desliga (0). Posição e tamanho ocupam dois registradores cada, com o bit
+// 8 de x (ou de w - 1) no bit baixo do registrador (MEM_ADDR[8]) e y (ou
+// h - 1) em DATA_IN: uma instrução por posição. x > 319 ou y > 239 acende
+// o FLAG_ERROR; o retângulo pode passar da borda da imagem.
+#define CONFIG_OVERLAY      0x3
+#define CONFIG_OVERLAY_POS  0x4 // e 0x5
+#define CONFIG_OVERLAY_SIZE 0x6 // e 0x7
+#define OVERLAY_ENABLE_INSTRUCTION(on) CONFIG_INSTRUCTION(CONFIG_OVERLAY, (on) & 1)
+#define OVERLAY_POS_INSTRUCTION(x, y) \
+    (CONFIG_INSTRUCTION(CONFIG_OVERLAY_POS, 0) | (((x) & 0x1FF) << 3) | (((y) & 0xFF) << 21))
+#define OVERLAY_SIZE_INSTRUCTION(w, h) \
+    (CONFIG_INSTRUCTION(CONFIG_OVERLAY_SIZE, 0) | ((((w) - 1) & 0x1FF) << 3) | ((((h) - 1) & 0xFF) << 21))
+#define CONFIG_INSTRUCTION(reg, value) \
+    (OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_CONFIG << (EXT_CTRL_SHIFT + 3)) | \
+     ((reg) << (CONFIG_REG_SHIFT + 3)) | (((value) & 0xFF) << 3))
+
+// OP_RECT_DATA: OP_STORE com SEL_MEM = 1. Três pixels na posição
+// corrente do retângulo aberto, em ordem de varredura:
+// DATA_IN = pixel 0, MEM_ADDR[7:0] = pixel 1, MEM_ADDR[15:8] = pixel 2.
+// Os pixels que passam do fim do retângulo são ignorados.
+#define OP_RECT_DATA      (OP_STORE | SEL_MEM_BIT)
+#define RECT_PIXELS_PER_BEAT 3
+
+// =================================================================
+// Níveis de Zoom (registradores current_zoom/next_zoom do main.v)
+// =================================================================
+#define ZOOM_1_8X 0x1 // 3'b001
+#define ZOOM_1_4X 0x2 // 3'b010
+#define ZOOM_1_2X 0x3 // 3'b011
+#define ZOOM_1X   0x4 // 3'b100 (após RESET)
+#define ZOOM_2X   0x5 // 3'b101
+#define ZOOM_4X   0x6 // 3'b110
+#define ZOOM_8X   0x7 // 3'b111
+
 // =================================================================
 // Máscaras de Bits dos Flags da FPGA (Lidos do pio_flags)
 // =================================================================
@@ -55,4 +227,20 @@
 #define FLAG_ZMAX_MASK    0x4 // Bit 2: Zoom máximo atingido
 #define FLAG_ZMIN_MASK    0x8 // Bit 3: Zoom mínimo atingido
 
+// =================================================================
+// Palavra de Status (pio_flags[31:4], lida por coproc_get_status)
+// =================================================================
+// Campos estáveis só com FLAG_DONE = 1. Extração: (status >> SHIFT) & MASK
+#define STATUS_ZOOM_SHIFT    4  // [6:4]   current_zoom (ZOOM_*)
+#define STATUS_ZOOM_MASK     0x7
+#define STATUS_STATE_SHIFT   7  // [10:7]  uc_state da FSM (0 = IDLE)
+#define STATUS_STATE_MASK    0xF
+#define STATUS_X_SHIFT       11 // [19:11] offset X do último zoom/pan
+#define STATUS_X_MASK        0x1FF
+#define STATUS_Y_SHIFT       20 // [27:20] offset Y do último zoom/pan
+#define STATUS_Y_MASK        0xFF
+#define STATUS_SEQ_SHIFT     28 // [31:28] nº de instruções concluídas (módulo 16; Gray no pio_flags)
+#define STATUS_SEQ_MASK      0xF
+#define STATUS_FIELD(status, field) (((status) >> STATUS_##field##_SHIFT) & STATUS_##field##_MASK)
+
 #endif // FPGA_CONSTANTS_H
\ No newline at end of file
@@ -0,0 +1,140 @@
+/*
+ * =================================================================
+ * coproc_async.c
+ * =================================================================
+ * Implementação dos tickets descritos em coproc_async.h.
+ *
+ * Os tickets são um contador de 32 bits do HPS; o hardware só conta 4
+ * bits. Antes de enviar, coproc_submit espera a FPGA parar (settled_seq),
+ * então o próximo valor do contador (STATUS_SEQ + 1) identifica a
+ * instrução enviada sem ambiguidade, e só ele precisa ser guardado para
+ * o ticket em aberto.
+ */
+
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+
+#include <time.h>
+
+#include "api_fpga.h"
+#include "constantes.h"
+#include "coproc_async.h"
+#include "coproc_trace.h" // Rastreador opcional (make TRACE=1)
+
+// No HPS o clock_gettime é uma chamada de sistema: o prazo só é conferido
+// a cada POLLS_PER_CLOCK leituras do pio_flags
+#define POLLS_PER_CLOCK 256
+
+static CoprocTicket g_last_ticket;
+static uint32_t     g_last_seq;  // STATUS_SEQ esperado quando g_last_ticket terminar
+static int          g_in_flight; // g_last_ticket ainda não foi visto concluído
+static int          g_abort_sent; // ABORT já enviado para g_last_ticket
+static int          g_aborted;    // g_last_ticket terminou interrompida
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+// Instante limite para timeout_us (0: sem prazo)
+static uint64_t deadline_after(uint32_t timeout_us) {
+    return timeout_us == COPROC_WAIT_FOREVER ? 0 : now_us() + timeout_us;
+}
+
+static int deadline_passed(uint64_t deadline, uint32_t *polls) {
+    return deadline != 0 && ++*polls % POLLS_PER_CLOCK == 0 && now_us() >= deadline;
+}
+
+// STATUS_SEQ com a FSM parada. Uma instrução enviada sem ticket
+// (coproc_set_view, coproc_filter_run, coproc_apply_zoom*,
+// coproc_pan_zoom_with_offset) pode ainda estar em execução, e a FSM
+// volta a IDLE (FLAG_DONE) alguns ciclos antes de mostrar a instrução no
+// STATUS_SEQ: só vale uma leitura com FLAG_DONE e o mesmo STATUS_SEQ da
+// leitura anterior.
+// -1 se passar do prazo.
+static int settled_seq(uint64_t deadline, uint32_t *seq) {
+    uint32_t polls = 0;
+    uint32_t status = coproc_get_status();
+    for (;;) {
+        uint32_t again = coproc_get_status();
+        if ((status & again & FLAG_DONE_MASK) && STATUS_FIELD(status, SEQ) == STATUS_FIELD(again, SEQ)) {
+            *seq = STATUS_FIELD(again, SEQ);
+            return 0;
+        }
+        if (deadline_passed(deadline, &polls)) {
+            return -1;
+        }
+        status = again;
+    }
+}
+
+int coproc_poll(CoprocTicket ticket) {
+    if (!g_in_flight || ticket != g_last_ticket) {
+        return 1;
+    }
+    // Com ABORT enviado, a sequência pula um a mais se ela foi interrompida
+    uint32_t status = coproc_get_status();
+    uint32_t seq = STATUS_FIELD(status, SEQ);
+    if ((status & FLAG_DONE_MASK) &&
+        (seq == g_last_seq || (g_abort_sent && seq == ((g_last_seq + 1) & STATUS_SEQ_MASK)))) {
+        g_in_flight = 0;
+        g_aborted = (seq != g_last_seq);
+        TRACE_TICKET_END();
+        return 1;
+    }
+    return 0;
+}
+
+static int wait_until(CoprocTicket ticket, uint64_t deadline) {
+    uint32_t polls = 0;
+    while (!coproc_poll(ticket)) {
+        if (deadline_passed(deadline, &polls)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int coproc_wait(CoprocTicket ticket, uint32_t timeout_us) {
+    if (coproc_poll(ticket)) {
+        return 0;
+    }
+    return wait_until(ticket, deadline_after(timeout_us));
+}
+
+int coproc_abort(CoprocTicket ticket, uint32_t timeout_us) {
+    if (coproc_poll(ticket)) {
+        return ticket == g_last_ticket && g_aborted;
+    }
+    if (!g_abort_sent) {
+        coproc_issue(ABORT_INSTRUCTION);
+        g_abort_sent = 1;
+    }
+    if (coproc_wait(ticket, timeout_us) != 0) {
+        // Ticket abandonado: o próximo coproc_submit não espera mais por
+        // ele, só pela FPGA parada (settled_seq, com o prazo de quem chama)
+        g_in_flight = 0;
+        TRACE_TICKET_END();
+        return -1;
+    }
+    return g_aborted;
+}
+
+CoprocTicket coproc_submit(uint32_t instruction, uint32_t timeout_us) {
+    uint64_t deadline = deadline_after(timeout_us);
+    uint32_t seq;
+
+    if (wait_until(g_last_ticket, deadline) != 0 || settled_seq(deadline, &seq) != 0) {
+        return COPROC_TICKET_ERROR;
+    }
+    g_last_seq = (seq + 1) & STATUS_SEQ_MASK;
+    if (++g_last_ticket == COPROC_TICKET_ERROR) {
+        g_last_ticket++;
+    }
+    g_in_flight = 1;
+    g_abort_sent = 0;
+    g_aborted = 0;
+    TRACE_TICKET_BEGIN(instruction);
+    coproc_issue(instruction);
+    return g_last_ticket;
+}
@@ -0,0 +1,58 @@
+#ifndef COPROC_ASYNC_H
+#define COPROC_ASYNC_H
+
+/*
+ * =================================================================
+ * Envio assíncrono com tickets de conclusão
+ * =================================================================
+ * coproc_submit envia uma palavra de instrução e volta na hora com um
+ * ticket; coproc_poll diz se ela já terminou e coproc_wait espera (com
+ * prazo). Enquanto a FPGA calcula, quem chamou segue livre (ler o
+ * teclado, conferir a operação anterior, ler o próximo arquivo).
+ *
+ * A conclusão vem do contador de instruções concluídas da palavra de
+ * status (STATUS_SEQ, 4 bits), não do FLAG_DONE: logo depois do enable
+ * o FLAG_DONE ainda mostra a instrução anterior. A FSM só aceita uma
+ * instrução em IDLE, então há no máximo um ticket em aberto:
+ * coproc_submit espera o anterior terminar antes de enviar. Tickets
+ * mais antigos que o último já estão concluídos.
+ *
+ * Quem usa as funções síncronas da api_fpga.h no meio (ex.:
+ * coproc_read_block) deve antes esperar o ticket em aberto.
+ *
+ * As funções da api_fpga.h que enviam sem esperar (coproc_set_view,
+ * coproc_filter_run, coproc_apply_zoom*, coproc_pan_zoom_with_offset)
+ * não geram ticket. Com um ticket em aberto elas não podem ser
+ * chamadas: a FSM fora de IDLE descarta a instrução. Depois delas,
+ * coproc_submit espera a FPGA parar antes de enviar, mas a conclusão
+ * delas só é vista pelo coproc_wait_done de quem as chamou.
+ */
+
+#include <stdint.h>
+
+typedef uint32_t CoprocTicket;
+
+#define COPROC_WAIT_FOREVER 0xFFFFFFFFu
+#define COPROC_TICKET_ERROR 0u // Nenhum ticket válido tem este valor
+
+// Espera o ticket anterior e a FPGA parada por até timeout_us (mesmo prazo
+// do coproc_wait) e envia. Se passar do prazo, nada é enviado e o retorno
+// é COPROC_TICKET_ERROR.
+CoprocTicket coproc_submit(uint32_t instruction, uint32_t timeout_us);
+
+// 1 se a instrução do ticket já terminou, 0 se ainda está em execução
+int coproc_poll(CoprocTicket ticket);
+
+// 0 quando termina, -1 se passar de timeout_us (COPROC_WAIT_FOREVER: sem prazo)
+int coproc_wait(CoprocTicket ticket, uint32_t timeout_us);
+
+// Interrompe a instrução do ticket se ela ainda estiver no algoritmo
+// (ABORT_INSTRUCTION) e espera a FSM voltar a IDLE, com prazo como o
+// coproc_wait. Retorna 1 se ela foi interrompida (a tela continua com o
+// resultado anterior), 0 se já tinha terminado ou estava na cópia para a
+// tela, que não é interrompida, e -1 se passar de timeout_us. No -1 o
+// ticket é abandonado (coproc_poll passa a dizer 1): o próximo
+// coproc_submit só espera a FPGA parar, com o prazo dele.
+int coproc_abort(CoprocTicket ticket, uint32_t timeout_us);
+
+#endif // COPROC_ASYNC_H
@@ -0,0 +1,836 @@
+/*
+ * =================================================================
+ * coproc_model.c
+ * =================================================================
+ * Modelo em software do coprocessador de imagem (Coprocessador/main.v).
+ *
+ * Implementa os mesmos símbolos exportados por api_fpga.s, de modo que
+ * o menu.c (e as demais ferramentas) possam ser compilados e executados
+ * num PC x86, sem placa e sem /dev/mem. Cada função monta a palavra de
+ * instrução exatamente como o Assembly faz e a decodifica como o
+ * ghrd_top.v (opcode [2:0], endereço [19:3], SEL_MEM [20], dado [28:21]).
+ *
+ * Os algoritmos são executados de forma síncrona (coproc_wait_done
+ * retorna imediatamente) e reproduzem passo a passo as atualizações de
+ * registradores da FSM do main.v (old_x/old_y/new_x/new_y de 10 bits,
+ * endereços de 17 bits), para que a saída seja a mesma do hardware.
+ * Endereços fora do quadro de 320x240 são ignorados na escrita e lidos
+ * como zero.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "constantes.h"
+#include "api_fpga.h"
+
+#define MODEL_IMG_WIDTH   320
+#define MODEL_IMG_HEIGHT  240
+#define MODEL_NUM_PIXELS  76800
+#define MODEL_ADDR_MASK   0x1FFFF // Endereços de 17 bits
+#define MODEL_COORD_MASK  0x3FF   // old_x/old_y/new_x/new_y de 10 bits
+
+// =================================================================
+// Estado do "hardware"
+// =================================================================
+static uint8_t mem1[MODEL_NUM_PIXELS]; // Imagem original
+static uint8_t mem2[MODEL_NUM_PIXELS]; // Memória de exibição
+static uint8_t mem3[MODEL_NUM_PIXELS]; // Memória de trabalho
+
+static uint32_t current_zoom;
+static uint32_t next_zoom;
+static uint32_t zoom_x_offset; // 17 bits (MEM_ADDR)
+static uint32_t zoom_y_offset; // 8 bits (DATA_IN)
+static uint32_t addr_for_read; // Mantém o valor entre operações, como o registrador
+static uint32_t data_out;      // pio_dataout (8 bits)
+static int      flag_error;
+static uint32_t op_seq;        // Instruções concluídas (4 bits na palavra de status)
+
+// Escrita por retângulo (EXT_RECT_ORIGIN/EXT_RECT_SIZE + OP_RECT_DATA ou EXT_RECT_RUN)
+static struct {
+    uint32_t x, y, w_m1, h_m1;
+    uint32_t col, row, addr;
+    int      active;
+} rect;
+
+// Pirâmide de zoom out (pyramid_2/_4/_8 do main.v): janela do BA seguida
+// da janela do NH, para os níveis 1/2, 1/4 e 1/8
+#define PYR_LEVELS 3
+static const struct {
+    uint32_t level;   // next_zoom
+    uint32_t d;       // Distância entre as amostras do BA (bloco de 2d x 2d)
+    uint32_t nh_base; // Início da janela do NH
+} pyr_levels[PYR_LEVELS] = {
+    { ZOOM_1_2X, 1, 19200 },
+    { ZOOM_1_4X, 2, 4800  },
+    { ZOOM_1_8X, 4, 1200  },
+};
+static uint8_t pyramid_2[2 * 19200], pyramid_4[2 * 4800], pyramid_8[2 * 1200];
+static uint8_t *const pyramid[PYR_LEVELS] = { pyramid_2, pyramid_4, pyramid_8 };
+static int pyr_valid;
+
+// Filtro 3x3 (filt_k/filt_* do main.v)
+static int8_t filter_kernel[FILTER_TAPS];
+
+// Histograma e estatísticas (hist_*/stats_* do main.v; as faixas já somadas)
+static struct {
+    uint32_t bins[STATS_BINS]; // 17 bits
+    uint32_t count;            // 17 bits
+    uint32_t sum;              // 25 bits
+    uint8_t  min, max;
+    int      stream;
+} stats;
+
+// LUT de exibição (lut_channels/lut_on do main.v). A mem2 não é legível
+// pelo HPS, então as tabelas só são guardadas.
+static uint8_t lut[3][LUT_ENTRIES]; // R, G, B
+static int     lut_on;
+
+static int pixel_rgb332; // CTRL_CONFIG/CONFIG_PIXEL_FORMAT (pixel_rgb332 do main.v)
+static uint32_t vga_orientation; // CTRL_CONFIG/CONFIG_ORIENTATION: só o VGA usa
+static uint32_t vga_scanout;     // CTRL_CONFIG/CONFIG_SCANOUT: idem
+static struct {                  // CTRL_CONFIG/CONFIG_OVERLAY*: idem
+    uint32_t on, x, y, w_m1, h_m1;
+} vga_overlay;
+
+// =================================================================
+// Acesso às memórias
+// =================================================================
+static inline uint32_t addr_of(uint32_t x, uint32_t y) {
+    return (x + y * MODEL_IMG_WIDTH) & MODEL_ADDR_MASK;
+}
+
+static inline uint8_t mem_read(const uint8_t *mem, uint32_t address) {
+    return (address < MODEL_NUM_PIXELS) ? mem[address] : 0;
+}
+
+static inline void mem_write(uint8_t *mem, uint32_t address, uint8_t value) {
+    if (address < MODEL_NUM_PIXELS) {
+        mem[address] = value;
+    }
+}
+
+// Avança new_x/new_y para o próximo pixel de saída (varredura linear)
+static inline void next_output_pixel(uint32_t *new_x, uint32_t *new_y) {
+    if (*new_x >= 319) {
+        *new_x = 0;
+        *new_y = (*new_y + 1) & MODEL_COORD_MASK;
+    } else {
+        *new_x = (*new_x + 1) & MODEL_COORD_MASK;
+    }
+}
+
+// Janela central preenchida pelos algoritmos de zoom out; fora dela, preto
+static int outside_zoom_out_window(uint32_t x, uint32_t y, uint32_t level) {
+    switch (level) {
+        case ZOOM_1_2X: return (x < 80  || x > 239 || y < 60  || y > 179);
+        case ZOOM_1_4X: return (x < 120 || x > 199 || y < 90  || y > 149);
+        case ZOOM_1_8X: return (x < 140 || x > 179 || y < 105 || y > 134);
+        default:        return 0;
+    }
+}
+
+// Deslocamento usado por PR_ALG/NHI_ALG para mapear destino -> origem
+static uint32_t zoom_in_shift(uint32_t level) {
+    switch (level) {
+        case ZOOM_2X: return 1;
+        case ZOOM_4X: return 2;
+        case ZOOM_8X: return 3;
+        default:      return 0; // Sem ramo correspondente no main.v
+    }
+}
+
+// =================================================================
+// Algoritmos (ramos do estado ALGORITHM do main.v)
+// =================================================================
+
+// PR_ALG: lê 1 pixel e escreve um bloco 2x2 em mem3
+static void run_pr_alg(void) {
+    uint32_t shift = zoom_in_shift(next_zoom);
+    uint32_t new_x = 0, new_y = 0;
+    uint32_t old_x = zoom_x_offset & MODEL_COORD_MASK;
+    uint32_t old_y = zoom_y_offset;
+    uint32_t step;
+
+    for (step = 0; step < 19199; ) {
+        addr_for_read = addr_of(old_x, old_y);
+        uint8_t pixel = mem_read(mem1, addr_for_read);
+
+        mem_write(mem3, addr_of(new_x, new_y), pixel);
+        new_x = (new_x + 1) & MODEL_COORD_MASK;
+        mem_write(mem3, addr_of(new_x, new_y), pixel);
+        new_x = (new_x - 1) & MODEL_COORD_MASK;
+        new_y = (new_y + 1) & MODEL_COORD_MASK;
+        mem_write(mem3, addr_of(new_x, new_y), pixel);
+        new_x = (new_x + 1) & MODEL_COORD_MASK;
+        mem_write(mem3, addr_of(new_x, new_y), pixel);
+
+        if (new_x >= 319) {
+            if (shift) {
+                old_x = zoom_x_offset & MODEL_COORD_MASK;
+                old_y = ((new_y >> shift) + zoom_y_offset) & MODEL_COORD_MASK;
+            } else {
+                old_x = new_x;
+                old_y = new_y;
+            }
+            new_x = 0;
+            new_y = (new_y + 1) & MODEL_COORD_MASK;
+        } else {
+            if (shift) {
+                old_x = ((new_x >> shift) + zoom_x_offset) & MODEL_COORD_MASK;
+            } else {
+                old_x = new_x;
+            }
+            new_x = (new_x + 1) & MODEL_COORD_MASK;
+            new_y = (new_y - 1) & MODEL_COORD_MASK;
+            step++;
+        }
+    }
+}
+
+// NHI_ALG: um pixel de origem por pixel de destino
+static void run_nhi_alg(void) {
+    uint32_t shift = zoom_in_shift(next_zoom);
+    uint32_t new_x = 0, new_y = 0;
+    uint32_t old_x = zoom_x_offset & MODEL_COORD_MASK;
+    uint32_t old_y = zoom_y_offset;
+    uint32_t step;
+
+    for (step = 0; step < 76799; step++) {
+        addr_for_read = addr_of(old_x, old_y);
+        mem_write(mem3, addr_of(new_x, new_y), mem_read(mem1, addr_for_read));
+
+        if (new_x >= 319) {
+            if (shift) {
+                old_x = zoom_x_offset & MODEL_COORD_MASK;
+                old_y = ((new_y >> shift) + zoom_y_offset) & MODEL_COORD_MASK;
+            } else {
+                old_x = new_x;
+                old_y = new_y;
+            }
+        } else {
+            if (shift) {
+                old_x = ((new_x >> shift) + zoom_x_offset) & MODEL_COORD_MASK;
+            } else {
+                old_x = new_x;
+            }
+        }
+        next_output_pixel(&new_x, &new_y);
+    }
+}
+
+// Média do BA entre os dois primeiros pixels do bloco (ba_pixel do
+// main.v). Em cinza, data_to_avg >> 2 truncado em 8 bits só depende deles:
+// {p1[1:0], p0[7:2]}. Em RGB332, a média truncada de cada canal.
+static uint8_t ba_pixel(uint8_t p0, uint8_t p1) {
+    if (!pixel_rgb332) {
+        return (uint8_t)((p1 << 6) | (p0 >> 2));
+    }
+    uint32_t r = ((p0 >> 5) + (p1 >> 5)) >> 1;
+    uint32_t g = (((p0 >> 2) & 7) + ((p1 >> 2) & 7)) >> 1;
+    uint32_t b = ((p0 & 3) + (p1 & 3)) >> 1;
+    return (uint8_t)((r << 5) | (g << 2) | b);
+}
+
+// BA_ALG: 4 leituras por pixel dentro da janela central
+static void run_ba_alg(void) {
+    uint32_t d = (next_zoom == ZOOM_1_2X) ? 1 : (next_zoom == ZOOM_1_4X) ? 2 : (next_zoom == ZOOM_1_8X) ? 4 : 0;
+    uint32_t wrap = (next_zoom == ZOOM_1_2X) ? 319 : (next_zoom == ZOOM_1_4X) ? 318 : 316;
+    uint32_t new_x = 0, new_y = 0, old_x = 0, old_y = 0;
+    uint32_t step;
+
+    for (step = 0; step < 76799; step++) {
+        if (outside_zoom_out_window(new_x, new_y, next_zoom)) {
+            mem_write(mem3, addr_of(new_x, new_y), 0);
+            next_output_pixel(&new_x, &new_y);
+            continue;
+        }
+
+        uint8_t p[4];
+        addr_for_read = addr_of(old_x, old_y);
+        p[0] = mem_read(mem1, addr_for_read);
+        old_x = (old_x + d) & MODEL_COORD_MASK;
+        addr_for_read = addr_of(old_x, old_y);
+        p[1] = mem_read(mem1, addr_for_read);
+        old_x = (old_x - d) & MODEL_COORD_MASK;
+        old_y = (old_y + d) & MODEL_COORD_MASK;
+        addr_for_read = addr_of(old_x, old_y);
+        p[2] = mem_read(mem1, addr_for_read);
+        old_x = (old_x + d) & MODEL_COORD_MASK;
+        addr_for_read = addr_of(old_x, old_y);
+        p[3] = mem_read(mem1, addr_for_read);
+        if (d && old_x >= wrap) {
+            old_x = 0;
+            old_y = (old_y + d) & MODEL_COORD_MASK;
+        } else {
+            old_y = (old_y - d) & MODEL_COORD_MASK;
+            old_x = (old_x + d) & MODEL_COORD_MASK;
+        }
+
+        // p[2] e p[3] são lidos mas não entram na média
+        mem_write(mem3, addr_of(new_x, new_y), ba_pixel(p[0], p[1]));
+        next_output_pixel(&new_x, &new_y);
+    }
+}
+
+// NH_ALG: decimação, 1 leitura por pixel dentro da janela central
+static void run_nh_alg(void) {
+    uint32_t shift = (next_zoom == ZOOM_1_2X) ? 1 : (next_zoom == ZOOM_1_4X) ? 2 : (next_zoom == ZOOM_1_8X) ? 3 : 0;
+    uint32_t last_x = (MODEL_IMG_WIDTH >> shift) - 1;
+    uint32_t new_x = 0, new_y = 0, old_x = 0, old_y = 0;
+    uint32_t step;
+
+    for (step = 0; step < 76799; step++) {
+        if (outside_zoom_out_window(new_x, new_y, next_zoom)) {
+            mem_write(mem3, addr_of(new_x, new_y), 0);
+            next_output_pixel(&new_x, &new_y);
+            continue;
+        }
+
+        if (shift) {
+            addr_for_read = ((old_x << shift) + (old_y << shift) * MODEL_IMG_WIDTH) & MODEL_ADDR_MASK;
+            if (old_x >= last_x) {
+                old_x = 0;
+                old_y = (old_y + 1) & MODEL_COORD_MASK;
+            } else {
+                old_x = (old_x + 1) & MODEL_COORD_MASK;
+            }
+        } else {
+            old_x = new_x;
+            old_y = new_y;
+        }
+
+        mem_write(mem3, addr_of(new_x, new_y), mem_read(mem1, addr_for_read));
+        next_output_pixel(&new_x, &new_y);
+    }
+}
+
+// COPY_READ/COPY_WRITE: copia a origem para a memória de exibição
+static void copy_to_display(const uint8_t *source) {
+    memcpy(mem2, source, sizeof(mem2));
+    current_zoom = next_zoom;
+}
+
+// Estado PYR_BUILD: uma passada pela mem1 em ordem de varredura. O BA
+// só depende dos dois primeiros pixels do bloco (ba_pixel).
+static void pyramid_build(void) {
+    uint32_t ba_ptr[PYR_LEVELS] = { 0 }, nh_ptr[PYR_LEVELS] = { 0 };
+    uint8_t p0[PYR_LEVELS] = { 0 };
+
+    for (uint32_t y = 0; y < 240; y++) {
+        for (uint32_t x = 0; x < MODEL_IMG_WIDTH; x++) {
+            uint8_t pixel = mem1[addr_of(x, y)];
+            for (int k = 0; k < PYR_LEVELS; k++) {
+                uint32_t block = 2 * pyr_levels[k].d;
+                if (y % block != 0) {
+                    continue;
+                }
+                if (x % block == 0) {
+                    p0[k] = pixel;
+                    pyramid[k][pyr_levels[k].nh_base + nh_ptr[k]++] = pixel;
+                } else if (x % block == pyr_levels[k].d) {
+                    pyramid[k][ba_ptr[k]++] = ba_pixel(p0[k], pixel);
+                }
+            }
+        }
+    }
+    pyr_valid = 1;
+}
+
+// Estado PYR_COPY: a janela do nível sai da pirâmide para a mem3 (o
+// pixel 76799 não é escrito, como nos algoritmos) e a mem3 vai para a exibição
+static void pyramid_copy(uint32_t algorithm) {
+    int k = (next_zoom == ZOOM_1_2X) ? 0 : (next_zoom == ZOOM_1_4X) ? 1 : 2;
+    const uint8_t *src = pyramid[k] + ((algorithm == OP_NH_ALG) ? pyr_levels[k].nh_base : 0);
+    uint32_t new_x = 0, new_y = 0;
+
+    for (uint32_t address = 0; address < MODEL_NUM_PIXELS - 1; address++) {
+        mem3[address] = outside_zoom_out_window(new_x, new_y, next_zoom) ? 0 : *src++;
+        next_output_pixel(&new_x, &new_y);
+    }
+    copy_to_display(mem3);
+}
+
+// Estado FILTER: janela 3x3 com as bordas repetidas, soma deslocada
+// (aritmético), |soma| opcional e saturação em 0..255. O hardware lê cada
+// pixel da fonte uma só vez, então filtrar a mem3 nela mesma equivale a
+// filtrar uma cópia dela.
+static void filter_run(uint32_t mem_addr) {
+    static uint8_t src[MODEL_NUM_PIXELS];
+    uint32_t shift = mem_addr & FILTER_SHIFT_MASK;
+
+    memcpy(src, (mem_addr & FILTER_FROM_MEM3) ? mem3 : mem1, sizeof(src));
+    for (int y = 0; y < 240; y++) {
+        for (int x = 0; x < MODEL_IMG_WIDTH; x++) {
+            int32_t sum = 0;
+            for (int k = 0; k < FILTER_TAPS; k++) {
+                int wy = y + k / 3 - 1, wx = x + k % 3 - 1;
+                wy = (wy < 0) ? 0 : (wy > 239) ? 239 : wy;
+                wx = (wx < 0) ? 0 : (wx > 319) ? 319 : wx;
+                sum += filter_kernel[k] * src[wy * MODEL_IMG_WIDTH + wx];
+            }
+            sum >>= shift; // filt_sum >>> filt_shift
+            if ((mem_addr & FILTER_ABS) && sum < 0) {
+                sum = -sum;
+            }
+            mem3[y * MODEL_IMG_WIDTH + x] = (uint8_t)((sum < 0) ? 0 : (sum > 255) ? 255 : sum);
+        }
+    }
+    next_zoom = current_zoom;
+    copy_to_display(mem3);
+}
+
+// Entrada do histograma (s0 do main.v)
+static void stats_count_pixel(uint8_t value) {
+    stats.bins[value] = (stats.bins[value] + 1) & 0x1FFFF;
+    stats.count = (stats.count + 1) & 0x1FFFF;
+    stats.sum = (stats.sum + value) & 0x1FFFFFF;
+    if (value < stats.min) stats.min = value;
+    if (value > stats.max) stats.max = value;
+}
+
+// Pixel escrito na mem1 (stats_tap do main.v: STORE no quadro e retângulo)
+static void mem1_store(uint32_t address, uint8_t value) {
+    if (address < MODEL_NUM_PIXELS) {
+        mem1[address] = value;
+        if (stats.stream) {
+            stats_count_pixel(value);
+        }
+    }
+    pyr_valid = 0;
+}
+
+// Estado STATS: zera e, conforme o modo, passa a contar as escritas na
+// mem1 ou varre a mem1/mem3 uma vez
+static void stats_start(uint32_t mode) {
+    memset(stats.bins, 0, sizeof(stats.bins));
+    stats.count = 0;
+    stats.sum = 0;
+    stats.min = 0xFF;
+    stats.max = 0;
+    stats.stream = (mode == STATS_STREAM);
+    if (mode == STATS_SCAN_MEM1 || mode == STATS_SCAN_MEM3) {
+        const uint8_t *src = (mode == STATS_SCAN_MEM3) ? mem3 : mem1;
+        for (uint32_t i = 0; i < MODEL_NUM_PIXELS; i++) {
+            stats_count_pixel(src[i]);
+        }
+    }
+}
+
+// Estado STATS_READ: byte do registrador reg (STATS_REG_*) para o pio_dataout
+static uint32_t stats_read(uint32_t reg, uint32_t bin, uint32_t byte) {
+    uint32_t word;
+    switch (reg) {
+        case STATS_REG_BIN:   word = stats.bins[bin & 0xFF]; break;
+        case STATS_REG_COUNT: word = stats.count; break;
+        case STATS_REG_SUM:   word = stats.sum; break;
+        default:              word = stats.min | ((uint32_t)stats.max << 8); break;
+    }
+    return (word >> (8 * byte)) & 0xFF;
+}
+
+// =================================================================
+// Decodificação (estado IDLE do main.v)
+// =================================================================
+// Estado ALGORITHM (ou PYR_COPY) seguido da cópia da mem3 para a exibição
+static void run_algorithm(uint32_t algorithm) {
+    if ((algorithm == OP_BA_ALG || algorithm == OP_NH_ALG) && pyr_valid) {
+        pyramid_copy(algorithm);
+        return;
+    }
+
+    switch (algorithm) {
+        case OP_PR_ALG:  run_pr_alg();  break;
+        case OP_NHI_ALG: run_nhi_alg(); break;
+        case OP_BA_ALG:  run_ba_alg();  break;
+        default:         run_nh_alg();  break;
+    }
+    copy_to_display(mem3);
+}
+
+static void dispatch_algorithm(uint32_t opcode, uint32_t sel_mem, uint32_t mem_addr, uint32_t data_in) {
+    int zoom_min = (current_zoom == ZOOM_1_8X);
+    int zoom_max = (current_zoom == ZOOM_8X);
+    uint32_t previous_next_zoom = next_zoom;
+    uint32_t algorithm;
+
+    zoom_x_offset = mem_addr;
+    zoom_y_offset = data_in;
+
+    switch (opcode) {
+        case OP_NH_ALG:
+        case OP_BA_ALG:
+            if (zoom_min) return;
+            next_zoom = (current_zoom - 1) & 0x7;
+            if (current_zoom == ZOOM_2X) {
+                copy_to_display(mem1);
+                return;
+            } else if (current_zoom <= ZOOM_1X) {
+                algorithm = opcode;
+            } else if (opcode == OP_BA_ALG) {
+                algorithm = OP_PR_ALG;
+            } else if (previous_next_zoom > ZOOM_1X) {
+                algorithm = OP_NHI_ALG;
+            } else {
+                return;
+            }
+            break;
+
+        default: // OP_NHI_ALG / OP_PR_ALG (SEL_MEM = 1 -> Pan)
+            if (zoom_max && !sel_mem) return;
+            next_zoom = sel_mem ? current_zoom : ((current_zoom + 1) & 0x7);
+            if (current_zoom == ZOOM_1_2X && !sel_mem) {
+                copy_to_display(mem1);
+                return;
+            }
+            algorithm = opcode;
+            break;
+    }
+
+    run_algorithm(algorithm);
+}
+
+// Combinações de nível e algoritmo aceitas pelo CTRL_SET_ZOOM
+static int set_zoom_valid(uint32_t level, uint32_t algorithm) {
+    if (level == ZOOM_1X) return 1;
+    if (level > ZOOM_1X)  return algorithm == OP_PR_ALG || algorithm == OP_NHI_ALG;
+    if (level >= ZOOM_1_8X) return algorithm == OP_BA_ALG || algorithm == OP_NH_ALG;
+    return 0;
+}
+
+// CTRL_SET_ZOOM: vai direto ao nível pedido, numa única passada a partir da mem1
+static void set_zoom(uint32_t mem_addr, uint32_t data_in) {
+    uint32_t level = (mem_addr >> EXT_CTRL_SHIFT) & 0x7;
+    uint32_t algorithm = ((mem_addr >> SET_ZOOM_ALG_SHIFT) & 0x3) + OP_NHI_ALG;
+
+    if (!set_zoom_valid(level, algorithm)) {
+        flag_error = 1;
+        return;
+    }
+    next_zoom = level;
+    zoom_x_offset = mem_addr & 0x1FF;
+    zoom_y_offset = data_in;
+    if (level == ZOOM_1X) {
+        copy_to_display(mem1);
+    } else {
+        run_algorithm(algorithm);
+    }
+}
+
+// Estado RECT_WRITE: count pixels na ordem de varredura do retângulo, tirados
+// do pacote (run = 0, byte 0 primeiro) ou todos iguais ao byte 0 (run = 1)
+static void rect_write(uint32_t packet, uint32_t count, int run) {
+    for (uint32_t k = 0; k < count && rect.active; k++) {
+        mem1_store(rect.addr, (uint8_t)packet);
+        if (!run) {
+            packet >>= 8;
+        }
+        if (rect.col == rect.w_m1) {
+            rect.col = 0;
+            rect.addr = (rect.addr + MODEL_IMG_WIDTH - rect.w_m1) & MODEL_ADDR_MASK;
+            rect.active = (rect.row != rect.h_m1);
+            rect.row = (rect.row + 1) & 0xFF;
+        } else {
+            rect.col++;
+            rect.addr = (rect.addr + 1) & MODEL_ADDR_MASK;
+        }
+    }
+}
+
+// Instruções estendidas (OP_REFRESH_SCREEN com SEL_MEM = 1)
+static void model_execute_ext(uint32_t mem_addr, uint32_t data_in) {
+    switch (mem_addr >> EXT_SUBOP_SHIFT) {
+        case EXT_RECT_ORIGIN:
+            rect.x = mem_addr & 0x1FF;
+            rect.y = data_in;
+            rect.active = 0;
+            break;
+        case EXT_RECT_SIZE:
+            if (rect.x + (mem_addr & 0x1FF) > 319 || rect.y + data_in > 239) {
+                flag_error = 1;
+                rect.active = 0;
+                break;
+            }
+            rect.w_m1 = mem_addr & 0x1FF;
+            rect.h_m1 = data_in;
+            rect.col = 0;
+            rect.row = 0;
+            rect.addr = rect.y * MODEL_IMG_WIDTH + rect.x;
+            rect.active = 1;
+            break;
+        case EXT_CTRL:
+            if ((mem_addr >> EXT_CTRL_SHIFT) & CTRL_SET_ZOOM) {
+                set_zoom(mem_addr, data_in);
+                break;
+            }
+            switch ((mem_addr >> EXT_CTRL_SHIFT) & 0xF) {
+                case CTRL_PYRAMID_BUILD: pyramid_build(); break;
+                case CTRL_ABORT:         op_seq--;        break; // Nunca há algoritmo em execução: não conta
+                case CTRL_FILTER_COEF: {
+                    uint32_t index = (mem_addr >> FILTER_INDEX_SHIFT) & 0xF;
+                    if (index >= FILTER_TAPS) {
+                        flag_error = 1;
+                    } else {
+                        filter_kernel[index] = (int8_t)data_in;
+                    }
+                    break;
+                }
+                case CTRL_FILTER_RUN:    filter_run(mem_addr); break;
+                case CTRL_STATS_START:   stats_start((mem_addr >> STATS_MODE_SHIFT) & 0x3); break;
+                case CTRL_STATS_READ:
+                    data_out = stats_read((mem_addr >> STATS_MODE_SHIFT) & 0x3, data_in,
+                                          (mem_addr >> STATS_BYTE_SHIFT) & 0x3);
+                    break;
+                case CTRL_LUT: {
+                    uint32_t channels = (mem_addr >> LUT_CHANNEL_SHIFT) & LUT_GRAY;
+                    for (uint32_t c = 0; c < 3; c++) {
+                        if (channels & (LUT_RED >> c)) {
+                            lut[c][mem_addr & 0xFF] = (uint8_t)data_in;
+                        }
+                    }
+                    if (channels == 0) {
+                        lut_on = mem_addr & 1;
+                    }
+                    break;
+                }
+                case CTRL_CONFIG: {
+                    uint32_t reg = (mem_addr >> CONFIG_REG_SHIFT) & 0x7;
+                    uint32_t value = mem_addr & 0xFF;
+                    if (reg == CONFIG_PIXEL_FORMAT && (value == PIXEL_GRAY8 || value == PIXEL_RGB332)) {
+                        pixel_rgb332 = (value == PIXEL_RGB332);
+                        pyr_valid = 0;
+                    } else if (reg == CONFIG_ORIENTATION && value <= 0x7) {
+                        vga_orientation = value;
+                    } else if (reg == CONFIG_SCANOUT && value <= SCANOUT_2X_BILINEAR) {
+                        vga_scanout = value;
+                    } else if (reg == CONFIG_OVERLAY && value <= 1) {
+                        vga_overlay.on = value;
+                    } else if ((reg & ~1u) == CONFIG_OVERLAY_POS && (mem_addr & 0x1FF) < MODEL_IMG_WIDTH &&
+                               data_in < MODEL_IMG_HEIGHT) {
+                        vga_overlay.x = mem_addr & 0x1FF;
+                        vga_overlay.y = data_in;
+                    } else if ((reg & ~1u) == CONFIG_OVERLAY_SIZE && (mem_addr & 0x1FF) < MODEL_IMG_WIDTH &&
+                               data_in < MODEL_IMG_HEIGHT) {
+                        vga_overlay.w_m1 = mem_addr & 0x1FF;
+                        vga_overlay.h_m1 = data_in;
+                    } else {
+                        flag_error = 1;
+                    }
+                    break;
+                }
+                default:                 flag_error = 1;  break;
+            }
+            break;
+        case EXT_RECT_RUN:
+            if (!rect.active) {
+                flag_error = 1;
+                break;
+            }
+            rect_write(data_in, (mem_addr & (RECT_RUN_MAX - 1)) + 1, 1);
+            break;
+        default:
+            flag_error = 1;
+            break;
+    }
+}
+
+static void model_execute(uint32_t instruction) {
+    uint32_t opcode   = instruction & 0x7;
+    uint32_t mem_addr = (instruction >> 3) & MODEL_ADDR_MASK;
+    uint32_t sel_mem  = (instruction >> 20) & 0x1;
+    uint32_t data_in  = (instruction >> 21) & 0xFF;
+
+    op_seq++;
+    switch (opcode) {
+        case OP_LOAD:
+            data_out = sel_mem ? mem_read(mem3, mem_addr) : mem_read(mem1, mem_addr);
+            break;
+        case OP_STORE:
+            if (sel_mem) {
+                if (rect.active) {
+                    rect_write(data_in | ((mem_addr & 0xFFFF) << 8), RECT_PIXELS_PER_BEAT, 0);
+                } else {
+                    flag_error = 1;
+                }
+                break;
+            }
+            if (mem_addr > 76799) flag_error = 1;
+            mem1_store(mem_addr, (uint8_t)data_in);
+            break;
+        case OP_RESET:
+            next_zoom = ZOOM_1X;
+            flag_error = 0;
+            copy_to_display(mem1);
+            break;
+        case OP_REFRESH_SCREEN:
+            if (sel_mem) {
+                model_execute_ext(mem_addr, data_in);
+                break;
+            }
+            copy_to_display(mem1);
+            break;
+        default:
+            dispatch_algorithm(opcode, sel_mem, mem_addr, data_in);
+            break;
+    }
+}
+
+// =================================================================
+// API (mesmos símbolos de api_fpga.s)
+// =================================================================
+int setup_memory_map(void) {
+    fprintf(stderr, "Backend: modelo em software do main.v (sem /dev/mem).\n");
+    return 0;
+}
+
+void cleanup_memory_map(void) {
+}
+
+uint32_t coproc_wait_done(void) {
+    return 1; // A operação já terminou: uma leitura do "pio_flags" basta
+}
+
+void coproc_issue(uint32_t instruction) {
+    model_execute(instruction);
+}
+
+uint32_t coproc_get_status(void) {
+    // Mesma montagem do pio_flags no ghrd_top.v; a FSM está sempre em IDLE (0)
+    return FLAG_DONE_MASK
+         | (flag_error ? FLAG_ERROR_MASK : 0)
+         | (current_zoom == ZOOM_8X ? FLAG_ZMAX_MASK : 0)
+         | (current_zoom == ZOOM_1_8X ? FLAG_ZMIN_MASK : 0)
+         | ((current_zoom & STATUS_ZOOM_MASK) << STATUS_ZOOM_SHIFT)
+         | ((zoom_x_offset & STATUS_X_MASK) << STATUS_X_SHIFT)
+         | ((zoom_y_offset & STATUS_Y_MASK) << STATUS_Y_SHIFT)
+         | ((op_seq & STATUS_SEQ_MASK) << STATUS_SEQ_SHIFT);
+}
+
+void coproc_apply_zoom(uint32_t algorithm_code) {
+    model_execute(algorithm_code);
+}
+
+void coproc_reset_image(void) {
+    model_execute(OP_RESET);
+}
+
+void coproc_write_pixel(uint32_t address, uint8_t value) {
+    model_execute(OP_STORE | (address << 3) | ((uint32_t)value << 21));
+}
+
+uint8_t coproc_read_pixel(uint32_t address, uint32_t sel_mem) {
+    model_execute(OP_LOAD | (address << 3) | (sel_mem << 20));
+    return (uint8_t)data_out;
+}
+
+void coproc_read_block(uint32_t address, uint32_t count, uint32_t sel_mem, uint8_t *out) {
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = coproc_read_pixel(address + i, sel_mem);
+    }
+}
+
+void coproc_rect_begin(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    model_execute(OP_EXT | (EXT_RECT_ORIGIN << (EXT_SUBOP_SHIFT + 3)) | (x << 3) | (y << 21));
+    model_execute(OP_EXT | (EXT_RECT_SIZE << (EXT_SUBOP_SHIFT + 3)) | ((w - 1) << 3) | ((h - 1) << 21));
+}
+
+void coproc_rect_data(const uint8_t *pixels, uint32_t count) {
+    for (uint32_t i = 0; i < count; i += RECT_PIXELS_PER_BEAT) {
+        uint32_t instruction = OP_RECT_DATA | ((uint32_t)pixels[i] << 21);
+        if (i + 1 < count) instruction |= (uint32_t)pixels[i + 1] << 3;
+        if (i + 2 < count) instruction |= (uint32_t)pixels[i + 2] << 11;
+        model_execute(instruction);
+    }
+}
+
+void coproc_rect_run(uint8_t value, uint32_t count) {
+    model_execute(OP_EXT | (EXT_RECT_RUN << (EXT_SUBOP_SHIFT + 3)) | ((count - 1) << 3) | ((uint32_t)value << 21));
+}
+
+void coproc_pyramid_build(void) {
+    model_execute(OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_PYRAMID_BUILD << (EXT_CTRL_SHIFT + 3)));
+}
+
+void coproc_set_view(uint32_t level, uint32_t x_offset, uint32_t y_offset, uint32_t algorithm_code) {
+    model_execute(SET_ZOOM_INSTRUCTION(level, algorithm_code, x_offset, y_offset));
+}
+
+void coproc_filter_load(const int8_t *kernel) {
+    for (uint32_t i = 0; i < FILTER_TAPS; i++) {
+        model_execute(FILTER_COEF_INSTRUCTION(i, (uint32_t)(uint8_t)kernel[i]));
+    }
+}
+
+void coproc_filter_run(uint32_t flags, uint32_t shift) {
+    model_execute(FILTER_RUN_INSTRUCTION(flags, shift));
+}
+
+void coproc_apply_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset) {
+    model_execute(algorithm_code | (x_offset << 3) | (y_offset << 21));
+}
+
+void coproc_pan_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset) {
+    model_execute(algorithm_code | (1u << 20) | (x_offset << 3) | (y_offset << 21));
+}
+
+void coproc_stats_start(uint32_t mode) {
+    model_execute(STATS_START_INSTRUCTION(mode));
+}
+
+// Um registrador do CTRL_STATS_READ, byte a byte como na api_fpga.s
+static uint32_t stats_read_word(uint32_t reg, uint32_t bin) {
+    uint32_t word = 0;
+    for (uint32_t b = 0; b < STATS_REG_BYTES(reg); b++) {
+        model_execute(STATS_READ_INSTRUCTION(reg, bin, b));
+        word |= data_out << (8 * b);
+    }
+    return word;
+}
+
+void coproc_stats_read(CoprocStats *out) {
+    for (uint32_t i = 0; i < STATS_BINS; i++) {
+        out->histogram[i] = stats_read_word(STATS_REG_BIN, i);
+    }
+    out->count = stats_read_word(STATS_REG_COUNT, 0);
+    out->sum = stats_read_word(STATS_REG_SUM, 0);
+    uint32_t minmax = stats_read_word(STATS_REG_MINMAX, 0);
+    out->min = (uint8_t)minmax;
+    out->max = (uint8_t)(minmax >> 8);
+}
+
+void coproc_load_lut(uint32_t channels, const uint8_t *table) {
+    for (uint32_t i = 0; i < LUT_ENTRIES; i++) {
+        model_execute(LUT_WRITE_INSTRUCTION(channels, i, (uint32_t)table[i]));
+    }
+    coproc_lut_enable(1);
+}
+
+void coproc_lut_enable(uint32_t on) {
+    model_execute(LUT_ENABLE_INSTRUCTION(on & 1));
+}
+
+void coproc_set_pixel_format(uint32_t format) {
+    model_execute(CONFIG_INSTRUCTION(CONFIG_PIXEL_FORMAT, format));
+}
+
+void coproc_set_orientation(uint32_t orientation) {
+    model_execute(CONFIG_INSTRUCTION(CONFIG_ORIENTATION, orientation & 0x7));
+}
+
+void coproc_set_scanout(uint32_t mode) {
+    model_execute(CONFIG_INSTRUCTION(CONFIG_SCANOUT, mode));
+}
+
+void coproc_overlay_rect(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    model_execute(OVERLAY_SIZE_INSTRUCTION(w, h));
+    coproc_overlay_move(x, y);
+    coproc_overlay_enable(1);
+}
+
+void coproc_overlay_move(uint32_t x, uint32_t y) {
+    model_execute(OVERLAY_POS_INSTRUCTION(x, y));
+}
+
+void coproc_overlay_enable(uint32_t on) {
+    model_execute(OVERLAY_ENABLE_INSTRUCTION(on));
+}
@@ -0,0 +1,554 @@
+/*
+ * =================================================================
+ * coproc_trace.c
+ * =================================================================
+ * Implementação do rastreador descrito em coproc_trace.h.
+ *
+ * Cada função da API é ligada com -Wl,--wrap=<função>: as chamadas do
+ * programa vão para __wrap_<função>, que mede a chamada real
+ * (__real_<função>) e grava um evento no buffer da thread. Funciona
+ * igualmente com api_fpga.s e com coproc_model.c.
+ *
+ * Cada thread escreve apenas no seu próprio buffer (um único produtor),
+ * então o caminho quente não usa travas: duas leituras do relógio, a
+ * escrita do evento e um store com semântica "release" no índice.
+ * Os buffers são encadeados numa lista global com compare-and-swap na
+ * primeira chamada de cada thread. Ao encher, os eventos mais antigos
+ * são sobrescritos.
+ *
+ * Relógio: no HPS o clock_gettime não tem vDSO (o Cortex-A9 não possui
+ * o "generic timer") e vira uma chamada de sistema. Por isso, no ARM, os
+ * instantes são lidos direto do Global Timer do A9 (mapeado via
+ * /dev/mem) e só convertidos para ns na exportação, calibrando contra o
+ * CLOCK_MONOTONIC. Sem acesso ao /dev/mem (ou no PC) usa-se o
+ * clock_gettime, e o tick vale 1 ns.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "api_fpga.h"
+#include "constantes.h"
+#include "coproc_trace.h"
+
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 65536 // Potência de 2 (eventos por thread)
+#endif
+#define TRACE_RING_MASK (TRACE_RING_EVENTS - 1)
+#define TRACE_MAX_SPANS 8
+
+// Global Timer do Cortex-A9 (periféricos privados da MPU)
+#define A9_PERIPH_BASE         0xFFFEC000
+#define A9_PERIPH_SPAN         0x1000
+#define A9_GLOBAL_TIMER_OFFSET 0x200
+
+typedef struct {
+    uint64_t    start;       // Em ticks do relógio do rastreador
+    uint32_t    duration;    // Em ticks
+    uint32_t    instruction; // Palavra do pio_instruct (0 se não houver)
+    uint32_t    polls;       // Iterações no coproc_wait_done
+    const char *name;
+} TraceEvent;
+
+typedef struct TraceRing {
+    struct TraceRing *next;
+    uint32_t   tid;
+    uint32_t   head;             // Total de eventos já gravados
+    uint32_t   last_instruction; // Última instrução enviada (para os eventos de espera)
+    uint32_t   status_polls;     // Total de leituras do coproc_get_status
+    int        ticket_open;      // Há um ticket enviado por esta thread ainda não concluído
+    uint64_t   ticket_start;
+    uint32_t   ticket_instruction;
+    uint32_t   ticket_polls;     // status_polls no envio do ticket
+    int        span_depth;
+    uint64_t   span_start[TRACE_MAX_SPANS];
+    const char *span_name[TRACE_MAX_SPANS];
+    TraceEvent events[TRACE_RING_EVENTS];
+} TraceRing;
+
+static TraceRing *g_rings;
+static uint32_t   g_next_tid;
+static int        g_atexit_registered;
+static __thread TraceRing *t_ring;
+
+static volatile uint32_t *g_global_timer; // NULL: usa clock_gettime
+static uint64_t g_ref_ticks, g_ref_ns;    // Referência para a calibração
+
+// =================================================================
+// Relógio
+// =================================================================
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t trace_now(void) {
+#if defined(__arm__)
+    if (g_global_timer) {
+        // Contador de 64 bits lido em duas metades: repete se a alta virou
+        uint32_t hi, lo;
+        do {
+            hi = g_global_timer[1];
+            lo = g_global_timer[0];
+        } while (hi != g_global_timer[1]);
+        return ((uint64_t)hi << 32) | lo;
+    }
+#endif
+    return monotonic_ns();
+}
+
+__attribute__((constructor))
+static void trace_clock_init(void) {
+#if defined(__arm__)
+    int fd = open("/dev/mem", O_RDONLY | O_SYNC);
+    if (fd >= 0) {
+        void *base = mmap(NULL, A9_PERIPH_SPAN, PROT_READ, MAP_SHARED, fd, A9_PERIPH_BASE);
+        if (base != MAP_FAILED) {
+            g_global_timer = (volatile uint32_t *)((uint8_t *)base + A9_GLOBAL_TIMER_OFFSET);
+        }
+        close(fd);
+    }
+#endif
+    g_ref_ns = monotonic_ns();
+    g_ref_ticks = trace_now();
+}
+
+// Nanossegundos por tick, medidos entre a inicialização e agora
+static double trace_ns_per_tick(void) {
+    if (!g_global_timer) {
+        return 1.0;
+    }
+    uint64_t ns = monotonic_ns();
+    uint64_t ticks = trace_now();
+    if (ticks <= g_ref_ticks) {
+        return 1.0;
+    }
+    return (double)(ns - g_ref_ns) / (double)(ticks - g_ref_ticks);
+}
+
+// =================================================================
+// Caminho quente
+// =================================================================
+static void trace_dump_at_exit(void) {
+    const char *path = getenv("COPROC_TRACE_FILE");
+    if (!path) {
+        path = "coproc_trace.json";
+    }
+    if (*path) {
+        coproc_trace_dump(path);
+    }
+}
+
+static TraceRing *trace_ring(void) {
+    if (t_ring) {
+        return t_ring;
+    }
+
+    TraceRing *ring = calloc(1, sizeof(TraceRing));
+    if (!ring) {
+        return NULL;
+    }
+    ring->tid = __atomic_add_fetch(&g_next_tid, 1, __ATOMIC_RELAXED);
+    ring->next = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(&g_rings, &ring->next, ring, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+    }
+    if (!__atomic_exchange_n(&g_atexit_registered, 1, __ATOMIC_ACQ_REL)) {
+        atexit(trace_dump_at_exit);
+    }
+    t_ring = ring;
+    return ring;
+}
+
+static inline void trace_record(TraceRing *ring, const char *name, uint64_t start, uint32_t instruction, uint32_t polls) {
+    uint64_t end = trace_now();
+    if (!ring) {
+        return;
+    }
+
+    uint32_t head = ring->head;
+    TraceEvent *event = &ring->events[head & TRACE_RING_MASK];
+    event->start = start;
+    event->duration = (uint32_t)(end - start);
+    event->instruction = instruction;
+    event->polls = polls;
+    event->name = name;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static inline void trace_submit(TraceRing *ring, uint32_t instruction) {
+    if (ring) {
+        ring->last_instruction = instruction;
+    }
+}
+
+// Chamada que envia várias instruções pela API em Assembly, sem passar
+// pelo coproc_issue: vira um intervalo com o nome, sem palavra de instrução
+static inline void trace_call(TraceRing *ring, const char *name, uint64_t start) {
+    trace_submit(ring, 0);
+    trace_record(ring, name, start, 0, 0);
+}
+
+// =================================================================
+// Intervalos definidos pela aplicação (ex.: carregamento do BMP)
+// =================================================================
+void coproc_trace_span_begin(const char *name) {
+    TraceRing *ring = trace_ring();
+    if (ring && ring->span_depth < TRACE_MAX_SPANS) {
+        ring->span_name[ring->span_depth] = name;
+        ring->span_start[ring->span_depth] = trace_now();
+    }
+    if (ring) {
+        ring->span_depth++;
+    }
+}
+
+void coproc_trace_span_end(void) {
+    TraceRing *ring = trace_ring();
+    if (!ring || ring->span_depth == 0) {
+        return;
+    }
+    ring->span_depth--;
+    if (ring->span_depth < TRACE_MAX_SPANS) {
+        trace_record(ring, ring->span_name[ring->span_depth], ring->span_start[ring->span_depth], 0, 0);
+    }
+}
+
+// =================================================================
+// Tickets do coproc_async.c (envio -> conclusão)
+// =================================================================
+void coproc_trace_ticket_begin(uint32_t instruction) {
+    TraceRing *ring = trace_ring();
+    if (ring) {
+        ring->ticket_open = 1;
+        ring->ticket_start = trace_now();
+        ring->ticket_instruction = instruction;
+        ring->ticket_polls = ring->status_polls;
+    }
+}
+
+void coproc_trace_ticket_end(void) {
+    TraceRing *ring = trace_ring();
+    if (!ring || !ring->ticket_open) {
+        return;
+    }
+    ring->ticket_open = 0;
+    trace_record(ring, "coproc_ticket", ring->ticket_start, ring->ticket_instruction,
+                 ring->status_polls - ring->ticket_polls);
+}
+
+// =================================================================
+// Interceptação da API (-Wl,--wrap=...)
+// =================================================================
+void __real_coproc_write_pixel(uint32_t address, uint8_t value);
+uint8_t __real_coproc_read_pixel(uint32_t address, uint32_t sel_mem);
+void __real_coproc_read_block(uint32_t address, uint32_t count, uint32_t sel_mem, uint8_t *out);
+void __real_coproc_rect_begin(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+void __real_coproc_rect_data(const uint8_t *pixels, uint32_t count);
+void __real_coproc_rect_run(uint8_t value, uint32_t count);
+void __real_coproc_pyramid_build(void);
+void __real_coproc_set_view(uint32_t level, uint32_t x_offset, uint32_t y_offset, uint32_t algorithm_code);
+void __real_coproc_filter_load(const int8_t *kernel);
+void __real_coproc_filter_run(uint32_t flags, uint32_t shift);
+void __real_coproc_stats_start(uint32_t mode);
+void __real_coproc_stats_read(CoprocStats *out);
+void __real_coproc_load_lut(uint32_t channels, const uint8_t *table);
+void __real_coproc_lut_enable(uint32_t on);
+void __real_coproc_set_pixel_format(uint32_t format);
+void __real_coproc_set_orientation(uint32_t orientation);
+void __real_coproc_set_scanout(uint32_t mode);
+void __real_coproc_overlay_rect(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+void __real_coproc_overlay_move(uint32_t x, uint32_t y);
+void __real_coproc_overlay_enable(uint32_t on);
+void __real_coproc_apply_zoom(uint32_t algorithm_code);
+void __real_coproc_reset_image(void);
+uint32_t __real_coproc_wait_done(void);
+void __real_coproc_issue(uint32_t instruction);
+void __real_coproc_apply_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset);
+void __real_coproc_pan_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset);
+uint32_t __real_coproc_get_status(void);
+
+void __wrap_coproc_write_pixel(uint32_t address, uint8_t value) {
+    uint32_t instruction = OP_STORE | (address << 3) | ((uint32_t)value << 21);
+    uint64_t t0 = trace_now();
+    __real_coproc_write_pixel(address, value);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_write_pixel", t0, instruction, 0);
+}
+
+uint8_t __wrap_coproc_read_pixel(uint32_t address, uint32_t sel_mem) {
+    uint32_t instruction = OP_LOAD | (address << 3) | (sel_mem << 20);
+    uint64_t t0 = trace_now();
+    uint8_t value = __real_coproc_read_pixel(address, sel_mem);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_read_pixel", t0, instruction, 0);
+    return value;
+}
+
+void __wrap_coproc_read_block(uint32_t address, uint32_t count, uint32_t sel_mem, uint8_t *out) {
+    uint32_t instruction = OP_LOAD | (address << 3) | (sel_mem << 20);
+    uint64_t t0 = trace_now();
+    __real_coproc_read_block(address, count, sel_mem, out);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_read_block", t0, instruction, 0);
+}
+
+void __wrap_coproc_rect_begin(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    uint32_t instruction = OP_EXT | (EXT_RECT_SIZE << (EXT_SUBOP_SHIFT + 3)) | ((w - 1) << 3) | ((h - 1) << 21);
+    uint64_t t0 = trace_now();
+    __real_coproc_rect_begin(x, y, w, h);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_rect_begin", t0, instruction, 0);
+}
+
+void __wrap_coproc_rect_data(const uint8_t *pixels, uint32_t count) {
+    uint32_t instruction = OP_RECT_DATA;
+    uint64_t t0 = trace_now();
+    __real_coproc_rect_data(pixels, count);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_rect_data", t0, instruction, 0);
+}
+
+void __wrap_coproc_rect_run(uint8_t value, uint32_t count) {
+    uint32_t instruction = OP_EXT | (EXT_RECT_RUN << (EXT_SUBOP_SHIFT + 3)) | ((count - 1) << 3) | ((uint32_t)value << 21);
+    uint64_t t0 = trace_now();
+    __real_coproc_rect_run(value, count);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_rect_run", t0, instruction, 0);
+}
+
+void __wrap_coproc_pyramid_build(void) {
+    uint32_t instruction = OP_EXT | (EXT_CTRL << (EXT_SUBOP_SHIFT + 3)) | (CTRL_PYRAMID_BUILD << (EXT_CTRL_SHIFT + 3));
+    uint64_t t0 = trace_now();
+    __real_coproc_pyramid_build();
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_pyramid_build", t0, instruction, 0);
+}
+
+void __wrap_coproc_set_view(uint32_t level, uint32_t x_offset, uint32_t y_offset, uint32_t algorithm_code) {
+    uint32_t instruction = SET_ZOOM_INSTRUCTION(level, algorithm_code, x_offset, y_offset);
+    uint64_t t0 = trace_now();
+    __real_coproc_set_view(level, x_offset, y_offset, algorithm_code);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_set_view", t0, instruction, 0);
+}
+
+void __wrap_coproc_filter_load(const int8_t *kernel) {
+    uint64_t t0 = trace_now();
+    __real_coproc_filter_load(kernel);
+    trace_call(trace_ring(), "coproc_filter_load", t0);
+}
+
+void __wrap_coproc_filter_run(uint32_t flags, uint32_t shift) {
+    uint32_t instruction = FILTER_RUN_INSTRUCTION(flags, shift);
+    uint64_t t0 = trace_now();
+    __real_coproc_filter_run(flags, shift);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_filter_run", t0, instruction, 0);
+}
+
+void __wrap_coproc_stats_start(uint32_t mode) {
+    uint32_t instruction = STATS_START_INSTRUCTION(mode);
+    uint64_t t0 = trace_now();
+    __real_coproc_stats_start(mode);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_stats_start", t0, instruction, 0);
+}
+
+void __wrap_coproc_stats_read(CoprocStats *out) {
+    uint64_t t0 = trace_now();
+    __real_coproc_stats_read(out);
+    trace_call(trace_ring(), "coproc_stats_read", t0);
+}
+
+void __wrap_coproc_load_lut(uint32_t channels, const uint8_t *table) {
+    uint64_t t0 = trace_now();
+    __real_coproc_load_lut(channels, table);
+    trace_call(trace_ring(), "coproc_load_lut", t0);
+}
+
+void __wrap_coproc_lut_enable(uint32_t on) {
+    uint32_t instruction = LUT_ENABLE_INSTRUCTION(on & 1);
+    uint64_t t0 = trace_now();
+    __real_coproc_lut_enable(on);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_lut_enable", t0, instruction, 0);
+}
+
+void __wrap_coproc_set_pixel_format(uint32_t format) {
+    uint32_t instruction = CONFIG_INSTRUCTION(CONFIG_PIXEL_FORMAT, format);
+    uint64_t t0 = trace_now();
+    __real_coproc_set_pixel_format(format);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_set_pixel_format", t0, instruction, 0);
+}
+
+void __wrap_coproc_set_orientation(uint32_t orientation) {
+    uint32_t instruction = CONFIG_INSTRUCTION(CONFIG_ORIENTATION, orientation & 0x7);
+    uint64_t t0 = trace_now();
+    __real_coproc_set_orientation(orientation);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_set_orientation", t0, instruction, 0);
+}
+
+void __wrap_coproc_set_scanout(uint32_t mode) {
+    uint32_t instruction = CONFIG_INSTRUCTION(CONFIG_SCANOUT, mode);
+    uint64_t t0 = trace_now();
+    __real_coproc_set_scanout(mode);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_set_scanout", t0, instruction, 0);
+}
+
+void __wrap_coproc_overlay_rect(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    uint64_t t0 = trace_now();
+    __real_coproc_overlay_rect(x, y, w, h);
+    trace_call(trace_ring(), "coproc_overlay_rect", t0);
+}
+
+void __wrap_coproc_overlay_move(uint32_t x, uint32_t y) {
+    uint32_t instruction = OVERLAY_POS_INSTRUCTION(x, y);
+    uint64_t t0 = trace_now();
+    __real_coproc_overlay_move(x, y);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_overlay_move", t0, instruction, 0);
+}
+
+void __wrap_coproc_overlay_enable(uint32_t on) {
+    uint32_t instruction = OVERLAY_ENABLE_INSTRUCTION(on);
+    uint64_t t0 = trace_now();
+    __real_coproc_overlay_enable(on);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_overlay_enable", t0, instruction, 0);
+}
+
+void __wrap_coproc_apply_zoom(uint32_t algorithm_code) {
+    uint64_t t0 = trace_now();
+    __real_coproc_apply_zoom(algorithm_code);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, algorithm_code);
+    trace_record(ring, "coproc_apply_zoom", t0, algorithm_code, 0);
+}
+
+void __wrap_coproc_reset_image(void) {
+    uint64_t t0 = trace_now();
+    __real_coproc_reset_image();
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, OP_RESET);
+    trace_record(ring, "coproc_reset_image", t0, OP_RESET, 0);
+}
+
+uint32_t __wrap_coproc_wait_done(void) {
+    uint64_t t0 = trace_now();
+    uint32_t polls = __real_coproc_wait_done();
+    TraceRing *ring = trace_ring();
+    trace_record(ring, "coproc_wait_done", t0, ring ? ring->last_instruction : 0, polls);
+    return polls;
+}
+
+void __wrap_coproc_issue(uint32_t instruction) {
+    uint64_t t0 = trace_now();
+    __real_coproc_issue(instruction);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_issue", t0, instruction, 0);
+}
+
+void __wrap_coproc_apply_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset) {
+    uint32_t instruction = algorithm_code | (x_offset << 3) | (y_offset << 21);
+    uint64_t t0 = trace_now();
+    __real_coproc_apply_zoom_with_offset(algorithm_code, x_offset, y_offset);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_apply_zoom_with_offset", t0, instruction, 0);
+}
+
+void __wrap_coproc_pan_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset) {
+    uint32_t instruction = algorithm_code | (1u << 20) | (x_offset << 3) | (y_offset << 21);
+    uint64_t t0 = trace_now();
+    __real_coproc_pan_zoom_with_offset(algorithm_code, x_offset, y_offset);
+    TraceRing *ring = trace_ring();
+    trace_submit(ring, instruction);
+    trace_record(ring, "coproc_pan_zoom_with_offset", t0, instruction, 0);
+}
+
+// Lida em laço pelos tickets: só conta, sem gravar evento
+uint32_t __wrap_coproc_get_status(void) {
+    TraceRing *ring = trace_ring();
+    if (ring) {
+        ring->status_polls++;
+    }
+    return __real_coproc_get_status();
+}
+
+// =================================================================
+// Exportação (Chrome Trace Event JSON)
+// =================================================================
+int coproc_trace_dump(const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror("Erro ao gravar o trace");
+        return -1;
+    }
+
+    // O menor instante vira o zero do trace
+    uint64_t origin = UINT64_MAX;
+    for (TraceRing *ring = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint32_t first = (head > TRACE_RING_EVENTS) ? head - TRACE_RING_EVENTS : 0;
+        for (uint32_t i = first; i < head; i++) {
+            if (ring->events[i & TRACE_RING_MASK].start < origin) {
+                origin = ring->events[i & TRACE_RING_MASK].start;
+            }
+        }
+    }
+
+    double ns_per_tick = trace_ns_per_tick();
+    int written = 0;
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for (TraceRing *ring = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint32_t first = (head > TRACE_RING_EVENTS) ? head - TRACE_RING_EVENTS : 0;
+
+        fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"thread %u\"}}",
+                written++ ? ",\n" : "", ring->tid, ring->tid);
+        for (uint32_t i = first; i < head; i++) {
+            const TraceEvent *event = &ring->events[i & TRACE_RING_MASK];
+            fprintf(out, ",\n{\"name\": \"%s\", \"cat\": \"coproc\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+                         "\"ts\": %.3f, \"dur\": %.3f, \"args\": {",
+                    event->name, ring->tid,
+                    (event->start - origin) * ns_per_tick / 1000.0, event->duration * ns_per_tick / 1000.0);
+            // Intervalos (trace_call, TRACE_SPAN_*) não têm palavra de instrução
+            if (event->instruction != 0) {
+                fprintf(out, "\"opcode\": %u, \"instruction\": \"0x%08x\", ",
+                        event->instruction & 0x7, event->instruction);
+            }
+            fprintf(out, "\"polls\": %u}}", event->polls);
+        }
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    return 0;
+}
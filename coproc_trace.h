@@ -0,0 +1,52 @@
+#ifndef COPROC_TRACE_H
+#define COPROC_TRACE_H
+
+/*
+ * =================================================================
+ * Rastreador (tracer) da API do coprocessador
+ * =================================================================
+ * Opcional em tempo de compilação (make TRACE=1). Quando ativo, cada
+ * chamada da API (coproc_*) é interceptada na ligação (ld --wrap) e
+ * registrada num buffer circular por thread, sem travas: instante
+ * monotônico, duração, palavra de instrução empacotada (opcode em
+ * [2:0]) e nº de iterações de espera no coproc_wait_done. As chamadas
+ * que enviam várias instruções (LUT, coeficientes do filtro, retângulo
+ * sobreposto, leitura das estatísticas) ficam sem palavra de instrução.
+ *
+ * Os tickets do coproc_async.c viram um evento "coproc_ticket" do envio
+ * até a conclusão ser vista, com o nº de leituras do coproc_get_status
+ * (cada leitura só incrementa um contador, sem gravar evento).
+ *
+ * Os eventos são gravados no formato "Trace Event" do Chrome
+ * (chrome://tracing, Perfetto) ao final do programa, no arquivo
+ * indicado por COPROC_TRACE_FILE (padrão: coproc_trace.json; vazio
+ * desativa), ou sob demanda com coproc_trace_dump().
+ *
+ * Sem TRACE=1 as macros abaixo não geram código.
+ */
+
+#ifdef COPROC_TRACE
+
+#include <stdint.h>
+
+void coproc_trace_span_begin(const char *name);
+void coproc_trace_span_end(void);
+int  coproc_trace_dump(const char *path);
+void coproc_trace_ticket_begin(uint32_t instruction);
+void coproc_trace_ticket_end(void);
+
+#define TRACE_SPAN_BEGIN(name)          coproc_trace_span_begin(name)
+#define TRACE_SPAN_END()                coproc_trace_span_end()
+#define TRACE_TICKET_BEGIN(instruction) coproc_trace_ticket_begin(instruction)
+#define TRACE_TICKET_END()              coproc_trace_ticket_end()
+
+#else
+
+#define TRACE_SPAN_BEGIN(name)          ((void)0)
+#define TRACE_SPAN_END()                ((void)0)
+#define TRACE_TICKET_BEGIN(instruction) ((void)(instruction))
+#define TRACE_TICKET_END()              ((void)0)
+
+#endif // COPROC_TRACE
+
+#endif // COPROC_TRACE_H
@@ -0,0 +1,344 @@
+/*
+ * =================================================================
+ * coproc_verify.c
+ * =================================================================
+ * Implementação do modo de verificação descrito em coproc_verify.h.
+ *
+ * A thread principal acompanha a sequência de instruções e prevê, com
+ * zoom_host_decode, qual algoritmo a FPGA executou em cada uma. As
+ * operações que alteram a mem3 viram um "job" de uma única vaga:
+ *
+ *   principal: operação -> coproc_verify_after (publica o job)
+ *   verificação: lê a memória de volta -> libera a vaga -> compara
+ *
+ * A vaga só é liberada depois da leitura, e coproc_verify_before espera
+ * por isso: o barramento nunca é usado pelas duas threads ao mesmo tempo
+ * e a memória lida é sempre a da operação conferida.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "constantes.h"
+#include "api_fpga.h"
+#include "zoom_host.h"
+#include "filter_host.h"
+#include "coproc_verify.h"
+
+typedef enum {
+    VERIFY_MEM3,  // Resultado de um algoritmo
+    VERIFY_MEM1,  // Imagem enviada
+    VERIFY_FILTER // Resultado do filtro 3x3
+} VerifyKind;
+
+typedef struct {
+    VerifyKind     kind;
+    uint32_t       sequence;
+    ZoomHostAction action;
+    int8_t         kernel[FILTER_TAPS]; // VERIFY_FILTER
+} VerifyJob;
+
+static struct {
+    int             enabled;
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    int             pending; // Job publicado e ainda não lido da FPGA
+    int             busy;    // Thread comparando
+    int             quit;
+    VerifyJob       job;
+
+    // Estado acompanhado pela thread principal
+    ZoomHostState   state;
+    int             state_known; // Só depois do primeiro RESET
+    int             mem3_known;  // A última escrita na mem3 foi conferida (lida de volta)
+    int             kernel_known;
+    int8_t          kernel[FILTER_TAPS];
+    uint32_t        sequence;
+    uint8_t         mem1[ZOOM_HOST_PIXELS]; // Cópia da mem1
+
+    // Estatísticas (protegidas por lock)
+    uint32_t        checked;
+    uint32_t        failed;
+    uint64_t        bad_pixels;
+} g_verify = { .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+// Buffers da thread de verificação
+static uint8_t g_readback[ZOOM_HOST_PIXELS];
+static uint8_t g_source[ZOOM_HOST_PIXELS];
+static uint8_t g_expected[ZOOM_HOST_PIXELS];
+static uint8_t g_mem3_last[ZOOM_HOST_PIXELS]; // mem3 lida na última conferência que a escreveu
+
+// =================================================================
+// Thread de verificação
+// =================================================================
+static const char *algorithm_name(uint32_t algorithm) {
+    switch (algorithm) {
+        case OP_PR_ALG:  return "pr";
+        case OP_NHI_ALG: return "nhi";
+        case OP_BA_ALG:  return "ba";
+        default:         return "nh";
+    }
+}
+
+static const char *level_name(uint32_t level) {
+    static const char *names[] = { "?", "1/8", "1/4", "1/2", "1x", "2x", "4x", "8x" };
+    return names[level & 0x7];
+}
+
+static void describe_job(const VerifyJob *job, char *text, size_t size) {
+    if (job->kind == VERIFY_MEM1) {
+        snprintf(text, size, "envio da imagem (mem1)");
+    } else if (job->kind == VERIFY_FILTER) {
+        snprintf(text, size, "filtro 3x3 (%s)", (job->action.x_offset & FILTER_FROM_MEM3) ? "mem3" : "mem1");
+    } else {
+        snprintf(text, size, "%s %s (%u,%u)", algorithm_name(job->action.algorithm),
+                 level_name(job->action.level), job->action.x_offset, job->action.y_offset);
+    }
+}
+
+static void compare_job(const VerifyJob *job) {
+    const uint8_t *expected = g_source;
+    uint32_t mismatches = 0;
+    int first = -1;
+
+    if (job->kind == VERIFY_MEM3) {
+        // Pixels que o algoritmo não escreve ficam iguais ao que foi lido
+        memcpy(g_expected, g_readback, sizeof(g_expected));
+        zoom_host_run(g_expected, g_source, job->action.algorithm, job->action.level,
+                      job->action.x_offset, job->action.y_offset, job->action.pixel_format);
+        expected = g_expected;
+    } else if (job->kind == VERIFY_FILTER) {
+        uint32_t mem_addr = job->action.x_offset;
+        filter_host_run(g_expected, (mem_addr & FILTER_FROM_MEM3) ? g_mem3_last : g_source, job->kernel,
+                        mem_addr & (FILTER_ABS | FILTER_FROM_MEM3), mem_addr & FILTER_SHIFT_MASK);
+        expected = g_expected;
+    }
+
+    for (int i = 0; i < ZOOM_HOST_PIXELS; i++) {
+        if (g_readback[i] != expected[i]) {
+            if (first < 0) {
+                first = i;
+            }
+            mismatches++;
+        }
+    }
+
+    if (mismatches) {
+        char text[64];
+        describe_job(job, text, sizeof(text));
+        printf("[verifica] #%u %s: %u pixels divergentes; primeiro em (%d, %d): lido %u, esperado %u\n",
+               job->sequence, text, mismatches, first % ZOOM_HOST_WIDTH, first / ZOOM_HOST_WIDTH,
+               g_readback[first], expected[first]);
+        fflush(stdout);
+    }
+
+    if (job->kind != VERIFY_MEM1) {
+        memcpy(g_mem3_last, g_readback, sizeof(g_mem3_last));
+    }
+
+    pthread_mutex_lock(&g_verify.lock);
+    g_verify.checked++;
+    if (mismatches) {
+        g_verify.failed++;
+        g_verify.bad_pixels += mismatches;
+    }
+    pthread_mutex_unlock(&g_verify.lock);
+}
+
+static void *verify_thread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&g_verify.lock);
+    while (1) {
+        while (!g_verify.pending && !g_verify.quit) {
+            pthread_cond_wait(&g_verify.cond, &g_verify.lock);
+        }
+        if (!g_verify.pending) {
+            break;
+        }
+        VerifyJob job = g_verify.job;
+        pthread_mutex_unlock(&g_verify.lock);
+
+        // A thread principal está parada em coproc_verify_before (se tentar
+        // outra operação), então o barramento e a cópia da mem1 são nossos
+        coproc_read_block(0, ZOOM_HOST_PIXELS, job.kind != VERIFY_MEM1, g_readback);
+        memcpy(g_source, g_verify.mem1, sizeof(g_source));
+
+        pthread_mutex_lock(&g_verify.lock);
+        g_verify.pending = 0;
+        g_verify.busy = 1;
+        pthread_cond_broadcast(&g_verify.cond);
+        pthread_mutex_unlock(&g_verify.lock);
+
+        compare_job(&job);
+
+        pthread_mutex_lock(&g_verify.lock);
+        g_verify.busy = 0;
+        pthread_cond_broadcast(&g_verify.cond);
+    }
+    pthread_mutex_unlock(&g_verify.lock);
+    return NULL;
+}
+
+static void publish_job(VerifyKind kind, const ZoomHostAction *action) {
+    pthread_mutex_lock(&g_verify.lock);
+    g_verify.job.kind = kind;
+    g_verify.job.sequence = ++g_verify.sequence;
+    if (action) {
+        g_verify.job.action = *action;
+    }
+    if (kind == VERIFY_FILTER) {
+        memcpy(g_verify.job.kernel, g_verify.kernel, sizeof(g_verify.job.kernel));
+    }
+    g_verify.pending = 1;
+    pthread_cond_broadcast(&g_verify.cond);
+    pthread_mutex_unlock(&g_verify.lock);
+}
+
+// =================================================================
+// API
+// =================================================================
+int coproc_verify_start(void) {
+    // A cópia inicial da mem1 vem da própria FPGA (imagem de uma execução anterior)
+    coproc_read_block(0, ZOOM_HOST_PIXELS, 0, g_verify.mem1);
+
+    g_verify.quit = 0;
+    if (pthread_create(&g_verify.thread, NULL, verify_thread, NULL) != 0) {
+        perror("Erro ao criar a thread de verificação");
+        return -1;
+    }
+    g_verify.enabled = 1;
+    printf("Verificação ativa: cada operação é conferida com a referência do HPS (SIMD: %s).\n",
+           zoom_host_isa());
+    return 0;
+}
+
+int coproc_verify_stop(void) {
+    if (!g_verify.enabled) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&g_verify.lock);
+    while (g_verify.pending || g_verify.busy) {
+        pthread_cond_wait(&g_verify.cond, &g_verify.lock);
+    }
+    g_verify.quit = 1;
+    pthread_cond_broadcast(&g_verify.cond);
+    pthread_mutex_unlock(&g_verify.lock);
+    pthread_join(g_verify.thread, NULL);
+    g_verify.enabled = 0;
+
+    printf("Verificação: %u operações conferidas, %u com divergência (%llu pixels).\n",
+           g_verify.checked, g_verify.failed, (unsigned long long)g_verify.bad_pixels);
+    return (int)g_verify.failed;
+}
+
+void coproc_verify_before(void) {
+    if (!g_verify.enabled) {
+        return;
+    }
+    pthread_mutex_lock(&g_verify.lock);
+    while (g_verify.pending) {
+        pthread_cond_wait(&g_verify.cond, &g_verify.lock);
+    }
+    pthread_mutex_unlock(&g_verify.lock);
+}
+
+void coproc_verify_after(uint32_t instruction) {
+    if (!g_verify.enabled) {
+        return;
+    }
+
+    if ((instruction & 0x7) == OP_RESET) {
+        g_verify.state_known = 1;
+    }
+    if (!g_verify.state_known) {
+        return; // Sem um RESET não se sabe o nível atual da FPGA
+    }
+
+    ZoomHostAction action = zoom_host_decode(&g_verify.state, instruction);
+    if (action.kind == ZOOM_ACTION_RUN) {
+        publish_job(VERIFY_MEM3, &action);
+        g_verify.mem3_known = 1;
+    } else if (action.kind == ZOOM_ACTION_FILTER) {
+        // A mem3 de antes do filtro é a lida na conferência anterior
+        int source_known = !(action.x_offset & FILTER_FROM_MEM3) || g_verify.mem3_known;
+        if (g_verify.kernel_known && source_known) {
+            publish_job(VERIFY_FILTER, &action);
+        }
+        g_verify.mem3_known = g_verify.kernel_known && source_known;
+    }
+}
+
+void coproc_verify_store(uint32_t address, uint8_t value) {
+    if (g_verify.enabled && address < ZOOM_HOST_PIXELS) {
+        g_verify.mem1[address] = value;
+    }
+}
+
+void coproc_verify_upload_done(void) {
+    if (g_verify.enabled) {
+        publish_job(VERIFY_MEM1, NULL);
+    }
+}
+
+void coproc_verify_filter_kernel(const int8_t *kernel) {
+    if (g_verify.enabled) {
+        memcpy(g_verify.kernel, kernel, sizeof(g_verify.kernel));
+        g_verify.kernel_known = 1;
+    }
+}
+
+void coproc_verify_aborted(void) {
+    g_verify.mem3_known = 0;
+}
+
+void coproc_verify_stats(uint32_t mode, const CoprocStats *stats) {
+    if (!g_verify.enabled || mode != STATS_SCAN_MEM1) {
+        return;
+    }
+
+    CoprocStats expected = { .min = 0xFF };
+    for (int i = 0; i < ZOOM_HOST_PIXELS; i++) {
+        uint8_t value = g_verify.mem1[i];
+        expected.histogram[value]++;
+        expected.sum += value;
+        if (value < expected.min) expected.min = value;
+        if (value > expected.max) expected.max = value;
+    }
+    expected.count = ZOOM_HOST_PIXELS;
+
+    uint32_t mismatches = 0;
+    int first = -1;
+    for (int i = 0; i < STATS_BINS; i++) {
+        if (stats->histogram[i] != expected.histogram[i]) {
+            if (first < 0) {
+                first = i;
+            }
+            mismatches++;
+        }
+    }
+    if (mismatches) {
+        printf("[verifica] histograma da mem1: %u valores divergentes; primeiro %d: lido %u, esperado %u\n",
+               mismatches, first, stats->histogram[first], expected.histogram[first]);
+    }
+    if (stats->count != expected.count || stats->sum != expected.sum ||
+        stats->min != expected.min || stats->max != expected.max) {
+        printf("[verifica] estatísticas da mem1: lido %u pixels, soma %u, %u..%u; esperado %u, %u, %u..%u\n",
+               stats->count, stats->sum, stats->min, stats->max,
+               expected.count, expected.sum, expected.min, expected.max);
+        mismatches++;
+    }
+    fflush(stdout);
+
+    pthread_mutex_lock(&g_verify.lock);
+    g_verify.checked++;
+    if (mismatches) {
+        g_verify.failed++;
+    }
+    pthread_mutex_unlock(&g_verify.lock);
+}
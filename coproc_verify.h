@@ -0,0 +1,49 @@
+#ifndef COPROC_VERIFY_H
+#define COPROC_VERIFY_H
+
+/*
+ * =================================================================
+ * Verificação contínua do coprocessador (golden image)
+ * =================================================================
+ * Com o modo ativo (menu -v), cada operação enviada à FPGA é conferida
+ * com a implementação de referência do HPS (zoom_host.c):
+ *
+ *   - zoom in/out e pan: a mem3 é lida de volta (LOAD com SEL_MEM = 1)
+ *     e comparada com zoom_host_run sobre a cópia da mem1;
+ *   - envio de imagem: a mem1 é lida de volta e comparada com os
+ *     pixels enviados;
+ *   - filtro 3x3: a mem3 é lida de volta e comparada com
+ *     filter_host_run sobre a cópia da mem1 ou sobre a mem3 lida na
+ *     conferência anterior. Se a mem3 não é conhecida (ex.: depois de
+ *     um pan interrompido), o filtro sobre ela não é conferido;
+ *   - histograma da mem1 (STATS_SCAN_MEM1): contadores, mínimo, máximo
+ *     e soma lidos são comparados, na própria thread principal, com os
+ *     da cópia da mem1. A varredura da mem3 não é conferida.
+ *
+ * A leitura e a comparação rodam numa segunda thread, depois que o
+ * resultado já está na tela. Como a leitura usa o barramento, a operação
+ * seguinte espera apenas o fim da leitura (coproc_verify_before), nunca
+ * a comparação. Cada divergência é relatada com o primeiro pixel
+ * diferente e o total de pixels divergentes.
+ *
+ * A memória de exibição (mem2) não é legível pelo HPS; as operações que
+ * só copiam a mem1 para a tela (RESET, 1/2 <-> 2x) não são conferidas.
+ * Sem coproc_verify_start, as demais funções não fazem nada.
+ */
+
+#include <stdint.h>
+
+#include "api_fpga.h"
+
+int  coproc_verify_start(void);
+int  coproc_verify_stop(void); // Retorna o nº de operações com divergência
+
+void coproc_verify_before(void);                           // Antes de enviar uma operação
+void coproc_verify_after(uint32_t instruction);            // Depois do coproc_wait_done
+void coproc_verify_store(uint32_t address, uint8_t value); // Pixel enviado à mem1
+void coproc_verify_upload_done(void);                      // Fim do envio da imagem
+void coproc_verify_filter_kernel(const int8_t *kernel);    // Coeficientes enviados (coproc_filter_load)
+void coproc_verify_aborted(void);                          // Operação interrompida (mem3 pela metade)
+void coproc_verify_stats(uint32_t mode, const CoprocStats *stats); // Resultado do coproc_stats_read
+
+#endif // COPROC_VERIFY_H
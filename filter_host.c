@@ -0,0 +1,67 @@
+/*
+ * =================================================================
+ * filter_host.c
+ * =================================================================
+ * Implementação do filtro descrito em filter_host.h.
+ *
+ * As bordas são tratadas na escolha das linhas (uma vez por linha) e
+ * colunas (uma vez por pixel) da janela; o laço interno só soma os
+ * nove produtos.
+ */
+
+#include <string.h>
+
+#include "filter_host.h"
+
+#define W FILTER_HOST_WIDTH
+#define H FILTER_HOST_HEIGHT
+
+static const FilterHostPreset g_presets[] = {
+    // Média ponderada (soma 16)
+    { "blur",    {  1,  2,  1,  2,  4,  2,  1,  2,  1 }, 0,          4 },
+    // Centro reforçado (soma 1)
+    { "sharpen", {  0, -1,  0, -1,  5, -1,  0, -1,  0 }, 0,          0 },
+    // Laplaciano: |soma| realça as bordas nos dois sentidos
+    { "edge",    {  0, -1,  0, -1,  4, -1,  0, -1,  0 }, FILTER_ABS, 0 },
+};
+
+void filter_host_run(uint8_t *dst, const uint8_t *src, const int8_t *kernel, uint32_t flags, uint32_t shift) {
+    shift &= FILTER_SHIFT_MASK;
+
+    for (int y = 0; y < H; y++) {
+        const uint8_t *rows[3] = {
+            src + (y == 0 ? 0 : y - 1) * W,
+            src + y * W,
+            src + (y == H - 1 ? H - 1 : y + 1) * W,
+        };
+        for (int x = 0; x < W; x++) {
+            int cols[3] = { x == 0 ? 0 : x - 1, x, x == W - 1 ? W - 1 : x + 1 };
+            int32_t sum = 0;
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) {
+                    sum += kernel[r * 3 + c] * rows[r][cols[c]];
+                }
+            }
+            sum >>= shift; // Aritmético no gcc, como o >>> do main.v
+            if ((flags & FILTER_ABS) && sum < 0) {
+                sum = -sum;
+            }
+            dst[y * W + x] = (uint8_t)(sum < 0 ? 0 : sum > 255 ? 255 : sum);
+        }
+    }
+}
+
+#define NUM_PRESETS (sizeof(g_presets) / sizeof(g_presets[0]))
+
+const FilterHostPreset *filter_host_preset(const char *name) {
+    for (uint32_t i = 0; i < NUM_PRESETS; i++) {
+        if (strcmp(g_presets[i].name, name) == 0) {
+            return &g_presets[i];
+        }
+    }
+    return NULL;
+}
+
+const FilterHostPreset *filter_host_preset_at(uint32_t index) {
+    return (index < NUM_PRESETS) ? &g_presets[index] : NULL;
+}
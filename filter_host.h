@@ -0,0 +1,38 @@
+#ifndef FILTER_HOST_H
+#define FILTER_HOST_H
+
+/*
+ * =================================================================
+ * Filtro 3x3 no HPS (referência do estado FILTER do main.v)
+ * =================================================================
+ * Mesma conta do coprocessador: janela 3x3 com as bordas repetidas,
+ * soma dos produtos pelos coeficientes (int8, ordem de varredura),
+ * deslocada de shift bits à direita (aritmético), |soma| com
+ * FILTER_ABS e saturada em 0..255. src faz o papel da fonte (mem1 ou
+ * mem3) e dst o da mem3; devem ser buffers diferentes de
+ * FILTER_HOST_PIXELS bytes.
+ */
+
+#include <stdint.h>
+
+#include "constantes.h" // FILTER_TAPS, FILTER_ABS
+
+#define FILTER_HOST_WIDTH  320
+#define FILTER_HOST_HEIGHT 240
+#define FILTER_HOST_PIXELS (FILTER_HOST_WIDTH * FILTER_HOST_HEIGHT)
+
+void filter_host_run(uint8_t *dst, const uint8_t *src, const int8_t *kernel, uint32_t flags, uint32_t shift);
+
+// Filtros prontos para o menu
+typedef struct {
+    const char *name;
+    int8_t      kernel[FILTER_TAPS];
+    uint32_t    flags; // FILTER_ABS
+    uint32_t    shift;
+} FilterHostPreset;
+
+// NULL se o nome/índice não existir
+const FilterHostPreset *filter_host_preset(const char *name);
+const FilterHostPreset *filter_host_preset_at(uint32_t index);
+
+#endif // FILTER_HOST_H
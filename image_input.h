@@ -0,0 +1,79 @@
+#ifndef IMAGE_INPUT_H
+#define IMAGE_INPUT_H
+
+/*
+ * =================================================================
+ * Leitura de imagens para a mem1 (cinza de 8 bits ou cor)
+ * =================================================================
+ * Formatos aceitos, detectados pelo conteúdo do arquivo:
+ *
+ *   BMP 8 bits  : índice da paleta (convertido pela luminância da
+ *                 paleta quando ela não é a escala de cinza)
+ *   BMP 24/32   : BGR / BGRA sem compressão (32 bits também com
+ *                 BI_BITFIELDS nas máscaras padrão)
+ *   PGM binário : "P5", valor máximo até 255 (reescalado para 0-255)
+ *   Y8 bruto    : extensão .y8, .raw ou .gray; 320 pixels por linha,
+ *                 altura = tamanho / 320
+ *
+ * A imagem é lida uma linha por vez (image_next_row) e convertida para
+ * cinza direto no buffer de destino (image_convert), sem cópia
+ * intermediária da imagem inteira. A cor vira cinza pelos pesos
+ * BT.601 em ponto fixo, Y = (77 R + 150 G + 29 B + 128) >> 8, com NEON
+ * no Cortex-A9 (SSE2 no PC; ver SIMD_CFLAGS no Makefile).
+ *
+ * Com channels = 3 (quadros em PIXEL_RGB332), image_convert entrega
+ * B, G, R por pixel, na ordem do BMP; fontes em cinza repetem o valor
+ * nos três canais e o BMP de 8 bits usa a cor da paleta.
+ * image_pack_rgb332 empacota o resultado em RRRGGGBB (bits altos de
+ * cada canal), também com NEON/SSE2.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+typedef enum {
+    IMAGE_BMP,
+    IMAGE_PGM,
+    IMAGE_Y8
+} ImageFormat;
+
+typedef struct {
+    FILE       *file;
+    ImageFormat format;
+    int         width;
+    int         height;
+    int         bits;      // Bits por pixel no arquivo (8, 24 ou 32)
+    int         top_down;  // Primeira linha do arquivo é a de cima
+    size_t      row_bytes; // Linha no arquivo, com o preenchimento
+    uint8_t    *raw;       // Linha atual, como está no arquivo
+    int         file_row;  // Linhas já lidas do arquivo
+    int         use_lut;   // Valor de 8 bits passa por lut (paleta, PGM)
+    uint8_t     lut[256];
+    uint8_t     palette[256][3]; // Valor de 8 bits -> B, G, R (channels = 3)
+    int         channels;  // Saída de image_convert: 1 (cinza, padrão) ou 3 (BGR)
+} ImageInput;
+
+// Abre e valida o arquivo (mensagens de erro no stdout); 0 ou -1
+int  image_open(ImageInput *img, const char *filename);
+void image_close(ImageInput *img);
+
+// Lê a próxima linha do arquivo: 1 e *y (linha na imagem), 0 no fim, -1 em erro.
+// Arquivo truncado: o que falta é lido como zero.
+int  image_next_row(ImageInput *img, int *y);
+
+// Converte os pixels [x, x + count) da linha atual para img->channels
+// bytes por pixel em out
+void image_convert(const ImageInput *img, int x, int count, uint8_t *out);
+
+// Luminância de count pixels BGR (bytes_per_pixel = 3) ou BGRA (4)
+void image_luma(const uint8_t *bgr, uint8_t *gray, int count, int bytes_per_pixel);
+void image_luma_scalar(const uint8_t *bgr, uint8_t *gray, int count, int bytes_per_pixel);
+
+// RGB332 de count pixels BGR (3 bytes)
+void image_pack_rgb332(const uint8_t *bgr, uint8_t *rgb332, int count);
+void image_pack_rgb332_scalar(const uint8_t *bgr, uint8_t *rgb332, int count);
+
+// Conjunto de instruções usado por image_luma e image_pack_rgb332 ("neon", "sse2" ou "escalar")
+const char *image_isa(void);
+
+#endif // IMAGE_INPUT_H
@@ -0,0 +1,367 @@
+/*
+ * =================================================================
+ * image_resize.c
+ * =================================================================
+ * Implementação do redimensionamento descrito em image_resize.h.
+ *
+ * Cada pixel (ou linha) do retângulo de destino i tem uma lista de
+ * pesos sobre pixels de origem consecutivos, calculada uma vez por
+ * imagem, com f = pixels de origem por pixel de destino:
+ *
+ *   f > 1 (redução): o pixel i cobre a origem [s0 + i f, s0 + (i+1) f);
+ *                    cada pixel de origem pesa a fração coberta / f
+ *   f <= 1 (ampliação): bilinear entre os dois vizinhos do centro
+ *                    c = s0 + (i + 0.5) f - 0.5
+ *
+ * Os pesos são inteiros de 15 bits que somam 32768 (a sobra do
+ * arredondamento vai para o maior peso), então o resultado é
+ * (soma + 16384) >> 15, sempre entre 0 e 255.
+ *
+ * Passada vertical vetorizada, 16 pixels por iteração com os acumuladores
+ * de 32 bits em registradores:
+ *   NEON: vmovl_u8 + vmlal_n_u16, vrshrn_n_u32(15) e vqmovn_u16
+ *   SSE2: produto de 32 bits montado com _mm_mullo_epi16/_mm_mulhi_epu16
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "image_resize.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define WEIGHT_BITS 15
+#define WEIGHT_ONE  (1 << WEIGHT_BITS)
+
+// =================================================================
+// Tabelas de pesos
+// =================================================================
+// Preenche taps[0..dn) para dn pixels de destino sobre [s0, s0 + sw) de
+// uma origem com n pixels. Retorna o maior nº de pesos de um pixel.
+static int build_taps(ResizeTaps *taps, uint16_t *pool, int max_taps,
+                      int dn, int n, double s0, double sw) {
+    double f = sw / dn;
+    double w[64];
+    int widest = 1;
+
+    for (int i = 0; i < dn; i++) {
+        int first, count;
+
+        if (f > 1.0) {
+            double a = s0 + i * f, b = a + f;
+            first = (int)floor(a);
+            count = (int)ceil(b) - first;
+            for (int k = 0; k < count; k++) {
+                double lo = (first + k > a) ? first + k : a;
+                double hi = (first + k + 1 < b) ? first + k + 1 : b;
+                w[k] = (hi - lo) / f;
+            }
+        } else {
+            double c = s0 + (i + 0.5) * f - 0.5;
+            if (c < 0) {
+                c = 0;
+            }
+            if (c > n - 1) {
+                c = n - 1;
+            }
+            first = (int)floor(c);
+            w[0] = 1.0 - (c - first);
+            w[1] = c - first;
+            count = (first + 1 < n) ? 2 : 1;
+        }
+
+        // Limita à origem (erros de ponto flutuante nas bordas)
+        while (count > 1 && first < 0) {
+            w[1] += w[0];
+            memmove(w, w + 1, --count * sizeof(double));
+            first++;
+        }
+        while (count > 1 && first + count > n) {
+            w[count - 2] += w[count - 1];
+            count--;
+        }
+        if (count > max_taps) {
+            count = max_taps;
+        }
+
+        // Quantiza para WEIGHT_BITS, com soma exata
+        uint16_t *q = pool + (size_t)i * max_taps;
+        int sum = 0, largest = 0;
+        for (int k = 0; k < count; k++) {
+            q[k] = (uint16_t)lround(w[k] * WEIGHT_ONE);
+            sum += q[k];
+            if (q[k] > q[largest]) {
+                largest = k;
+            }
+        }
+        q[largest] = (uint16_t)(q[largest] + WEIGHT_ONE - sum);
+
+        // Descarta pesos nulos nas pontas
+        while (count > 1 && q[0] == 0) {
+            q++;
+            first++;
+            count--;
+        }
+        while (count > 1 && q[count - 1] == 0) {
+            count--;
+        }
+
+        taps[i].first = first;
+        taps[i].count = count;
+        taps[i].weights = q;
+        if (count > widest) {
+            widest = count;
+        }
+    }
+    return widest;
+}
+
+// =================================================================
+// Passadas do filtro
+// =================================================================
+static void vertical_pass(const uint8_t *const *rows, const uint16_t *weights, int taps,
+                          uint8_t *dst, int width) {
+    int x = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; x + 16 <= width; x += 16) {
+        uint32x4_t a0 = vdupq_n_u32(0), a1 = a0, a2 = a0, a3 = a0;
+        for (int t = 0; t < taps; t++) {
+            uint8x16_t p = vld1q_u8(rows[t] + x);
+            uint16x8_t lo = vmovl_u8(vget_low_u8(p));
+            uint16x8_t hi = vmovl_u8(vget_high_u8(p));
+            a0 = vmlal_n_u16(a0, vget_low_u16(lo), weights[t]);
+            a1 = vmlal_n_u16(a1, vget_high_u16(lo), weights[t]);
+            a2 = vmlal_n_u16(a2, vget_low_u16(hi), weights[t]);
+            a3 = vmlal_n_u16(a3, vget_high_u16(hi), weights[t]);
+        }
+        uint16x8_t r0 = vcombine_u16(vrshrn_n_u32(a0, WEIGHT_BITS), vrshrn_n_u32(a1, WEIGHT_BITS));
+        uint16x8_t r1 = vcombine_u16(vrshrn_n_u32(a2, WEIGHT_BITS), vrshrn_n_u32(a3, WEIGHT_BITS));
+        vst1q_u8(dst + x, vcombine_u8(vqmovn_u16(r0), vqmovn_u16(r1)));
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(WEIGHT_ONE / 2);
+    for (; x + 16 <= width; x += 16) {
+        __m128i a0 = zero, a1 = zero, a2 = zero, a3 = zero;
+        for (int t = 0; t < taps; t++) {
+            __m128i p = _mm_loadu_si128((const __m128i *)(rows[t] + x));
+            __m128i w = _mm_set1_epi16((short)weights[t]);
+            __m128i lo = _mm_unpacklo_epi8(p, zero);
+            __m128i hi = _mm_unpackhi_epi8(p, zero);
+            __m128i lo_l = _mm_mullo_epi16(lo, w), lo_h = _mm_mulhi_epu16(lo, w);
+            __m128i hi_l = _mm_mullo_epi16(hi, w), hi_h = _mm_mulhi_epu16(hi, w);
+            a0 = _mm_add_epi32(a0, _mm_unpacklo_epi16(lo_l, lo_h));
+            a1 = _mm_add_epi32(a1, _mm_unpackhi_epi16(lo_l, lo_h));
+            a2 = _mm_add_epi32(a2, _mm_unpacklo_epi16(hi_l, hi_h));
+            a3 = _mm_add_epi32(a3, _mm_unpackhi_epi16(hi_l, hi_h));
+        }
+        a0 = _mm_srli_epi32(_mm_add_epi32(a0, half), WEIGHT_BITS);
+        a1 = _mm_srli_epi32(_mm_add_epi32(a1, half), WEIGHT_BITS);
+        a2 = _mm_srli_epi32(_mm_add_epi32(a2, half), WEIGHT_BITS);
+        a3 = _mm_srli_epi32(_mm_add_epi32(a3, half), WEIGHT_BITS);
+        _mm_storeu_si128((__m128i *)(dst + x),
+                         _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3)));
+    }
+#endif
+
+    for (; x < width; x++) {
+        uint32_t acc = 0;
+        for (int t = 0; t < taps; t++) {
+            acc += (uint32_t)rows[t][x] * weights[t];
+        }
+        dst[x] = (uint8_t)((acc + WEIGHT_ONE / 2) >> WEIGHT_BITS);
+    }
+}
+
+// channels bytes por pixel em src e dst, filtrados um a um
+static void horizontal_pass(const uint8_t *src, const ResizeTaps *taps, uint8_t *dst, int width, int channels) {
+    for (int i = 0; i < width; i++) {
+        for (int c = 0; c < channels; c++) {
+            const uint8_t *p = src + taps[i].first * channels + c;
+            uint32_t acc = 0;
+            for (int t = 0; t < taps[i].count; t++) {
+                acc += (uint32_t)p[t * channels] * taps[i].weights[t];
+            }
+            dst[i * channels + c] = (uint8_t)((acc + WEIGHT_ONE / 2) >> WEIGHT_BITS);
+        }
+    }
+}
+
+// =================================================================
+// API
+// =================================================================
+const char *image_resize_mode_name(ResizeMode mode) {
+    return (mode == RESIZE_FILL) ? "fill" : "fit";
+}
+
+int image_resize_init(ImageResizer *rs, ImageInput *image, ResizeMode mode) {
+    int w = image->width, h = image->height;
+    double sx = RESIZE_WIDTH / (double)w, sy = RESIZE_HEIGHT / (double)h;
+    double scale, src_x0, src_y0, src_w, src_h;
+
+    memset(rs, 0, sizeof(*rs));
+    rs->image = image;
+    rs->channels = image->channels;
+
+    if (mode == RESIZE_FILL) {
+        scale = (sx > sy) ? sx : sy;
+        rs->dst_w = RESIZE_WIDTH;
+        rs->dst_h = RESIZE_HEIGHT;
+        src_w = RESIZE_WIDTH / scale;
+        src_h = RESIZE_HEIGHT / scale;
+    } else {
+        scale = (sx < sy) ? sx : sy;
+        rs->dst_w = (int)lround(w * scale);
+        rs->dst_h = (int)lround(h * scale);
+        rs->dst_w = (rs->dst_w < 1) ? 1 : (rs->dst_w > RESIZE_WIDTH) ? RESIZE_WIDTH : rs->dst_w;
+        rs->dst_h = (rs->dst_h < 1) ? 1 : (rs->dst_h > RESIZE_HEIGHT) ? RESIZE_HEIGHT : rs->dst_h;
+        src_w = w;
+        src_h = h;
+    }
+    rs->dst_x = (RESIZE_WIDTH - rs->dst_w) / 2;
+    rs->dst_y = (RESIZE_HEIGHT - rs->dst_h) / 2;
+    src_x0 = (w - src_w) / 2;
+    src_y0 = (h - src_h) / 2;
+
+    if (scale == 1.0) {
+        // Corte em pixels inteiros: cópia direta, sem meio pixel de filtro
+        rs->direct = 1;
+        src_x0 = floor(src_x0);
+        src_y0 = floor(src_y0);
+    }
+
+    int max_x = (int)ceil(src_w / rs->dst_w) + 2;
+    int max_y = (int)ceil(src_h / rs->dst_h) + 2;
+    if (max_x > 64 || max_y > 64) {
+        printf("Erro: Imagem grande demais para reduzir (%dx%d).\n", w, h);
+        return -1;
+    }
+
+    rs->x_taps = malloc(sizeof(ResizeTaps) * rs->dst_w);
+    rs->y_taps = malloc(sizeof(ResizeTaps) * rs->dst_h);
+    rs->weights = malloc(sizeof(uint16_t) * ((size_t)rs->dst_w * max_x + (size_t)rs->dst_h * max_y));
+    if (!rs->x_taps || !rs->y_taps || !rs->weights) {
+        perror("Erro ao alocar as tabelas de redimensionamento");
+        image_resize_free(rs);
+        return -1;
+    }
+
+    build_taps(rs->x_taps, rs->weights, max_x, rs->dst_w, w, src_x0, src_w);
+    rs->window_rows = build_taps(rs->y_taps, rs->weights + (size_t)rs->dst_w * max_x, max_y,
+                                 rs->dst_h, h, src_y0, src_h);
+
+    // Só as colunas usadas são convertidas e filtradas
+    int end = 0;
+    rs->src_x = w;
+    for (int i = 0; i < rs->dst_w; i++) {
+        if (rs->x_taps[i].first < rs->src_x) {
+            rs->src_x = rs->x_taps[i].first;
+        }
+        if (rs->x_taps[i].first + rs->x_taps[i].count > end) {
+            end = rs->x_taps[i].first + rs->x_taps[i].count;
+        }
+    }
+    rs->src_w = end - rs->src_x;
+    for (int i = 0; i < rs->dst_w; i++) {
+        rs->x_taps[i].first -= rs->src_x;
+    }
+
+    rs->window = malloc((size_t)rs->window_rows * rs->src_w * rs->channels);
+    rs->column = malloc((size_t)rs->src_w * rs->channels);
+    rs->bgr = (rs->channels == 3) ? malloc((size_t)rs->dst_w * 3) : NULL;
+    if (!rs->window || !rs->column || (rs->channels == 3 && !rs->bgr)) {
+        perror("Erro ao alocar a janela de redimensionamento");
+        image_resize_free(rs);
+        return -1;
+    }
+
+    rs->last_y = -1;
+    rs->next_out = image->top_down ? 0 : rs->dst_h - 1;
+    return 0;
+}
+
+void image_resize_free(ImageResizer *rs) {
+    free(rs->x_taps);
+    free(rs->y_taps);
+    free(rs->weights);
+    free(rs->window);
+    free(rs->column);
+    free(rs->bgr);
+    rs->x_taps = rs->y_taps = NULL;
+    rs->weights = NULL;
+    rs->window = rs->column = rs->bgr = NULL;
+}
+
+// A janela da linha j do retângulo já foi lida?
+static int output_ready(const ImageResizer *rs, int j) {
+    const ResizeTaps *t = &rs->y_taps[j];
+    if (rs->last_y < 0) {
+        return 0;
+    }
+    return rs->image->top_down ? rs->last_y >= t->first + t->count - 1 : rs->last_y <= t->first;
+}
+
+static void emit_output(ImageResizer *rs, int j, uint8_t *row) {
+    const ResizeTaps *t = &rs->y_taps[j];
+    const uint8_t *rows[64];
+    int ch = rs->channels;
+    uint8_t *dst = (ch == 3) ? rs->bgr : row + rs->dst_x;
+
+    for (int k = 0; k < t->count; k++) {
+        rows[k] = rs->window + (size_t)((t->first + k) % rs->window_rows) * rs->src_w * ch;
+    }
+
+    memset(row, 0, RESIZE_WIDTH);
+    if (rs->direct) {
+        memcpy(dst, rows[0] + rs->x_taps[0].first * ch, (size_t)rs->dst_w * ch);
+    } else {
+        vertical_pass(rows, t->weights, t->count, rs->column, rs->src_w * ch);
+        horizontal_pass(rs->column, rs->x_taps, dst, rs->dst_w, ch);
+    }
+    if (ch == 3) {
+        image_pack_rgb332(rs->bgr, row + rs->dst_x, rs->dst_w);
+    }
+}
+
+int image_resize_next(ImageResizer *rs, uint8_t *row, int *y) {
+    // Faixas pretas primeiro, para nenhuma linha do quadro ficar com a imagem anterior
+    while (rs->bar_row < RESIZE_HEIGHT) {
+        int bar = rs->bar_row++;
+        if (bar < rs->dst_y || bar >= rs->dst_y + rs->dst_h) {
+            memset(row, 0, RESIZE_WIDTH);
+            *y = bar;
+            return 1;
+        }
+    }
+
+    while (rs->emitted < rs->dst_h) {
+        if (output_ready(rs, rs->next_out)) {
+            int j = rs->next_out;
+            emit_output(rs, j, row);
+            rs->next_out += rs->image->top_down ? 1 : -1;
+            rs->emitted++;
+            *y = rs->dst_y + j;
+            return 1;
+        }
+
+        int src_y;
+        int status = image_next_row(rs->image, &src_y);
+        if (status <= 0) {
+            return status;
+        }
+        const ResizeTaps *top = &rs->y_taps[0], *bottom = &rs->y_taps[rs->dst_h - 1];
+        if (src_y >= top->first && src_y < bottom->first + bottom->count) { // Fora do corte: só pula
+            uint8_t *slot = rs->window + (size_t)(src_y % rs->window_rows) * rs->src_w * rs->channels;
+            image_convert(rs->image, rs->src_x, rs->src_w, slot);
+        }
+        rs->last_y = src_y;
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef IMAGE_RESIZE_H
+#define IMAGE_RESIZE_H
+
+/*
+ * =================================================================
+ * Redimensionamento da imagem para o quadro de 320x240 (no HPS)
+ * =================================================================
+ * Ajusta uma imagem de qualquer tamanho (image_input.h) ao quadro da
+ * mem1, mantendo a proporção:
+ *
+ *   RESIZE_FIT : a imagem inteira cabe no quadro; as faixas que sobram
+ *                (em cima/embaixo ou dos lados) ficam pretas
+ *   RESIZE_FILL: a imagem cobre o quadro inteiro; o excesso é cortado
+ *                igualmente dos dois lados
+ *
+ * Filtro separável: média por área (cobertura fracionária) para
+ * reduzir e bilinear para ampliar, com pesos de 15 bits que somam
+ * exatamente 1. A passada vertical é vetorizada (NEON/SSE2) e roda
+ * primeiro, sobre as linhas originais; a horizontal roda sobre o
+ * resultado, já com 240 linhas no máximo. Com escala 1 a linha é
+ * copiada sem filtro (uma imagem de 320x240 chega intacta à mem1).
+ *
+ * Com image->channels = 3 as passadas filtram B, G e R entrelaçados
+ * (a vertical não distingue canais; a horizontal anda de 3 em 3) e a
+ * linha do quadro sai empacotada em RGB332 (image_pack_rgb332).
+ *
+ * A leitura é feita em fluxo: só as linhas da janela vertical ficam na
+ * memória (no máximo ~fator de redução + 1 linhas da imagem original),
+ * e cada linha do quadro sai assim que a janela dela está completa.
+ */
+
+#include <stdint.h>
+
+#include "image_input.h"
+
+#define RESIZE_WIDTH  320
+#define RESIZE_HEIGHT 240
+
+typedef enum {
+    RESIZE_FIT,
+    RESIZE_FILL
+} ResizeMode;
+
+typedef struct {
+    int       first; // Primeiro pixel/linha de origem
+    int       count; // Nº de pesos
+    uint16_t *weights;
+} ResizeTaps;
+
+typedef struct {
+    ImageInput *image;
+    int         direct;     // Escala 1: sem filtro
+    int         dst_x, dst_y, dst_w, dst_h; // Retângulo ocupado no quadro
+    int         src_x;      // Primeira coluna de origem usada
+    int         src_w;      // Colunas de origem usadas
+    ResizeTaps *x_taps;     // Por coluna do retângulo
+    ResizeTaps *y_taps;     // Por linha do retângulo
+    uint16_t   *weights;    // Pesos das duas tabelas
+
+    int         channels;   // Bytes por pixel na janela (image->channels)
+    uint8_t    *window;     // Janela vertical: window_rows linhas de src_w pixels
+    int         window_rows;
+    uint8_t    *column;     // Resultado da passada vertical (src_w pixels)
+    uint8_t    *bgr;        // Linha filtrada em cor, antes do RGB332 (dst_w pixels)
+    int         last_y;     // Última linha de origem lida (-1: nenhuma)
+    int         next_out;   // Próxima linha do retângulo (na ordem de leitura)
+    int         emitted;    // Linhas do retângulo já entregues
+    int         bar_row;    // Próxima linha de faixa preta a entregar
+} ImageResizer;
+
+int  image_resize_init(ImageResizer *rs, ImageInput *image, ResizeMode mode);
+void image_resize_free(ImageResizer *rs);
+
+// Próxima linha do quadro (RESIZE_WIDTH bytes em row, linha em *y):
+// 1, 0 no fim, -1 em erro de leitura. As linhas saem na ordem em que o
+// arquivo é lido, não necessariamente de cima para baixo.
+int  image_resize_next(ImageResizer *rs, uint8_t *row, int *y);
+
+const char *image_resize_mode_name(ResizeMode mode);
+
+#endif // IMAGE_RESIZE_H
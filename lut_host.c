@@ -0,0 +1,77 @@
+/*
+ * =================================================================
+ * lut_host.c
+ * =================================================================
+ * Implementação das tabelas descritas em lut_host.h.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "lut_host.h"
+
+void lut_host_invert(LutHostTables *lut) {
+    for (uint32_t i = 0; i < LUT_ENTRIES; i++) {
+        lut->red[i] = (uint8_t)(255 - i);
+    }
+    lut->color = 0;
+}
+
+void lut_host_gamma(LutHostTables *lut, double gamma) {
+    for (uint32_t i = 0; i < LUT_ENTRIES; i++) {
+        lut->red[i] = (uint8_t)lround(255.0 * pow(i / 255.0, 1.0 / gamma));
+    }
+    lut->color = 0;
+}
+
+void lut_host_stretch(LutHostTables *lut, uint32_t low, uint32_t high) {
+    uint32_t range = high - low;
+
+    for (uint32_t i = 0; i < LUT_ENTRIES; i++) {
+        if (i <= low) {
+            lut->red[i] = 0;
+        } else if (i >= high) {
+            lut->red[i] = 255;
+        } else {
+            lut->red[i] = (uint8_t)(((i - low) * 255 + range / 2) / range);
+        }
+    }
+    lut->color = 0;
+}
+
+void lut_host_heat(LutHostTables *lut) {
+    // Três rampas de 85 níveis (0..84, 85..169, 170..255)
+    for (uint32_t i = 0; i < LUT_ENTRIES; i++) {
+        uint32_t r = (i < 85) ? i * 3 : 255;
+        uint32_t g = (i < 85) ? 0 : (i < 170) ? (i - 85) * 3 : 255;
+        uint32_t b = (i < 170) ? 0 : (i - 170) * 3;
+        lut->red[i]   = (uint8_t)r;
+        lut->green[i] = (uint8_t)g;
+        lut->blue[i]  = (uint8_t)b;
+    }
+    lut->color = 1;
+}
+
+// Canais de 3 e 2 bits para 8 bits, repetindo os bits (data_to_vga_pipe do main.v)
+static inline uint32_t expand3(uint32_t v) { return (v << 5) | (v << 2) | (v >> 1); }
+static inline uint32_t expand2(uint32_t v) { return v * 0x55; }
+
+void lut_host_rgb332(LutHostTables *lut) {
+    LutHostTables in;
+
+    memcpy(&in, lut, sizeof(in));
+    for (uint32_t i = 0; i < LUT_ENTRIES; i++) {
+        uint32_t r = expand3(i >> 5), g = expand3((i >> 2) & 7), b = expand2(i & 3);
+        if (in.color) {
+            uint32_t y = (77 * r + 150 * g + 29 * b + 128) >> 8; // BT.601, como image_luma
+            lut->red[i]   = in.red[y];
+            lut->green[i] = in.green[y];
+            lut->blue[i]  = in.blue[y];
+        } else {
+            lut->red[i]   = in.red[r];
+            lut->green[i] = in.red[g];
+            lut->blue[i]  = in.red[b];
+        }
+    }
+    lut->color = 1;
+}
@@ -0,0 +1,38 @@
+#ifndef LUT_HOST_H
+#define LUT_HOST_H
+
+/*
+ * =================================================================
+ * Tabelas da LUT de exibição (CTRL_LUT)
+ * =================================================================
+ * Operações pontuais sobre o cinza da tela, montadas no HPS e
+ * carregadas com coproc_load_lut: LUT_ENTRIES bytes por canal, em vez
+ * de reenviar a imagem. Só a falsa cor usa uma tabela por canal; as
+ * demais vão iguais aos três (LUT_GRAY).
+ */
+
+#include <stdint.h>
+
+#include "constantes.h" // LUT_ENTRIES
+
+typedef struct {
+    uint8_t red[LUT_ENTRIES];
+    uint8_t green[LUT_ENTRIES];
+    uint8_t blue[LUT_ENTRIES];
+    int     color; // 0: red vale para os três canais
+} LutHostTables;
+
+void lut_host_invert(LutHostTables *lut);
+// out = 255 * (in / 255)^(1 / gamma); gamma > 1 clareia os tons escuros
+void lut_host_gamma(LutHostTables *lut, double gamma);
+// [low, high] -> [0, 255], saturando fora da faixa (high > low)
+void lut_host_stretch(LutHostTables *lut, uint32_t low, uint32_t high);
+// Falsa cor: preto -> vermelho -> amarelo -> branco
+void lut_host_heat(LutHostTables *lut);
+
+// Em PIXEL_RGB332 o índice da LUT é o byte RRRGGGBB. Reescreve lut (feita
+// para o cinza) em três tabelas sobre a cor expandida como no VGA: as
+// curvas em cinza valem para cada canal; a falsa cor, para a luminância.
+void lut_host_rgb332(LutHostTables *lut);
+
+#endif // LUT_HOST_H
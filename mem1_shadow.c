@@ -0,0 +1,131 @@
+/*
+ * =================================================================
+ * mem1_shadow.c
+ * =================================================================
+ * Implementação da cópia da mem1 descrita em mem1_shadow.h.
+ *
+ * A cópia é conhecida por linha: uma linha só passa a ser comparada
+ * depois de ter sido enviada inteira ao menos uma vez. Linhas iguais
+ * saem com um memcmp; nas demais, cada intervalo diferente vira um
+ * retângulo de altura 1.
+ *
+ * Dentro do retângulo, o intervalo é codificado em corridas: trechos
+ * de pelo menos MEM1_SHADOW_MIN_RUN pixels iguais saem numa única
+ * instrução EXT_RECT_RUN, e o resto em pacotes de 3 (OP_RECT_DATA).
+ * Como um pacote incompleto ocuparia posições do retângulo, cada
+ * trecho literal antes de uma corrida é completado até múltiplo de 3
+ * com os primeiros pixels da própria corrida.
+ */
+
+#include <string.h>
+
+#include "api_fpga.h"
+#include "constantes.h"
+#include "mem1_shadow.h"
+
+#define W      320
+#define H      240
+#define PIXELS (W * H)
+
+static uint8_t g_shadow[PIXELS];
+static uint8_t g_row_known[H]; // Linha da cópia igual à mem1
+static uint32_t g_instructions;
+
+uint32_t mem1_shadow_instructions(void) {
+    return g_instructions;
+}
+
+void mem1_shadow_invalidate(void) {
+    memset(g_row_known, 0, sizeof(g_row_known));
+}
+
+static void send_literal(const uint8_t *pixels, uint32_t count) {
+    if (count > 0) {
+        coproc_rect_data(pixels, count);
+        g_instructions += (count + RECT_PIXELS_PER_BEAT - 1) / RECT_PIXELS_PER_BEAT;
+    }
+}
+
+static void send_span(uint32_t x, uint32_t y, const uint8_t *pixels, uint32_t count) {
+    uint32_t literal = 0, i = 0;
+
+    coproc_rect_begin(x, y, count, 1);
+    g_instructions += 2;
+
+    while (i < count) {
+        uint32_t j = i + 1;
+        while (j < count && pixels[j] == pixels[i]) {
+            j++;
+        }
+
+        // Completa o trecho literal até múltiplo de 3 com o início da corrida
+        uint32_t pad = (RECT_PIXELS_PER_BEAT - (i - literal) % RECT_PIXELS_PER_BEAT) % RECT_PIXELS_PER_BEAT;
+        if (j - i >= pad + MEM1_SHADOW_MIN_RUN) {
+            send_literal(pixels + literal, i + pad - literal);
+            coproc_rect_run(pixels[i], j - i - pad);
+            g_instructions++;
+            literal = j;
+        }
+        i = j;
+    }
+    send_literal(pixels + literal, count - literal);
+
+    memcpy(g_shadow + y * W + x, pixels, count);
+}
+
+// Trecho de uma única linha
+static uint32_t write_row(uint32_t x, uint32_t y, const uint8_t *pixels, uint32_t count) {
+    const uint8_t *shadow = g_shadow + y * W + x;
+
+    if (!g_row_known[y]) {
+        send_span(x, y, pixels, count);
+        g_row_known[y] = (count == W);
+        return count;
+    }
+    if (memcmp(shadow, pixels, count) == 0) {
+        return 0;
+    }
+
+    uint32_t sent = 0, i = 0;
+    while (i < count) {
+        while (i < count && shadow[i] == pixels[i]) {
+            i++;
+        }
+        if (i == count) {
+            break;
+        }
+
+        // Estende o intervalo enquanto o próximo pixel diferente estiver perto
+        uint32_t start = i, last = i;
+        for (i++; i < count && i - last <= MEM1_SHADOW_MERGE_GAP; i++) {
+            if (shadow[i] != pixels[i]) {
+                last = i;
+            }
+        }
+        send_span(x + start, y, pixels + start, last - start + 1);
+        sent += last - start + 1;
+        i = last + 1;
+    }
+    return sent;
+}
+
+uint32_t mem1_shadow_write(uint32_t address, const uint8_t *pixels, uint32_t count) {
+    uint32_t sent = 0;
+
+    if (address >= PIXELS) {
+        return 0;
+    }
+    if (count > PIXELS - address) {
+        count = PIXELS - address;
+    }
+
+    while (count > 0) {
+        uint32_t x = address % W, y = address / W;
+        uint32_t n = (count < W - x) ? count : W - x;
+        sent += write_row(x, y, pixels, n);
+        address += n;
+        pixels += n;
+        count -= n;
+    }
+    return sent;
+}
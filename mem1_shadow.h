@@ -0,0 +1,37 @@
+#ifndef MEM1_SHADOW_H
+#define MEM1_SHADOW_H
+
+/*
+ * =================================================================
+ * Cópia da mem1 no HPS e envio só do que mudou
+ * =================================================================
+ * Guarda o último conteúdo escrito na mem1 (imagem original) e, a
+ * cada novo trecho, envia apenas os intervalos de pixels diferentes,
+ * cada um como um retângulo de uma linha (coproc_rect_begin +
+ * coproc_rect_data, 3 pixels por instrução). Intervalos separados por
+ * menos de MEM1_SHADOW_MERGE_GAP pixels iguais viram um só, porque
+ * abrir um retângulo custa duas instruções. Trechos de pelo menos
+ * MEM1_SHADOW_MIN_RUN pixels iguais (fundo, faixas pretas) saem numa
+ * única instrução (coproc_rect_run).
+ *
+ * No início (e depois de mem1_shadow_invalidate) o conteúdo da mem1 é
+ * desconhecido: cada linha é enviada inteira na primeira vez. Quem
+ * escrever na mem1 por outro caminho (ex.: coproc_write_pixel) deve
+ * chamar mem1_shadow_invalidate.
+ */
+
+#include <stdint.h>
+
+#define MEM1_SHADOW_MERGE_GAP 6
+#define MEM1_SHADOW_MIN_RUN   4
+
+void mem1_shadow_invalidate(void);
+
+// Escreve count pixels a partir de address (pode atravessar linhas).
+// Retorna o nº de pixels enviados à FPGA.
+uint32_t mem1_shadow_write(uint32_t address, const uint8_t *pixels, uint32_t count);
+
+// Nº acumulado de instruções enviadas à FPGA
+uint32_t mem1_shadow_instructions(void);
+
+#endif // MEM1_SHADOW_H
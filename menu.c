@@ -1,119 +1,526 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime, strtok_r
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <termios.h>
 #include <unistd.h>
 #include <string.h> // Para memset
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
 
 #include "constantes.h" // Inclui os Opcodes
+#include "api_fpga.h"   // Declarações da API (api_fpga.s ou coproc_model.c)
+#include "coproc_async.h" // Envio com ticket (coproc_submit/coproc_poll)
+#include "coproc_trace.h" // Rastreador opcional (make TRACE=1)
+#include "coproc_verify.h" // Modo de verificação (-v)
+#include "upload_pipeline.h" // Leitura || envio da imagem
+#include "image_input.h"     // BMP 8/24/32, PGM e Y8 -> cinza ou RGB332
+#include "image_resize.h"    // Ajuste ao quadro de 320x240
+#include "mem1_shadow.h"     // Cópia da mem1 (contagem de instruções)
+#include "zoom_host.h"       // Decodificação: o que está na tela
+#include "filter_host.h"     // Filtros 3x3 prontos
+#include "lut_host.h"        // Tabelas da LUT de exibição
+
 
 // =================================================================
-// Declarações da API em Assembly (api_fpga.s)
+// Função de Carregamento de Imagem
 // =================================================================
-extern int setup_memory_map(void);
-extern void cleanup_memory_map(void);
-extern void coproc_write_pixel(uint32_t address, uint8_t value);
-extern uint8_t coproc_read_pixel(uint32_t address, uint32_t sel_mem);
-extern void coproc_apply_zoom(uint32_t algorithm_code);
-extern void coproc_reset_image(void);
-extern void coproc_wait_done(void);
-extern void coproc_apply_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset);
-extern void coproc_pan_zoom_with_offset(uint32_t algorithm_code, uint32_t x_offset, uint32_t y_offset);
+// A leitura do arquivo roda numa thread produtora e o envio à FPGA na
+// thread principal (upload_pipeline.c): cada linha lida é convertida
+// para cinza ou cor (image_input.c) e ajustada ao quadro de 320x240
+// (image_resize.c, que empacota a cor em RGB332) enquanto a anterior
+// ainda está sendo enviada.
 
+static ResizeMode g_resize_mode = RESIZE_FIT; // -r fit|fill
+static int g_pyramid = 0; // -z: monta a pirâmide de zoom out após cada carga
+static uint32_t g_pixel_format = PIXEL_GRAY8; // -f gray|rgb332
+#define G_VIEW_NONE 0xFFFFFFFFu
+static uint32_t g_view_seq = G_VIEW_NONE; // Nº de sequência logo após o último zoom/pan/view
+static uint32_t g_view_alg;               // Algoritmo (instrução sem offsets) desse comando
+static void op_finish(void);              // Operações do Coprocessador, abaixo
 
-// =================================================================
-// Estruturas do Bitmap (Sem alterações)
-// =================================================================
-#pragma pack(1)
-typedef struct {
-    uint16_t bfType;
-    uint32_t bfSize;
-    uint16_t bfReserved1;
-    uint16_t bfReserved2;
-    uint32_t bfOffBits;
-} BITMAPFILEHEADER;
+static int parse_pixel_format(const char *text, uint32_t *format) {
+    if (strcmp(text, "gray") == 0) {
+        *format = PIXEL_GRAY8;
+    } else if (strcmp(text, "rgb332") == 0) {
+        *format = PIXEL_RGB332;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_resize_mode(const char *text, ResizeMode *mode) {
+    if (strcmp(text, "fit") == 0) {
+        *mode = RESIZE_FIT;
+    } else if (strcmp(text, "fill") == 0) {
+        *mode = RESIZE_FILL;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int image_produce_row(void *ctx, UploadRow *row) {
+    ImageResizer *resizer = ctx;
+    int y;
+
+    int status = image_resize_next(resizer, row->pixels, &y);
+    if (status <= 0) {
+        return status;
+    }
+    row->address = (uint32_t)y * RESIZE_WIDTH;
+    row->count = RESIZE_WIDTH;
+    row->progress = (uint32_t)((uint64_t)resizer->image->file_row * 100 / resizer->image->height);
+    return 1;
+}
+
+int load_image(char *filename, ResizeMode mode) {
+    TRACE_SPAN_BEGIN("load_image");
+    ImageInput image;
+    ImageResizer resizer;
+    if (image_open(&image, filename) != 0) {
+        TRACE_SPAN_END();
+        return -1;
+    }
+    image.channels = (g_pixel_format == PIXEL_RGB332) ? 3 : 1;
+    if (image_resize_init(&resizer, &image, mode) != 0) {
+        image_close(&image);
+        TRACE_SPAN_END();
+        return -1;
+    }
+    if (!resizer.direct || resizer.dst_w != RESIZE_WIDTH || resizer.dst_h != RESIZE_HEIGHT) {
+        printf("Ajustando ao quadro (%s): %dx%d em (%d, %d).\n", image_resize_mode_name(mode),
+               resizer.dst_w, resizer.dst_h, resizer.dst_x, resizer.dst_y);
+    }
+    
+    printf("Iniciando transferência para a FPGA...\n");
+    op_finish();
+    coproc_verify_before();
+    g_view_seq = G_VIEW_NONE; // A mem1 muda: nenhum comando de zoom é repetido
+
+    uint32_t instructions = mem1_shadow_instructions();
+    long sent = upload_pipeline_run(image_produce_row, &resizer);
+    instructions = mem1_shadow_instructions() - instructions;
+
+    image_resize_free(&resizer);
+    image_close(&image);
+    if (sent < 0) {
+        printf("Transferência interrompida.\n");
+        TRACE_SPAN_END();
+        return -1;
+    }
+    
+    printf("Transferência de imagem concluída (%ld de %d pixels alterados, %u instruções).\n",
+           sent, RESIZE_WIDTH * RESIZE_HEIGHT, (unsigned)instructions);
+    if (g_pyramid) {
+        // Zoom out (BA/NH) a partir de 1x vira cópia da pirâmide na FPGA
+        coproc_pyramid_build();
+        printf("Pirâmide de zoom out (1/2, 1/4, 1/8) montada.\n");
+    }
+    coproc_verify_upload_done();
+    TRACE_SPAN_END();
+    return 0;
+}
 
-typedef struct {
-    uint32_t biSize;
-    int32_t  biWidth;
-    int32_t  biHeight;
-    uint16_t biPlanes;
-    uint16_t biBitCount;
-    uint32_t biCompression;
-    uint32_t biSizeImage;
-    int32_t  biXPelsPerMeter;
-    int32_t  biYPelsPerMeter;
-    uint32_t biClrUsed;
-    uint32_t biClrImportant;
-} BITMAPINFOHEADER;
-#pragma pack()
 
 // =================================================================
-// Função de Carregamento de Imagem
+// Operações do Coprocessador
 // =================================================================
-int load_bmp_image(char *filename) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        perror("Erro ao abrir o arquivo BMP");
+// Toda operação passa por aqui para que o modo de verificação (-v)
+// acompanhe a sequência de instruções enviadas à FPGA.
+//
+// As operações são enviadas com coproc_submit e terminadas depois
+// (op_finish): no modo interativo o teclado continua sendo lido
+// enquanto a FPGA calcula. Há no máximo uma operação em aberto; a
+// seguinte, a carga de imagem e o fim do programa esperam por ela.
+//
+// Antes de enviar, a palavra de status (coproc_get_status) diz se o
+// comando mudaria alguma coisa: zoom in no nível máximo, zoom out no
+// mínimo e pan para a mesma vista são ignorados (retorno 0).
+
+#define MENU_OP_TIMEOUT_US 2000000 // Aviso se a FPGA não terminar em 2 s
+
+static const char *const g_level_names[] = { "", "1/8", "1/4", "1/2", "1x", "2x", "4x", "8x" };
+
+static struct {
+    int          active;
+    CoprocTicket ticket;
+    uint32_t     instruction;  // Para o coproc_verify_after
+    uint32_t     view;         // Registrado em g_view_alg (G_VIEW_NONE: não é zoom)
+    const char  *done_message; // Impresso ao terminar (modo interativo)
+} g_pending;
+
+static void print_status(void);
+
+// O que está na tela: a mem1 (RESET, 1x, ...) ou a mem3 (algoritmo, filtro).
+// É a fonte padrão do filtro 3x3.
+static ZoomHostState g_screen = { .current_zoom = ZOOM_1X, .next_zoom = ZOOM_1X, .pixel_format = PIXEL_GRAY8 };
+static int g_screen_mem3 = 0;
+
+static void view_done(uint32_t algorithm) {
+    g_view_seq = STATUS_FIELD(coproc_get_status(), SEQ);
+    g_view_alg = algorithm;
+}
+
+// Mesma vista: nenhuma instrução chegou à FPGA desde o último comando de
+// zoom, que usou o mesmo algoritmo e deixou os mesmos offsets latchados
+static int view_unchanged(uint32_t status, uint32_t algorithm, uint32_t x, uint32_t y) {
+    return g_view_seq == STATUS_FIELD(status, SEQ) && g_view_alg == algorithm &&
+           STATUS_FIELD(status, X) == x && STATUS_FIELD(status, Y) == y;
+}
+
+// Espera a operação em aberto (se houver) e confere o resultado
+static void op_finish(void) {
+    if (!g_pending.active) {
+        return;
+    }
+    if (coproc_wait(g_pending.ticket, MENU_OP_TIMEOUT_US) != 0) {
+        printf("Aviso: a FPGA não concluiu a operação em %d ms; aguardando...\n", MENU_OP_TIMEOUT_US / 1000);
+        coproc_wait(g_pending.ticket, COPROC_WAIT_FOREVER);
+    }
+    g_pending.active = 0;
+    coproc_verify_after(g_pending.instruction);
+    ZoomHostAction shown = zoom_host_decode(&g_screen, g_pending.instruction);
+    if (shown.kind != ZOOM_ACTION_NONE) {
+        g_screen_mem3 = (shown.kind != ZOOM_ACTION_COPY_MEM1);
+    }
+    if (g_pending.view != G_VIEW_NONE) {
+        view_done(g_pending.view);
+    } else {
+        g_view_seq = G_VIEW_NONE;
+    }
+    if (g_pending.done_message) {
+        printf("%s\n", g_pending.done_message);
+        print_status();
+    }
+}
+
+// Mira ('a'): em 1x, as setas movem um retângulo sobreposto com a janela
+// do próximo Zoom In (160x120, a de 2x) em vez de refazer a imagem com um
+// pan. Cada seta custa uma instrução (CONFIG_OVERLAY_POS). Qualquer
+// operação que muda a tela desliga a mira.
+#define AIM_WIDTH  160
+#define AIM_HEIGHT 120
+static int g_aim = 0;
+
+static void overlay_sync(uint32_t instruction) {
+    coproc_verify_after(instruction);
+    g_view_seq = G_VIEW_NONE; // A instrução conta no nº de sequência
+}
+
+static void aim_stop(void) {
+    if (!g_aim) {
+        return;
+    }
+    g_aim = 0;
+    op_finish();
+    coproc_verify_before();
+    coproc_overlay_enable(0);
+    overlay_sync(OVERLAY_ENABLE_INSTRUCTION(0));
+}
+
+// Retorna 0 se a operação foi enviada e -1 se a FPGA não ficou livre no prazo
+static int op_start(uint32_t instruction, uint32_t view) {
+    aim_stop();
+    op_finish();
+    coproc_verify_before();
+    CoprocTicket ticket = coproc_submit(instruction, MENU_OP_TIMEOUT_US);
+    if (ticket == COPROC_TICKET_ERROR) {
+        printf("Erro: a FPGA não ficou livre em %d ms; operação não enviada.\n", MENU_OP_TIMEOUT_US / 1000);
+        coproc_verify_aborted();
+        g_view_seq = G_VIEW_NONE;
         return -1;
     }
+    g_pending.ticket       = ticket;
+    g_pending.instruction  = instruction;
+    g_pending.view         = view;
+    g_pending.done_message = NULL;
+    g_pending.active       = 1;
+    return 0;
+}
 
-    BITMAPFILEHEADER fileHeader;
-    BITMAPINFOHEADER infoHeader;
-    fread(&fileHeader, sizeof(BITMAPFILEHEADER), 1, file);
-    fread(&infoHeader, sizeof(BITMAPINFOHEADER), 1, file);
+// Um pan novo tornou obsoleto o pan em aberto: interrompe-o (ABORT) em vez
+// de esperar o quadro inteiro. Só com o mesmo algoritmo, para que o pan
+// seguinte reescreva na mem3 os mesmos pixels que o interrompido deixou.
+static void op_cancel_pan(uint32_t algorithm) {
+    uint32_t pan = algorithm | (1u << 20);
+    if (!g_pending.active || (g_pending.instruction & ((1u << 20) | 0x7)) != pan) {
+        return;
+    }
+    int aborted = coproc_abort(g_pending.ticket, MENU_OP_TIMEOUT_US);
+    if (aborted < 0) {
+        // Ticket abandonado: o pan seguinte só sai se a FPGA parar no prazo
+        printf("Erro: a FPGA não atendeu o cancelamento em %d ms.\n", MENU_OP_TIMEOUT_US / 1000);
+        g_pending.active = 0;
+        coproc_verify_aborted();
+        g_view_seq = G_VIEW_NONE;
+    } else if (aborted) {
+        g_pending.active = 0; // Nada a conferir: a tela continua com a vista anterior
+        coproc_verify_aborted();
+        g_view_seq = G_VIEW_NONE;
+        printf("Pan para (%u, %u) cancelado.\n", (unsigned)((g_pending.instruction >> 3) & 0x1FF),
+               (unsigned)(g_pending.instruction >> 21));
+    } else {
+        op_finish();
+    }
+}
+
+static int run_zoom_in(uint32_t algorithm, uint32_t x, uint32_t y) {
+    op_finish();
+    if (STATUS_FIELD(coproc_get_status(), ZOOM) == ZOOM_8X) {
+        printf("Já no zoom máximo (8x): comando ignorado.\n");
+        return 0;
+    }
+    return op_start(algorithm | (x << 3) | (y << 21), algorithm) == 0 ? 1 : -1;
+}
+
+static int run_pan(uint32_t algorithm, uint32_t x, uint32_t y) {
+    op_finish();
+    if (view_unchanged(coproc_get_status(), algorithm | (1u << 20), x, y)) {
+        printf("Janela já em (%u, %u): comando ignorado.\n", (unsigned)x, (unsigned)y);
+        return 0;
+    }
+    return op_start(algorithm | (1u << 20) | (x << 3) | (y << 21), algorithm | (1u << 20)) == 0 ? 1 : -1;
+}
+
+static int run_zoom_out(uint32_t algorithm) {
+    op_finish();
+    if (STATUS_FIELD(coproc_get_status(), ZOOM) == ZOOM_1_8X) {
+        printf("Já no zoom mínimo (1/8): comando ignorado.\n");
+        return 0;
+    }
+    return op_start(algorithm, algorithm) == 0 ? 1 : -1;
+}
 
-    if (fileHeader.bfType != 0x4D42 || infoHeader.biBitCount != 8) {
-        printf("Erro: O arquivo deve ser um BMP de 8 bits (escala de cinza).\n");
-        printf("       (Detectado: Tipo %x, %d bits)\n", fileHeader.bfType, infoHeader.biBitCount);
-        fclose(file);
+static int run_set_view(uint32_t level, uint32_t algorithm, uint32_t x, uint32_t y) {
+    op_finish();
+    uint32_t status = coproc_get_status();
+    if (STATUS_FIELD(status, ZOOM) == level && view_unchanged(status, SET_ZOOM_INSTRUCTION(level, algorithm, 0, 0), x, y)) {
+        printf("Já no nível %s em (%u, %u): comando ignorado.\n", g_level_names[level], (unsigned)x, (unsigned)y);
+        return 0;
+    }
+    return op_start(SET_ZOOM_INSTRUCTION(level, algorithm, x, y), SET_ZOOM_INSTRUCTION(level, algorithm, 0, 0)) == 0 ? 1 : -1;
+}
+
+static int run_reset(void) {
+    return op_start(OP_RESET, G_VIEW_NONE);
+}
+
+// Formato do pixel (-f): vale para as próximas cargas e para o BA
+static void run_pixel_format(uint32_t format) {
+    op_finish();
+    coproc_verify_before();
+    coproc_set_pixel_format(format);
+    coproc_verify_after(CONFIG_INSTRUCTION(CONFIG_PIXEL_FORMAT, format));
+}
+
+// Filtro e histograma da FPGA tratam o byte do pixel como cinza
+static int gray_only(const char *what) {
+    if (g_pixel_format == PIXEL_RGB332) {
+        printf("%s indisponível em RGB332 (a FPGA trata o pixel como cinza).\n", what);
         return -1;
     }
-    
-    if (infoHeader.biCompression != 0) {
-        printf("Aviso: Imagem BMP está comprimida (Tipo: %d). \n", infoHeader.biCompression);
-        printf("       A imagem pode aparecer distorcida.\n");
+    return 0;
+}
+
+// Filtro 3x3 sobre a imagem da tela (from_screen) ou sobre a original (mem1).
+// Os coeficientes vão antes, com a FPGA parada. Retorna 0 se foi enviado.
+static int run_filter(const FilterHostPreset *preset, int from_screen) {
+    uint32_t flags = preset->flags | ((from_screen && g_screen_mem3) ? FILTER_FROM_MEM3 : 0);
+
+    if (gray_only("Filtro 3x3") != 0) {
+        return -1;
     }
-    
-    printf("Lendo imagem: %s (%dx%d pixels, %d bits)\n", 
-           filename, infoHeader.biWidth, infoHeader.biHeight, infoHeader.biBitCount);
+    op_finish();
+    coproc_verify_before();
+    coproc_filter_load(preset->kernel);
+    coproc_verify_filter_kernel(preset->kernel);
+    return op_start(FILTER_RUN_INSTRUCTION(flags, preset->shift), G_VIEW_NONE);
+}
 
-    fseek(file, fileHeader.bfOffBits, SEEK_SET);
+// Percentil p (0..100) do histograma: menor valor com ao menos p% dos pixels até ele
+static uint32_t stats_percentile(const CoprocStats *stats, uint32_t p) {
+    uint64_t target = ((uint64_t)stats->count * p + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t value = 0; value < STATS_BINS; value++) {
+        seen += stats->histogram[value];
+        if (seen >= target && seen > 0) {
+            return value;
+        }
+    }
+    return STATS_BINS - 1;
+}
 
-    int width = infoHeader.biWidth;
-    int height = infoHeader.biHeight;
-    int padding = (4 - (width * 1) % 4) % 4;
-    
-    printf("Iniciando transferência para a FPGA...\n");
+// Histograma da imagem da tela (from_screen) ou da original, contado pela
+// FPGA numa varredura; só os contadores atravessam o barramento.
+// Retorna o modo usado (STATS_SCAN_*).
+static uint32_t scan_stats(int from_screen, CoprocStats *stats) {
+    uint32_t mode = (from_screen && g_screen_mem3) ? STATS_SCAN_MEM3 : STATS_SCAN_MEM1;
 
-    for (int y = height - 1; y >= 0; y--) { 
-        for (int x = 0; x < width; x++) { 
-            
-            uint8_t gray_pixel;
-            if (fread(&gray_pixel, 1, 1, file) < 1) {
-                gray_pixel = 0; 
-            }
-            
-            uint32_t fpga_addr = (uint32_t)(y * width + x);
+    op_finish();
+    coproc_verify_before();
+    coproc_stats_start(mode);
+    coproc_stats_read(stats);
+    coproc_verify_stats(mode, stats);
+    return mode;
+}
+
+static int print_stats(int from_screen) {
+    CoprocStats stats;
 
-            if (fpga_addr > 76799) break; 
+    if (gray_only("Histograma") != 0) {
+        return -1;
+    }
+    uint32_t mode = scan_stats(from_screen, &stats);
 
-            coproc_write_pixel(fpga_addr, gray_pixel);
-            coproc_wait_done(); 
+    if (stats.count == 0) {
+        printf("Estatísticas: nenhum pixel contado.\n");
+        return 0;
+    }
+    uint32_t low = stats_percentile(&stats, 1), high = stats_percentile(&stats, 99);
+    printf("Estatísticas (%s): %u pixels, mín %u, máx %u, média %.1f, mediana %u.\n",
+           (mode == STATS_SCAN_MEM3) ? "tela" : "original", (unsigned)stats.count, stats.min, stats.max,
+           (double)stats.sum / stats.count, (unsigned)stats_percentile(&stats, 50));
+    printf("  Percentis 1%%/99%%: %u/%u; esticar o contraste mapearia [%u, %u] em [0, 255].\n",
+           (unsigned)low, (unsigned)high, (unsigned)low, (unsigned)high);
+    return 0;
+}
+
+// LUT de exibição: "off", "invert", "gamma" (com gamma), "stretch" (percentis
+// 1%/99% da imagem da tela) ou "heat" (falsa cor). Vale para tudo o que for
+// exibido depois, até a próxima. Em RGB332 as tabelas são refeitas sobre a
+// cor (lut_host_rgb332); o stretch precisa do histograma. Retorna 0 se carregou.
+static int run_lut(const char *name, double gamma) {
+    LutHostTables lut;
+
+    if (strcmp(name, "off") == 0) {
+        op_finish();
+        coproc_verify_before();
+        coproc_lut_enable(0);
+        return 0;
+    }
+    if (strcmp(name, "invert") == 0) {
+        lut_host_invert(&lut);
+    } else if (strcmp(name, "gamma") == 0 && gamma > 0.0) {
+        lut_host_gamma(&lut, gamma);
+    } else if (strcmp(name, "heat") == 0) {
+        lut_host_heat(&lut);
+    } else if (strcmp(name, "stretch") == 0) {
+        CoprocStats stats;
+        if (gray_only("LUT stretch") != 0) {
+            return -1;
         }
-        
-        fseek(file, padding, SEEK_CUR);
-        
-        if (y > 0 && y % (height/10) == 0) {
-            printf("Progresso: %d%%\n", (int)(((float)(height - y) / height) * 100));
+        scan_stats(1, &stats);
+        uint32_t low = stats_percentile(&stats, 1), high = stats_percentile(&stats, 99);
+        if (stats.count == 0 || high <= low) {
+            printf("Imagem sem faixa de contraste para esticar.\n");
+            return -1;
         }
+        lut_host_stretch(&lut, low, high);
+        printf("LUT: [%u, %u] -> [0, 255].\n", (unsigned)low, (unsigned)high);
+    } else {
+        return -1;
     }
-    
-    printf("Transferência de imagem concluída.\n");
-    fclose(file);
+
+    if (g_pixel_format == PIXEL_RGB332) {
+        lut_host_rgb332(&lut);
+    }
+    op_finish();
+    coproc_verify_before();
+    if (lut.color) {
+        coproc_load_lut(LUT_RED, lut.red);
+        coproc_load_lut(LUT_GREEN, lut.green);
+        coproc_load_lut(LUT_BLUE, lut.blue);
+    } else {
+        coproc_load_lut(LUT_GRAY, lut.red);
+    }
+    return 0;
+}
+
+// Orientação da imagem na tela (CONFIG_ORIENTATION), na ordem da tecla 't'.
+// Só o VGA muda: zoom, pan e leituras continuam na orientação da memória.
+static const struct {
+    const char *name;
+    uint32_t    value;
+} g_orientations[] = {
+    { "none",    ORIENT_NONE },
+    { "rot90",   ORIENT_ROT90 },
+    { "rot180",  ORIENT_ROT180 },
+    { "rot270",  ORIENT_ROT270 },
+    { "mirrorh", ORIENT_MIRROR_H },
+    { "mirrorv", ORIENT_MIRROR_V },
+};
+#define NUM_ORIENTATIONS (sizeof(g_orientations) / sizeof(g_orientations[0]))
+static uint32_t g_orientation = 0; // Índice em g_orientations
+
+// Retorna 0 se a orientação existe e foi enviada
+static int run_orientation(const char *name) {
+    for (uint32_t i = 0; i < NUM_ORIENTATIONS; i++) {
+        if (strcmp(name, g_orientations[i].name) == 0) {
+            op_finish();
+            coproc_verify_before();
+            coproc_set_orientation(g_orientations[i].value);
+            coproc_verify_after(CONFIG_INSTRUCTION(CONFIG_ORIENTATION, g_orientations[i].value));
+            g_orientation = i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Saída de vídeo (CONFIG_SCANOUT), na ordem da tecla 'w'
+static const struct {
+    const char *name;
+    uint32_t    value;
+} g_scanouts[] = {
+    { "box",      SCANOUT_BOX },
+    { "2x",       SCANOUT_2X },
+    { "bilinear", SCANOUT_2X_BILINEAR },
+};
+#define NUM_SCANOUTS (sizeof(g_scanouts) / sizeof(g_scanouts[0]))
+static uint32_t g_scanout = 0; // Índice em g_scanouts (-w)
+
+static int find_scanout(const char *name) {
+    for (uint32_t i = 0; i < NUM_SCANOUTS; i++) {
+        if (strcmp(name, g_scanouts[i].name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Retorna 0 se o modo existe e foi enviado
+static int run_scanout(const char *name) {
+    int i = find_scanout(name);
+    if (i < 0) {
+        return -1;
+    }
+    op_finish();
+    coproc_verify_before();
+    coproc_set_scanout(g_scanouts[i].value);
+    coproc_verify_after(CONFIG_INSTRUCTION(CONFIG_SCANOUT, g_scanouts[i].value));
+    g_scanout = (uint32_t)i;
     return 0;
 }
 
+// Estado lido da FPGA (não o cursor do menu)
+static void print_status(void) {
+    uint32_t status = coproc_get_status();
+    if (!(status & FLAG_DONE_MASK) || STATUS_FIELD(status, STATE) != 0) {
+        printf("FPGA: ocupada (estado %u da FSM).\n", (unsigned)STATUS_FIELD(status, STATE));
+        return;
+    }
+    printf("FPGA: nível %s, janela em (%u, %u), instrução nº %u (mod 16)%s.\n",
+           g_level_names[STATUS_FIELD(status, ZOOM)],
+           (unsigned)STATUS_FIELD(status, X), (unsigned)STATUS_FIELD(status, Y),
+           (unsigned)STATUS_FIELD(status, SEQ),
+           (status & FLAG_ERROR_MASK) ? ", ERRO" : "");
+}
+
 
 // =================================================================
 // Menu Interativo
@@ -138,6 +545,17 @@ static uint32_t g_zoom_offset_y = 0;
 #define IMG_WIDTH 320
 #define IMG_HEIGHT 240
 
+// Algoritmo do modo atual para o nível (em 1x é só uma cópia da mem1)
+static uint32_t view_algorithm(uint32_t level) {
+    if (level > ZOOM_1X) {
+        return (current_zoom_in_mode == ZOOM_IN_PIXEL_REPETITION) ? OP_PR_ALG : OP_NHI_ALG;
+    }
+    if (level < ZOOM_1X) {
+        return (current_zoom_out_mode == ZOOM_OUT_BLOCK_AVERAGE) ? OP_BA_ALG : OP_NH_ALG;
+    }
+    return OP_NHI_ALG;
+}
+
 static struct termios old_termios, new_termios;
 
 void set_terminal_mode() {
@@ -154,9 +572,16 @@ void restore_terminal_mode() {
 void print_menu() {
     printf("\n--- Controle Interativo da FPGA (Híbrido C+ASM) ---\n");
     printf("Controles de Zoom:\n");
-    printf("  [Setas]: Mover 'Pan' (panorâmica) do Zoom In\n");
+    printf("  [Setas]: Mover 'Pan' (panorâmica) do Zoom In (com a mira, só o retângulo)\n");
+    printf("  [a]: Mira em 1x: retângulo com a janela do próximo Zoom In (%s)\n", g_aim ? "ligada" : "desligada");
     printf("  [i] ou [+]: Aplicar Zoom In (na posição atual do cursor)\n");
     printf("  [o] ou [-]: Zoom Out\n");
+    printf("  [1]-[7]: Ir direto ao nível (1/8x, 1/4x, 1/2x, 1x, 2x, 4x, 8x)\n");
+    printf("  [f]: Filtro 3x3 na imagem da tela (alterna blur, sharpen, edge)\n");
+    printf("  [g]: LUT de exibição (alterna stretch, gamma, invert, heat, off)\n");
+    printf("  [t]: Orientação da tela (Atual: %s)\n", g_orientations[g_orientation].name);
+    printf("  [w]: Saída de vídeo (Atual: %s; alterna caixa, tela cheia 2x e 2x bilinear)\n",
+           g_scanouts[g_scanout].name);
     printf("\nSeleção de Algoritmo:\n");
     printf("  [m]: Alternar modo de Zoom OUT (Atual: %s)\n", 
            (current_zoom_out_mode == ZOOM_OUT_BLOCK_AVERAGE) ? 
@@ -165,8 +590,10 @@ void print_menu() {
            (current_zoom_in_mode == ZOOM_IN_PIXEL_REPETITION) ? 
            "Repeticao de Pixel" : "Vizinho Mais Proximo");
     printf("\nOutros Comandos:\n");
-    printf("  [l]: Carregar nova imagem BMP\n"); 
+    printf("  [l]: Carregar nova imagem (BMP/PGM/Y8)\n"); 
     printf("  [r]: Resetar imagem (recarrega da mem1 original)\n");
+    printf("  [s]: Mostrar o estado da FPGA (nível, janela, nº da instrução)\n");
+    printf("  [e]: Estatísticas da imagem da tela (histograma contado pela FPGA)\n");
     printf("  [h]: Mostrar este menu\n");
     printf("  [q]: Sair\n");
     printf("--------------------------------------------------\n");
@@ -178,7 +605,7 @@ void handle_load_image() {
     restore_terminal_mode();
     
     printf("\n--- Carregar Nova Imagem ---\n");
-    printf("Digite o caminho para a imagem .bmp: ");
+    printf("Digite o caminho da imagem (.bmp, .pgm, .y8): ");
     
     scanf("%255s", filename);
     
@@ -187,13 +614,12 @@ void handle_load_image() {
     
     printf("Carregando '%s'...\n", filename);
     
-    if (load_bmp_image(filename) != 0) {
+    if (load_image(filename, g_resize_mode) != 0) {
         printf("Falha ao carregar a imagem.\n");
     } else {
         printf("Imagem carregada. Enviando comando de RESET para exibir...\n");
-        coproc_reset_image();
-        coproc_wait_done();
-        printf("Imagem exibida.\n");
+        run_reset();
+        g_pending.done_message = "Imagem exibida.";
     }
     
     set_terminal_mode();
@@ -203,69 +629,157 @@ void handle_load_image() {
 void aplicar_zoom_na_posicao_atual() {
     printf("Aplicando Zoom In na posição (%d, %d)...\n", g_zoom_offset_x, g_zoom_offset_y);
     
-    if (current_zoom_in_mode == ZOOM_IN_PIXEL_REPETITION) {
-        coproc_apply_zoom_with_offset(OP_PR_ALG, g_zoom_offset_x, g_zoom_offset_y);
-        coproc_wait_done();           
-    } else { // ZOOM_IN_NEAREST_NEIGHBOR
-        coproc_apply_zoom_with_offset(OP_NHI_ALG, g_zoom_offset_x, g_zoom_offset_y);
-        coproc_wait_done();
+    uint32_t algorithm = (current_zoom_in_mode == ZOOM_IN_PIXEL_REPETITION) ? OP_PR_ALG : OP_NHI_ALG;
+    if (run_zoom_in(algorithm, g_zoom_offset_x, g_zoom_offset_y) > 0) {
+        g_pending.done_message = "Zoom In concluído.";
     }
-    
-    printf("Zoom In concluído.\n");
 }
 
 void aplicar_pan_na_posicao_atual() {
     printf("Aplicando Pan (movendo) para a posição (%d, %d)...\n", g_zoom_offset_x, g_zoom_offset_y);
     
-    if (current_zoom_in_mode == ZOOM_IN_PIXEL_REPETITION) {
-        coproc_pan_zoom_with_offset(OP_PR_ALG, g_zoom_offset_x, g_zoom_offset_y);
-        coproc_wait_done();           
-    } else { // ZOOM_IN_NEAREST_NEIGHBOR
-        coproc_pan_zoom_with_offset(OP_NHI_ALG, g_zoom_offset_x, g_zoom_offset_y);
-        coproc_wait_done();
+    uint32_t algorithm = (current_zoom_in_mode == ZOOM_IN_PIXEL_REPETITION) ? OP_PR_ALG : OP_NHI_ALG;
+    op_cancel_pan(algorithm);
+    if (run_pan(algorithm, g_zoom_offset_x, g_zoom_offset_y) > 0) {
+        g_pending.done_message = "Pan concluído.";
     }
-    
-    printf("Pan concluído.\n");
 }
 
 
+// Próxima tecla. Com uma operação em aberto, alterna entre o teclado e
+// o ticket: a operação é terminada (e conferida) assim que a FPGA
+// acabar, mesmo sem nenhuma tecla.
+static int g_key_pushback = -1; // Tecla lida por drain_arrows que não era seta
+
+static int read_key(void) {
+    struct pollfd keyboard = { STDIN_FILENO, POLLIN, 0 };
+
+    if (g_key_pushback >= 0) {
+        int c = g_key_pushback;
+        g_key_pushback = -1;
+        return c;
+    }
+    while (g_pending.active) {
+        if (coproc_poll(g_pending.ticket)) {
+            op_finish();
+            break;
+        }
+        if (poll(&keyboard, 1, 1) > 0) {
+            break;
+        }
+    }
+    return getchar();
+}
+
+// Um passo do cursor em um eixo (step = -1, 0 ou 1), sem sair da imagem
+static uint32_t move_offset(uint32_t offset, int step, uint32_t limit) {
+    if (step < 0) {
+        return (offset >= MOVE_STEP) ? (offset - MOVE_STEP) : 0;
+    }
+    if (step > 0) {
+        return (offset + MOVE_STEP < limit) ? (offset + MOVE_STEP) : offset;
+    }
+    return offset;
+}
+
+// Código da seta (depois de ESC [) -> cursor. Retorna 0 se não for seta.
+// A seta é a direção na tela; com a tela girada/espelhada ela é levada
+// para a orientação da imagem, onde fica o cursor.
+static int move_cursor(int code) {
+    uint32_t orientation = g_orientations[g_orientation].value;
+    int dx = 0, dy = 0;
+
+    switch (code) {
+        case 0x41: dy = -1; break; // Seta para Cima
+        case 0x42: dy =  1; break; // Seta para Baixo
+        case 0x43: dx =  1; break; // Seta para Direita
+        case 0x44: dx = -1; break; // Seta para Esquerda
+        default:   return 0;
+    }
+    if (orientation & ORIENT_SWAP_XY) {
+        int t = dx;
+        dx = dy;
+        dy = t;
+    }
+    if (orientation & ORIENT_FLIP_X) dx = -dx;
+    if (orientation & ORIENT_FLIP_Y) dy = -dy;
+
+    g_zoom_offset_x = move_offset(g_zoom_offset_x, dx, IMG_WIDTH);
+    g_zoom_offset_y = move_offset(g_zoom_offset_y, dy, IMG_HEIGHT);
+    return 1;
+}
+
+// Soma ao cursor as setas que já estão esperando (tecla segurada): um
+// único pan vai para a posição final. Para na primeira tecla que não for
+// seta, que fica para a próxima volta do loop. Retorna o nº de setas.
+static int drain_arrows(void) {
+    struct pollfd keyboard = { STDIN_FILENO, POLLIN, 0 };
+    int merged = 0;
+
+    while (poll(&keyboard, 1, 0) > 0) {
+        int c = getchar();
+        if (c != 0x1B) {
+            g_key_pushback = c;
+            break;
+        }
+        if (getchar() != 0x5B || !move_cursor(getchar())) {
+            break;
+        }
+        merged++;
+    }
+    return merged;
+}
+
+static void aim_start(void) {
+    op_finish();
+    if (STATUS_FIELD(coproc_get_status(), ZOOM) != ZOOM_1X) {
+        printf("A mira só vale com a imagem em 1x (use [4] ou [r]).\n");
+        return;
+    }
+    coproc_verify_before();
+    coproc_overlay_rect(g_zoom_offset_x, g_zoom_offset_y, AIM_WIDTH, AIM_HEIGHT);
+    overlay_sync(OVERLAY_ENABLE_INSTRUCTION(1));
+    g_aim = 1;
+}
+
+static void aim_move(void) {
+    op_finish();
+    coproc_verify_before();
+    coproc_overlay_move(g_zoom_offset_x, g_zoom_offset_y);
+    overlay_sync(OVERLAY_POS_INSTRUCTION(g_zoom_offset_x, g_zoom_offset_y));
+}
+
 void enter_control_loop() {
     char c;
+    setvbuf(stdin, NULL, _IONBF, 0); // poll() enxerga toda tecla ainda não lida
     set_terminal_mode();
     print_menu();
 
     while (1) {
-        c = getchar();
+        c = read_key();
         
         if (c == 0x1B) { 
             if (getchar() == 0x5B) { 
-                switch (getchar()) { 
-                    case 0x41: // Seta para Cima
-                        g_zoom_offset_y = (g_zoom_offset_y >= MOVE_STEP) ? (g_zoom_offset_y - MOVE_STEP) : 0;
-                        printf("Nova posição do cursor: (%d, %d)\n", g_zoom_offset_x, g_zoom_offset_y);
-                        aplicar_pan_na_posicao_atual();
-                        break;
-                    case 0x42: // Seta para Baixo
-                        g_zoom_offset_y = (g_zoom_offset_y + MOVE_STEP < IMG_HEIGHT) ? (g_zoom_offset_y + MOVE_STEP) : g_zoom_offset_y;
-                        printf("Nova posição do cursor: (%d, %d)\n", g_zoom_offset_x, g_zoom_offset_y);
-                        aplicar_pan_na_posicao_atual();
-                        break;
-                    case 0x43: // Seta para Direita
-                        g_zoom_offset_x = (g_zoom_offset_x + MOVE_STEP < IMG_WIDTH) ? (g_zoom_offset_x + MOVE_STEP) : g_zoom_offset_x;
-                        printf("Nova posição do cursor: (%d, %d)\n", g_zoom_offset_x, g_zoom_offset_y);
-                        aplicar_pan_na_posicao_atual(); 
-                        break;
-                    case 0x44: // Seta para Esquerda
-                        g_zoom_offset_x = (g_zoom_offset_x >= MOVE_STEP) ? (g_zoom_offset_x - MOVE_STEP) : 0;
+                if (move_cursor(getchar())) {
+                    int merged = drain_arrows();
+                    if (merged > 0) {
+                        printf("Nova posição do cursor: (%d, %d) (%d setas somadas)\n",
+                               g_zoom_offset_x, g_zoom_offset_y, merged + 1);
+                    } else {
                         printf("Nova posição do cursor: (%d, %d)\n", g_zoom_offset_x, g_zoom_offset_y);
+                    }
+                    if (g_aim) {
+                        aim_move();
+                    } else {
                         aplicar_pan_na_posicao_atual();
-                        break;
+                    }
                 }
                 continue; 
             }
         }
         
         if (c == 'q' || c == 'Q') {
+            op_finish();
             break;
         }
 
@@ -278,14 +792,9 @@ void enter_control_loop() {
             case 'o':
             case '-':
                 printf("Aplicando Zoom Out...\n");
-                if (current_zoom_out_mode == ZOOM_OUT_BLOCK_AVERAGE) {
-                    coproc_apply_zoom(OP_BA_ALG);
-                    coproc_wait_done();
-                } else {
-                    coproc_apply_zoom(OP_NH_ALG);
-                    coproc_wait_done();
+                if (run_zoom_out(current_zoom_out_mode == ZOOM_OUT_BLOCK_AVERAGE ? OP_BA_ALG : OP_NH_ALG) > 0) {
+                    g_pending.done_message = "Zoom Out concluído.";
                 }
-                printf("Zoom Out concluído.\n");
                 break;
                 
             case 'm':
@@ -310,14 +819,80 @@ void enter_control_loop() {
                 print_menu();
                 break;
 
+            case '1': case '2': case '3': case '4': case '5': case '6': case '7': {
+                uint32_t level = (uint32_t)(c - '0');
+                printf("Indo para o nível %s...\n", g_level_names[level]);
+                if (run_set_view(level, view_algorithm(level), g_zoom_offset_x, g_zoom_offset_y) > 0) {
+                    g_pending.done_message = "Nível alcançado.";
+                }
+                break;
+            }
+
+            case 'f':
+            case 'F': {
+                static uint32_t next_filter = 0;
+                const FilterHostPreset *preset = filter_host_preset_at(next_filter++);
+                if (!preset) {
+                    next_filter = 1;
+                    preset = filter_host_preset_at(0);
+                }
+                printf("Aplicando o filtro %s...\n", preset->name);
+                if (run_filter(preset, 1) == 0) {
+                    g_pending.done_message = "Filtro aplicado.";
+                }
+                break;
+            }
+
+            case 'g':
+            case 'G': {
+                static const char *const luts[] = { "stretch", "gamma", "invert", "heat", "off" };
+                static uint32_t next_lut = 0;
+                const char *name = luts[next_lut];
+                next_lut = (next_lut + 1) % (sizeof(luts) / sizeof(luts[0]));
+                printf("LUT de exibição: %s...\n", name);
+                run_lut(name, 2.2);
+                break;
+            }
+
+            case 'a':
+            case 'A':
+                if (g_aim) {
+                    aim_stop();
+                    printf("Mira desligada.\n");
+                } else {
+                    aim_start();
+                    if (g_aim) {
+                        printf("Mira em (%d, %d): setas movem o retângulo, [i] aplica o Zoom In.\n",
+                               g_zoom_offset_x, g_zoom_offset_y);
+                    }
+                }
+                break;
+
+            case 't':
+            case 'T': {
+                const char *name = g_orientations[(g_orientation + 1) % NUM_ORIENTATIONS].name;
+                printf("Orientação da tela: %s.\n", name);
+                run_orientation(name);
+                print_menu();
+                break;
+            }
+
+            case 'w':
+            case 'W': {
+                const char *name = g_scanouts[(g_scanout + 1) % NUM_SCANOUTS].name;
+                printf("Saída de vídeo: %s.\n", name);
+                run_scanout(name);
+                print_menu();
+                break;
+            }
+
             case 'r':
             case 'R':
                 printf("Resetando imagem para o original...\n");
                 g_zoom_offset_x = 0;
                 g_zoom_offset_y = 0;
-                coproc_reset_image(); 
-                coproc_wait_done();   
-                printf("Reset concluído.\n");
+                run_reset();
+                g_pending.done_message = "Reset concluído.";
                 break;
             
             case 'l':
@@ -325,6 +900,16 @@ void enter_control_loop() {
                 handle_load_image(); 
                 break;
                 
+            case 's':
+            case 'S':
+                print_status();
+                break;
+
+            case 'e':
+            case 'E':
+                print_stats(1);
+                break;
+
             case 'h':
             case 'H':
                 print_menu();
@@ -335,11 +920,449 @@ void enter_control_loop() {
     restore_terminal_mode();
 }
 
+// =================================================================
+// Modo Roteiro (headless)
+// =================================================================
+// Executa uma lista de comandos sem termios, lida de um arquivo
+// (-s roteiro.txt) ou da linha de comando (-c "cmd; cmd; ..."),
+// e imprime o instante e a latência de cada comando.
+//
+// Comandos aceitos:
+//   load <arquivo> [fit|fill] Carrega a imagem e envia RESET para exibir
+//   zoomin pr|nhi [x y]     Zoom In na posição (x, y) (padrão: posição atual)
+//   zoomout ba|nh           Zoom Out
+//   view <nível> [alg] [x y] Vai direto ao nível (1/8, 1/4, 1/2, 1x, 2x, 4x, 8x)
+//                           com pr|nhi (zoom in) ou ba|nh (zoom out)
+//   pan <dx> <dy>           Move a janela de zoom (relativo, como as setas)
+//   filter blur|sharpen|edge [orig]
+//                           Filtro 3x3 na imagem da tela (orig: na original)
+//   reset                   Volta para a imagem original
+//   status                  Imprime a palavra de status da FPGA
+//   stats [orig]            Histograma, mínimo/máximo e média da imagem da
+//                           tela (orig: da original), contados pela FPGA
+//   lut off|invert|stretch|heat|gamma <g>
+//                           LUT de exibição entre a memória de vídeo e o VGA
+//   orient none|rot90|rot180|rot270|mirrorh|mirrorv
+//                           Gira/espelha a imagem na saída de vídeo
+//   scanout box|2x|bilinear Caixa 320x240 ou tela cheia (2x, com ou sem filtro)
+//   overlay <x> <y> [w h]   Retângulo sobreposto na tela (sem w h: só move)
+//   overlay off             Desliga o retângulo
+//   repeat <N> ... end      Repete o bloco N vezes (pode ser aninhado)
+//   trace <arquivo.json>    Grava o trace até aqui (apenas com make TRACE=1)
+// Linhas vazias e iniciadas por '#' são ignoradas.
+
+#define MAX_SCRIPT_LINES  1024
+#define MAX_SCRIPT_LINE   256
+#define MAX_REPEAT_DEPTH  16
+
+typedef struct {
+    char text[MAX_SCRIPT_LINE];
+    int  source_line;
+    int  match; // Índice do 'end' de um 'repeat' (e vice-versa)
+} ScriptLine;
+
+static ScriptLine g_script[MAX_SCRIPT_LINES];
+static int g_script_len = 0;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int script_add_line(const char *text, int source_line) {
+    while (isspace((unsigned char)*text)) text++;
+    if (*text == '\0' || *text == '#') {
+        return 0;
+    }
+    if (g_script_len >= MAX_SCRIPT_LINES) {
+        printf("Erro: roteiro com mais de %d comandos.\n", MAX_SCRIPT_LINES);
+        return -1;
+    }
+
+    ScriptLine *line = &g_script[g_script_len++];
+    strncpy(line->text, text, MAX_SCRIPT_LINE - 1);
+    line->text[MAX_SCRIPT_LINE - 1] = '\0';
+    size_t len = strlen(line->text);
+    while (len > 0 && isspace((unsigned char)line->text[len - 1])) {
+        line->text[--len] = '\0';
+    }
+    line->source_line = source_line;
+    line->match = -1;
+    return 0;
+}
+
+static int script_load_file(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror("Erro ao abrir o roteiro");
+        return -1;
+    }
+
+    char buffer[MAX_SCRIPT_LINE];
+    int source_line = 0;
+    while (fgets(buffer, sizeof(buffer), file)) {
+        buffer[strcspn(buffer, "\r\n")] = '\0';
+        if (script_add_line(buffer, ++source_line) != 0) {
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+static int script_load_string(const char *commands) {
+    char buffer[MAX_SCRIPT_LINES * 8];
+    char *saveptr;
+    int source_line = 0;
+
+    strncpy(buffer, commands, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+    for (char *cmd = strtok_r(buffer, ";\n", &saveptr); cmd; cmd = strtok_r(NULL, ";\n", &saveptr)) {
+        if (script_add_line(cmd, ++source_line) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Associa cada 'repeat' ao seu 'end'
+static int script_match_blocks(void) {
+    int stack[MAX_REPEAT_DEPTH];
+    int depth = 0;
+
+    for (int i = 0; i < g_script_len; i++) {
+        if (strncmp(g_script[i].text, "repeat", 6) == 0) {
+            if (depth == MAX_REPEAT_DEPTH) {
+                printf("Erro (linha %d): 'repeat' aninhado demais.\n", g_script[i].source_line);
+                return -1;
+            }
+            stack[depth++] = i;
+        } else if (strcmp(g_script[i].text, "end") == 0) {
+            if (depth == 0) {
+                printf("Erro (linha %d): 'end' sem 'repeat'.\n", g_script[i].source_line);
+                return -1;
+            }
+            int open = stack[--depth];
+            g_script[open].match = i;
+            g_script[i].match = open;
+        }
+    }
+    if (depth != 0) {
+        printf("Erro (linha %d): 'repeat' sem 'end'.\n", g_script[stack[depth - 1]].source_line);
+        return -1;
+    }
+    return 0;
+}
+
+// Nível pelo nome ("1/8" ... "8x"); 0 se desconhecido
+static uint32_t parse_zoom_level(const char *text) {
+    for (uint32_t level = ZOOM_1_8X; level <= ZOOM_8X; level++) {
+        if (strcmp(text, g_level_names[level]) == 0) {
+            return level;
+        }
+    }
+    return 0;
+}
+
+// Coordenada decimal em [0, limit), sem nada depois do número
+static int parse_coord(const char *text, long limit, uint32_t *value) {
+    char *end;
+    errno = 0;
+    long v = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || v < 0 || v >= limit) {
+        return -1;
+    }
+    *value = (uint32_t)v;
+    return 0;
+}
+
+// Script: "overlay off", "overlay x y" (move) ou "overlay x y w h".
+// Retorna 0 se enviou.
+static int run_overlay(const char *text) {
+    char arg[8];
+    int x, y, w, h;
+    int n = sscanf(text, "%*s %d %d %d %d", &x, &y, &w, &h);
+
+    if (n < 2) {
+        if (sscanf(text, "%*s %7s", arg) != 1 || strcmp(arg, "off") != 0) {
+            return -1;
+        }
+        op_finish();
+        coproc_verify_before();
+        coproc_overlay_enable(0);
+        overlay_sync(OVERLAY_ENABLE_INSTRUCTION(0));
+        return 0;
+    }
+    if ((n != 2 && n != 4) || x < 0 || x >= IMG_WIDTH || y < 0 || y >= IMG_HEIGHT ||
+        (n == 4 && (w < 1 || w > IMG_WIDTH || h < 1 || h > IMG_HEIGHT))) {
+        return -1;
+    }
+    op_finish();
+    coproc_verify_before();
+    if (n == 4) {
+        coproc_overlay_rect((uint32_t)x, (uint32_t)y, (uint32_t)w, (uint32_t)h);
+        overlay_sync(OVERLAY_ENABLE_INSTRUCTION(1));
+    } else {
+        coproc_overlay_move((uint32_t)x, (uint32_t)y);
+        overlay_sync(OVERLAY_POS_INSTRUCTION(x, y));
+    }
+    return 0;
+}
+
+// Algoritmo do 'view': pr|nhi só ampliam, ba|nh só reduzem
+static int set_view_mode(const char *text, uint32_t level) {
+    if (level >= ZOOM_1X && strcmp(text, "pr") == 0) {
+        current_zoom_in_mode = ZOOM_IN_PIXEL_REPETITION;
+    } else if (level >= ZOOM_1X && strcmp(text, "nhi") == 0) {
+        current_zoom_in_mode = ZOOM_IN_NEAREST_NEIGHBOR;
+    } else if (level <= ZOOM_1X && strcmp(text, "ba") == 0) {
+        current_zoom_out_mode = ZOOM_OUT_BLOCK_AVERAGE;
+    } else if (level <= ZOOM_1X && strcmp(text, "nh") == 0) {
+        current_zoom_out_mode = ZOOM_OUT_NEAREST_NEIGHBOR;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// run_zoom_in/run_zoom_out/run_set_view/run_pan: no roteiro, o comando
+// ignorado (0, ex.: zoom in no 8x) ou não enviado (-1) é erro
+static int script_result(int sent) {
+    return sent > 0 ? 0 : -1;
+}
+
+// Executa um comando simples (não 'repeat'/'end'). Retorna 0 em caso de sucesso.
+static int script_run_command(const char *text) {
+    char cmd[32] = "", arg[MAX_SCRIPT_LINE] = "", mode[16] = "";
+    int x, y;
+    int n = sscanf(text, "%31s %255s %15s", cmd, arg, mode);
+
+    if (strcmp(cmd, "load") == 0 && (n == 2 || n == 3)) {
+        ResizeMode resize = g_resize_mode;
+        if (n == 3 && parse_resize_mode(mode, &resize) != 0) {
+            return -1;
+        }
+        if (load_image(arg, resize) != 0) {
+            return -1;
+        }
+        return run_reset();
+    }
+
+    if (strcmp(cmd, "zoomin") == 0 && n >= 2) {
+        // "zoomin pr|nhi" ou "zoomin pr|nhi x y", nada além disso
+        char xs[16], ys[16], extra[2];
+        uint32_t zx, zy;
+        int k = sscanf(text, "%*s %*s %15s %15s %1s", xs, ys, extra);
+        if (k > 0 && (k != 2 || parse_coord(xs, IMG_WIDTH, &zx) != 0 || parse_coord(ys, IMG_HEIGHT, &zy) != 0)) {
+            return -1;
+        }
+        if (strcmp(arg, "pr") == 0) {
+            current_zoom_in_mode = ZOOM_IN_PIXEL_REPETITION;
+        } else if (strcmp(arg, "nhi") == 0) {
+            current_zoom_in_mode = ZOOM_IN_NEAREST_NEIGHBOR;
+        } else {
+            return -1;
+        }
+        if (k == 2) {
+            g_zoom_offset_x = zx;
+            g_zoom_offset_y = zy;
+        }
+        return script_result(run_zoom_in(current_zoom_in_mode == ZOOM_IN_PIXEL_REPETITION ? OP_PR_ALG : OP_NHI_ALG,
+                                         g_zoom_offset_x, g_zoom_offset_y));
+    }
+
+    if (strcmp(cmd, "zoomout") == 0 && n == 2) {
+        if (strcmp(arg, "ba") == 0) {
+            current_zoom_out_mode = ZOOM_OUT_BLOCK_AVERAGE;
+        } else if (strcmp(arg, "nh") == 0) {
+            current_zoom_out_mode = ZOOM_OUT_NEAREST_NEIGHBOR;
+        } else {
+            return -1;
+        }
+        return script_result(run_zoom_out(current_zoom_out_mode == ZOOM_OUT_BLOCK_AVERAGE ? OP_BA_ALG : OP_NH_ALG));
+    }
+
+    if (strcmp(cmd, "view") == 0 && n >= 2) {
+        uint32_t level = parse_zoom_level(arg);
+        int has_alg = (n == 3 && !isdigit((unsigned char)mode[0]));
+        if (level == 0 || (has_alg && set_view_mode(mode, level) != 0)) {
+            return -1;
+        }
+        if (sscanf(text, has_alg ? "%*s %*s %*s %d %d" : "%*s %*s %d %d", &x, &y) == 2) {
+            if (x < 0 || x >= IMG_WIDTH || y < 0 || y >= IMG_HEIGHT) {
+                return -1;
+            }
+            g_zoom_offset_x = x;
+            g_zoom_offset_y = y;
+        }
+        return script_result(run_set_view(level, view_algorithm(level), g_zoom_offset_x, g_zoom_offset_y));
+    }
+
+    if (strcmp(cmd, "filter") == 0 && (n == 2 || (n == 3 && strcmp(mode, "orig") == 0))) {
+        const FilterHostPreset *preset = filter_host_preset(arg);
+        if (!preset) {
+            return -1;
+        }
+        return run_filter(preset, n == 2);
+    }
+
+    if (strcmp(cmd, "pan") == 0 && sscanf(text, "%*s %d %d", &x, &y) == 2) {
+        x += (int)g_zoom_offset_x;
+        y += (int)g_zoom_offset_y;
+        g_zoom_offset_x = (x < 0) ? 0 : (x >= IMG_WIDTH)  ? IMG_WIDTH - 1  : x;
+        g_zoom_offset_y = (y < 0) ? 0 : (y >= IMG_HEIGHT) ? IMG_HEIGHT - 1 : y;
+        return script_result(run_pan(current_zoom_in_mode == ZOOM_IN_PIXEL_REPETITION ? OP_PR_ALG : OP_NHI_ALG,
+                                     g_zoom_offset_x, g_zoom_offset_y));
+    }
+
+#ifdef COPROC_TRACE
+    if (strcmp(cmd, "trace") == 0 && n == 2) {
+        return coproc_trace_dump(arg);
+    }
+#endif
+
+    if (strcmp(cmd, "status") == 0 && n == 1) {
+        print_status();
+        return 0;
+    }
+
+    if (strcmp(cmd, "stats") == 0 && (n == 1 || (n == 2 && strcmp(arg, "orig") == 0))) {
+        return print_stats(n == 1);
+    }
+
+    if (strcmp(cmd, "lut") == 0 && (n == 2 || (n == 3 && strcmp(arg, "gamma") == 0))) {
+        double gamma = 0.0;
+        if (n == 3 && sscanf(mode, "%lf", &gamma) != 1) {
+            return -1;
+        }
+        return run_lut(arg, gamma);
+    }
+
+    if (strcmp(cmd, "orient") == 0 && n == 2) {
+        return run_orientation(arg);
+    }
+
+    if (strcmp(cmd, "scanout") == 0 && n == 2) {
+        return run_scanout(arg);
+    }
+
+    if (strcmp(cmd, "overlay") == 0) {
+        return run_overlay(text);
+    }
+
+    if (strcmp(cmd, "reset") == 0 && n == 1) {
+        g_zoom_offset_x = 0;
+        g_zoom_offset_y = 0;
+        return run_reset();
+    }
+
+    return -1;
+}
+
+int run_script(void) {
+    int repeat_left[MAX_SCRIPT_LINES];
+    int executed = 0;
+    double start = now_ms();
+
+    if (script_match_blocks() != 0) {
+        return -1;
+    }
+
+    printf("%12s  %-32s %12s\n", "t (ms)", "comando", "latencia (us)");
+    for (int pc = 0; pc < g_script_len; pc++) {
+        ScriptLine *line = &g_script[pc];
+
+        if (strncmp(line->text, "repeat", 6) == 0) {
+            int count;
+            if (sscanf(line->text, "repeat %d", &count) != 1 || count < 0) {
+                printf("Erro (linha %d): uso: repeat <N>\n", line->source_line);
+                return -1;
+            }
+            repeat_left[pc] = count;
+            if (count == 0) {
+                pc = line->match; // Pula o bloco
+            }
+            continue;
+        }
+        if (strcmp(line->text, "end") == 0) {
+            if (--repeat_left[line->match] > 0) {
+                pc = line->match; // Volta para o primeiro comando do bloco
+            }
+            continue;
+        }
+
+        double t0 = now_ms();
+        int status = script_run_command(line->text);
+        op_finish();
+        double t1 = now_ms();
+
+        if (status != 0) {
+            printf("Erro (linha %d): comando invalido ou falhou: '%s'\n", line->source_line, line->text);
+            return -1;
+        }
+        executed++;
+        printf("%12.3f  %-32s %12.1f\n", t0 - start, line->text, (t1 - t0) * 1000.0);
+    }
+
+    printf("Roteiro concluido: %d comandos em %.3f ms.\n", executed, now_ms() - start);
+    return 0;
+}
+
 // =================================================================
 // Função Principal (main)
 // =================================================================
 
+static void print_usage(const char *prog) {
+    printf("Uso: %s [-v] [-p P,E] [-r fit|fill] [-f gray|rgb332] [-w box|2x|bilinear] [-z] [-s roteiro.txt | -c \"cmd; cmd; ...\"]\n", prog);
+    printf("  Sem argumentos: modo interativo (teclado).\n");
+    printf("  -s <arquivo>  : executa os comandos do arquivo (modo roteiro).\n");
+    printf("  -c <comandos> : executa os comandos separados por ';'.\n");
+    printf("  -v            : confere cada operação com a referência do HPS.\n");
+    printf("  -p <P,E>      : fixa a leitura da imagem no núcleo P e o envio no núcleo E.\n");
+    printf("  -r fit|fill   : ajuste da imagem ao quadro (inteira com faixas / cortada); padrão fit.\n");
+    printf("  -f gray|rgb332: formato do pixel nas memórias (cinza ou cor RRRGGGBB); padrão gray.\n");
+    printf("  -w box|2x|bilinear: saída de vídeo (caixa 320x240 ou tela cheia 640x480); padrão box.\n");
+    printf("  -z            : monta a pirâmide de zoom out na FPGA após cada carga.\n");
+}
+
 int main(int argc, char *argv[]) {
+    const char *script_file = NULL;
+    const char *script_commands = NULL;
+    int verify = 0;
+
+    for (int i = 1; i < argc; i++) {
+        int producer_cpu, uploader_cpu;
+        if (strcmp(argv[i], "-v") == 0) {
+            verify = 1;
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc &&
+                   sscanf(argv[i + 1], "%d,%d", &producer_cpu, &uploader_cpu) == 2) {
+            upload_pipeline_set_cpus(producer_cpu, uploader_cpu);
+            i++;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc &&
+                   parse_resize_mode(argv[i + 1], &g_resize_mode) == 0) {
+            i++;
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc &&
+                   parse_pixel_format(argv[i + 1], &g_pixel_format) == 0) {
+            i++;
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc && find_scanout(argv[i + 1]) >= 0) {
+            g_scanout = (uint32_t)find_scanout(argv[++i]);
+        } else if (strcmp(argv[i], "-z") == 0) {
+            g_pyramid = 1;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            script_file = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            script_commands = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if ((script_file && script_load_file(script_file) != 0) ||
+        (script_commands && script_load_string(script_commands) != 0)) {
+        return 1;
+    }
     
     printf("=== Programa de Teste - Híbrido C + Assembly ===\n\n");
     
@@ -350,19 +1373,38 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    if (verify && coproc_verify_start() != 0) {
+        cleanup_memory_map();
+        return 1;
+    }
+    
     printf("Etapa 1.5: Enviando RESET inicial para FPGA...\n");
-    coproc_reset_image(); 
-    coproc_wait_done();   
-    printf("Reset inicial concluído.\n");
+    run_reset();
+    op_finish();
+    // Sempre enviados: a FPGA guarda o formato e a saída de vídeo da execução anterior
+    run_pixel_format(g_pixel_format);
+    run_orientation(g_orientations[g_orientation].name);
+    run_scanout(g_scanouts[g_scanout].name);
+    printf("Reset inicial concluído (pixels em %s).\n", (g_pixel_format == PIXEL_RGB332) ? "RGB332" : "cinza");
     
-    printf("\nEtapa 2: Entrando no modo interativo...\n");
-    printf("Nenhuma imagem carregada. Use [l] no menu para carregar.\n");
+    int status = 0;
+    if (script_file || script_commands) {
+        printf("\nEtapa 2: Executando roteiro (%d comandos)...\n", g_script_len);
+        status = (run_script() == 0) ? 0 : 1;
+    } else {
+        printf("\nEtapa 2: Entrando no modo interativo...\n");
+        printf("Nenhuma imagem carregada. Use [l] no menu para carregar.\n");
     
-    enter_control_loop(); 
+        enter_control_loop(); 
+    }
+
+    if (coproc_verify_stop() != 0) {
+        status = 1;
+    }
 
     printf("\nEtapa 3: Limpando recursos (via ASM)...\n");
     cleanup_memory_map(); 
     printf("Programa encerrado. Configurações do terminal restauradas.\n");
     
-    return 0;
+    return status;
 }
\ No newline at end of file
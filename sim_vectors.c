@@ -0,0 +1,112 @@
+/*
+ * =================================================================
+ * sim_vectors.c
+ * =================================================================
+ * Vetores do testbench do motor de faixas (make sim_vectors).
+ *
+ * Roda no modelo em software (coproc_model.c) a mesma sequência que o
+ * Coprocessador/sim/tb_lanes.v envia ao main.v e grava, em hexadecimal
+ * ($readmemh), o que o testbench precisa para comparar byte a byte:
+ *
+ *   imagem.hex     : os 76.800 pixels enviados com STORE
+ *   instrucoes.hex : as instruções enviadas depois da imagem (RESET,
+ *                    CTRL_SET_ZOOM em todos os níveis com os dois
+ *                    algoritmos de cada lado, e o BA em RGB332)
+ *   esperado.hex   : a mem3 do modelo depois de cada instrução
+ *                    (76.800 pixels por instrução, na mesma ordem)
+ *
+ * Uso: ./sim_vectors [diretório] (padrão: Coprocessador/sim)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "constantes.h"
+#include "api_fpga.h"
+
+#define SIM_WIDTH  320
+#define SIM_HEIGHT 240
+#define SIM_PIXELS (SIM_WIDTH * SIM_HEIGHT)
+
+// Offsets diferentes de zero e no limite de cada nível de zoom in
+static const uint32_t g_instructions[] = {
+    OP_RESET,
+    SET_ZOOM_INSTRUCTION(ZOOM_2X,   OP_PR_ALG,  40,  30),
+    SET_ZOOM_INSTRUCTION(ZOOM_2X,   OP_NHI_ALG, 160, 120),
+    SET_ZOOM_INSTRUCTION(ZOOM_4X,   OP_PR_ALG,  240, 180),
+    SET_ZOOM_INSTRUCTION(ZOOM_4X,   OP_NHI_ALG, 101, 7),
+    SET_ZOOM_INSTRUCTION(ZOOM_8X,   OP_PR_ALG,  280, 210),
+    SET_ZOOM_INSTRUCTION(ZOOM_8X,   OP_NHI_ALG, 13,  99),
+    SET_ZOOM_INSTRUCTION(ZOOM_1X,   OP_PR_ALG,  0,   0),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_2X, OP_BA_ALG,  0,   0),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_2X, OP_NH_ALG,  0,   0),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_4X, OP_BA_ALG,  0,   0),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_4X, OP_NH_ALG,  0,   0),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_8X, OP_BA_ALG,  0,   0),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_8X, OP_NH_ALG,  0,   0),
+    CONFIG_INSTRUCTION(CONFIG_PIXEL_FORMAT, PIXEL_RGB332),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_2X, OP_BA_ALG,  0,   0),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_4X, OP_BA_ALG,  0,   0),
+    SET_ZOOM_INSTRUCTION(ZOOM_1_8X, OP_BA_ALG,  0,   0),
+};
+#define NUM_INSTRUCTIONS ((int)(sizeof(g_instructions) / sizeof(g_instructions[0])))
+
+static uint8_t g_image[SIM_PIXELS];
+static uint8_t g_mem3[SIM_PIXELS];
+
+static uint32_t rng_state = 12345;
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static FILE *open_vector(const char *dir, const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    return f;
+}
+
+int main(int argc, char **argv) {
+    const char *dir = argc > 1 ? argv[1] : "Coprocessador/sim";
+
+    if (setup_memory_map() != 0) return 1;
+
+    // Imagem aleatória: cada pixel diferente dos vizinhos expõe erro de endereço
+    FILE *image = open_vector(dir, "imagem.hex");
+    for (uint32_t i = 0; i < SIM_PIXELS; i++) {
+        g_image[i] = (uint8_t)(rng_next() >> 24);
+        coproc_write_pixel(i, g_image[i]);
+        fprintf(image, "%02x\n", g_image[i]);
+    }
+    fclose(image);
+
+    FILE *instructions = open_vector(dir, "instrucoes.hex");
+    FILE *expected = open_vector(dir, "esperado.hex");
+    for (int k = 0; k < NUM_INSTRUCTIONS; k++) {
+        coproc_issue(g_instructions[k]);
+        if (coproc_get_status() & FLAG_ERROR_MASK) {
+            fprintf(stderr, "Instrução %d (0x%08x) recusada pelo modelo.\n", k, g_instructions[k]);
+            return 1;
+        }
+        coproc_read_block(0, SIM_PIXELS, 1, g_mem3);
+        fprintf(instructions, "%08x\n", g_instructions[k]);
+        for (uint32_t i = 0; i < SIM_PIXELS; i++) {
+            fprintf(expected, "%02x\n", g_mem3[i]);
+        }
+    }
+    fclose(instructions);
+    fclose(expected);
+
+    cleanup_memory_map();
+    printf("%d instruções e %d x %d pixels esperados em %s\n",
+           NUM_INSTRUCTIONS, NUM_INSTRUCTIONS, SIM_PIXELS, dir);
+    return 0;
+}
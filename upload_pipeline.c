@@ -0,0 +1,158 @@
+/*
+ * =================================================================
+ * upload_pipeline.c
+ * =================================================================
+ * Implementação do pipeline descrito em upload_pipeline.h.
+ *
+ * Buffer circular SPSC: head só é escrito pela produtora e tail só pela
+ * thread de envio, cada um na sua linha de cache. A produtora grava o
+ * trecho e publica head com "release"; o envio lê head com "acquire"
+ * (e vice-versa para tail), então os trechos nunca são lidos pela metade
+ * e não há trava nem chamada de sistema no caminho normal. Quando um
+ * lado precisa esperar, ele gira algumas vezes e depois cede o núcleo.
+ */
+
+#define _GNU_SOURCE // pthread_setaffinity_np
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "coproc_verify.h"
+#include "mem1_shadow.h"
+#include "upload_pipeline.h"
+
+#define RING_SLOTS      8 // Potência de 2
+#define RING_MASK       (RING_SLOTS - 1)
+#define CACHE_LINE      64
+#define SPINS_BEFORE_YIELD 64
+
+typedef struct {
+    UploadRow slots[RING_SLOTS];
+    uint32_t  head __attribute__((aligned(CACHE_LINE))); // Trechos publicados
+    uint32_t  tail __attribute__((aligned(CACHE_LINE))); // Trechos enviados
+    int       finished; // Produtora terminou: 1 (fim) ou -1 (erro)
+
+    UploadProducer producer;
+    void          *ctx;
+    int            producer_cpu;
+} UploadRing;
+
+static int g_producer_cpu = -1;
+static int g_uploader_cpu = -1;
+
+// =================================================================
+// Utilidades
+// =================================================================
+static void pin_to_cpu(pthread_t thread, int cpu) {
+    if (cpu < 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(thread, sizeof(set), &set) != 0) {
+        fprintf(stderr, "Aviso: não foi possível fixar a thread no núcleo %d.\n", cpu);
+    }
+}
+
+static inline void backoff(int *spins) {
+    if (++*spins >= SPINS_BEFORE_YIELD) {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+// =================================================================
+// Estágio 1: produtora
+// =================================================================
+static void *producer_thread(void *arg) {
+    UploadRing *ring = arg;
+    uint32_t head = 0;
+    int status;
+
+    pin_to_cpu(pthread_self(), ring->producer_cpu);
+
+    while (1) {
+        int spins = 0;
+        while (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == RING_SLOTS) {
+            backoff(&spins);
+        }
+
+        status = ring->producer(ring->ctx, &ring->slots[head & RING_MASK]);
+        if (status <= 0) {
+            break;
+        }
+        __atomic_store_n(&ring->head, ++head, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&ring->finished, (status < 0) ? -1 : 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// =================================================================
+// Estágio 2: envio (thread que chama)
+// =================================================================
+void upload_pipeline_set_cpus(int producer_cpu, int uploader_cpu) {
+    g_producer_cpu = producer_cpu;
+    g_uploader_cpu = uploader_cpu;
+}
+
+long upload_pipeline_run(UploadProducer producer, void *ctx) {
+    static UploadRing ring; // Um envio por vez: só a dona do coprocessador chama
+    pthread_t thread;
+    cpu_set_t saved_cpus;
+    int restore_cpus = 0;
+    uint32_t tail = 0, next_report = 10;
+    long sent = 0;
+
+    memset(&ring, 0, sizeof(ring));
+    ring.producer = producer;
+    ring.ctx = ctx;
+    ring.producer_cpu = g_producer_cpu;
+
+    if (g_uploader_cpu >= 0 && pthread_getaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus) == 0) {
+        restore_cpus = 1;
+        pin_to_cpu(pthread_self(), g_uploader_cpu);
+    }
+
+    if (pthread_create(&thread, NULL, producer_thread, &ring) != 0) {
+        perror("Erro ao criar a thread de leitura");
+        if (restore_cpus) {
+            pthread_setaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus);
+        }
+        return -1;
+    }
+
+    while (1) {
+        int spins = 0;
+        while (tail == __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE)) {
+            // finished é publicado depois do último head: relê head antes de sair
+            if (__atomic_load_n(&ring.finished, __ATOMIC_ACQUIRE) &&
+                tail == __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE)) {
+                goto done;
+            }
+            backoff(&spins);
+        }
+
+        const UploadRow *row = &ring.slots[tail & RING_MASK];
+        sent += mem1_shadow_write(row->address, row->pixels, row->count);
+        for (uint32_t i = 0; i < row->count; i++) {
+            coproc_verify_store(row->address + i, row->pixels[i]);
+        }
+        while (row->progress >= next_report && next_report < 100) {
+            printf("Progresso: %u%%\n", next_report);
+            next_report += 10;
+        }
+
+        __atomic_store_n(&ring.tail, ++tail, __ATOMIC_RELEASE);
+    }
+
+done:
+    pthread_join(thread, NULL);
+    if (restore_cpus) {
+        pthread_setaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus);
+    }
+    return (ring.finished < 0) ? -1 : sent;
+}
@@ -0,0 +1,43 @@
+#ifndef UPLOAD_PIPELINE_H
+#define UPLOAD_PIPELINE_H
+
+/*
+ * =================================================================
+ * Pipeline de envio de imagens (leitura || transferência)
+ * =================================================================
+ * Divide o carregamento em dois estágios ligados por um buffer circular
+ * de trechos de linha, com um único produtor e um único consumidor
+ * (sem travas):
+ *
+ *   produtora (thread nova) : lê e converte o arquivo (UploadProducer)
+ *   envio (thread que chama): envia à mem1 o que mudou em cada trecho
+ *                             (mem1_shadow.c)
+ *
+ * O envio fica na thread que chama porque ela é a dona do coprocessador
+ * (nenhuma outra operação é enviada enquanto a função não retorna).
+ * Assim a leitura do arquivo e a conversão se sobrepõem às
+ * transferências no barramento, e o tempo total é o do estágio mais
+ * lento. Opcionalmente cada estágio é fixado num núcleo do Cortex-A9.
+ */
+
+#include <stdint.h>
+
+#define UPLOAD_ROW_MAX 1024 // Pixels por trecho
+
+typedef struct {
+    uint32_t address;  // Endereço do primeiro pixel na mem1
+    uint32_t count;    // Nº de pixels do trecho (0: nada a enviar)
+    uint32_t progress; // Progresso da leitura (0 a 100), para o relatório
+    uint8_t  pixels[UPLOAD_ROW_MAX];
+} UploadRow;
+
+// Roda na thread produtora: preenche row e retorna 1; 0 no fim; -1 em erro
+typedef int (*UploadProducer)(void *ctx, UploadRow *row);
+
+// Núcleos de cada estágio (-1: sem afinidade); padrão -1, -1
+void upload_pipeline_set_cpus(int producer_cpu, int uploader_cpu);
+
+// Retorna o nº de pixels enviados (só os alterados), ou -1 se a produtora falhou
+long upload_pipeline_run(UploadProducer producer, void *ctx);
+
+#endif // UPLOAD_PIPELINE_H
@@ -0,0 +1,313 @@
+/*
+ * =================================================================
+ * zoom_bench.c
+ * =================================================================
+ * Verificação e microbenchmark dos algoritmos de zoom no HPS
+ * (zoom_host.c), make bench_zoom.
+ *
+ * 1. Conferência com o coprocessador: envia uma imagem aleatória,
+ *    percorre zoom in, pan (inclusive com deslocamentos que saem do
+ *    quadro) e zoom out pela API e compara a mem3 lida com LOAD com a
+ *    saída de zoom_host_run e de zoom_host_run_scalar, byte a byte.
+ *    O zoom out com BA é conferido também em RGB332.
+ *    Na placa a referência é o próprio main.v; no PC, coproc_model.c.
+ * 2. Conferência vetor x escalar em deslocamentos aleatórios.
+ * 3. Tempo (mediana) de cada algoritmo/nível nas duas versões.
+ *
+ * Termina com código 1 se houver qualquer divergência.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "constantes.h"
+#include "api_fpga.h"
+#include "zoom_host.h"
+
+#ifndef COPROC_BACKEND
+#define COPROC_BACKEND "fpga"
+#endif
+
+#define NUM_PIXELS        ZOOM_HOST_PIXELS
+#define RANDOM_CASES      2000
+#define DEFAULT_ITERATIONS 200
+
+typedef struct {
+    const char *name;
+    uint32_t    algorithm;
+    uint32_t    level;
+    uint32_t    pixel_format;
+} KernelCase;
+
+static const KernelCase g_kernels[] = {
+    { "pr_2x",     OP_PR_ALG,  ZOOM_2X,   PIXEL_GRAY8  },
+    { "pr_4x",     OP_PR_ALG,  ZOOM_4X,   PIXEL_GRAY8  },
+    { "pr_8x",     OP_PR_ALG,  ZOOM_8X,   PIXEL_GRAY8  },
+    { "nhi_2x",    OP_NHI_ALG, ZOOM_2X,   PIXEL_GRAY8  },
+    { "nhi_4x",    OP_NHI_ALG, ZOOM_4X,   PIXEL_GRAY8  },
+    { "nhi_8x",    OP_NHI_ALG, ZOOM_8X,   PIXEL_GRAY8  },
+    { "ba_1_2",    OP_BA_ALG,  ZOOM_1_2X, PIXEL_GRAY8  },
+    { "ba_1_4",    OP_BA_ALG,  ZOOM_1_4X, PIXEL_GRAY8  },
+    { "ba_1_8",    OP_BA_ALG,  ZOOM_1_8X, PIXEL_GRAY8  },
+    { "nh_1_2",    OP_NH_ALG,  ZOOM_1_2X, PIXEL_GRAY8  },
+    { "nh_1_4",    OP_NH_ALG,  ZOOM_1_4X, PIXEL_GRAY8  },
+    { "nh_1_8",    OP_NH_ALG,  ZOOM_1_8X, PIXEL_GRAY8  },
+    { "pr_1x",     OP_PR_ALG,  ZOOM_1X,   PIXEL_GRAY8  }, // Pan em 1x (s = 0)
+    { "nhi_1x",    OP_NHI_ALG, ZOOM_1X,   PIXEL_GRAY8  },
+    { "ba332_1_2", OP_BA_ALG,  ZOOM_1_2X, PIXEL_RGB332 },
+    { "ba332_1_4", OP_BA_ALG,  ZOOM_1_4X, PIXEL_RGB332 },
+    { "ba332_1_8", OP_BA_ALG,  ZOOM_1_8X, PIXEL_RGB332 },
+};
+#define NUM_KERNELS ((int)(sizeof(g_kernels) / sizeof(g_kernels[0])))
+
+static uint8_t g_image[NUM_PIXELS];
+static uint8_t g_before[NUM_PIXELS]; // mem3 antes da operação
+static uint8_t g_hw[NUM_PIXELS];
+static uint8_t g_vec[NUM_PIXELS];
+static uint8_t g_ref[NUM_PIXELS];
+static int     g_failures;
+static uint32_t g_pixel_format = PIXEL_GRAY8; // Formato enviado ao coprocessador
+
+// =================================================================
+// Utilidades
+// =================================================================
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static uint32_t rng_state = 12345;
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void read_mem3(uint8_t *out) {
+    for (uint32_t address = 0; address < NUM_PIXELS; address++) {
+        out[address] = coproc_read_pixel(address, 1);
+        coproc_wait_done();
+    }
+}
+
+static void report_mismatch(const char *what, const char *label, const uint8_t *got, const uint8_t *expected) {
+    int mismatches = 0, first = -1;
+    for (int i = 0; i < NUM_PIXELS; i++) {
+        if (got[i] != expected[i]) {
+            if (first < 0) first = i;
+            mismatches++;
+        }
+    }
+    if (mismatches) {
+        printf("  DIVERGENCIA %-8s %-28s: %d pixels; primeiro em (%d,%d): %u != %u\n",
+               what, label, mismatches, first % ZOOM_HOST_WIDTH, first / ZOOM_HOST_WIDTH,
+               got[first], expected[first]);
+        g_failures++;
+    }
+}
+
+// =================================================================
+// 1. Conferência com o coprocessador (main.v ou modelo)
+// =================================================================
+// A palavra de status deve mostrar o nível, os offsets latchados e uma
+// única instrução aceita desde a leitura anterior
+static void check_status(const char *label, uint32_t level, uint32_t x, uint32_t y, uint32_t seq) {
+    uint32_t status = coproc_get_status();
+    if (STATUS_FIELD(status, ZOOM) != level || STATUS_FIELD(status, X) != (x & STATUS_X_MASK) ||
+        STATUS_FIELD(status, Y) != y || STATUS_FIELD(status, SEQ) != seq ||
+        STATUS_FIELD(status, STATE) != 0) {
+        printf("  DIVERGENCIA status   %-28s: nivel=%u (%u,%u) seq=%u estado=%u\n", label,
+               (unsigned)STATUS_FIELD(status, ZOOM), (unsigned)STATUS_FIELD(status, X),
+               (unsigned)STATUS_FIELD(status, Y), (unsigned)STATUS_FIELD(status, SEQ),
+               (unsigned)STATUS_FIELD(status, STATE));
+        g_failures++;
+    }
+}
+
+// Executa uma instrução de zoom e compara a mem3 com as duas versões
+static void check_hw(uint32_t algorithm, uint32_t level, uint32_t x, uint32_t y, int pan) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s alg=%u nivel=%u (%u,%u)", pan ? "pan" : "zoom", algorithm, level, x, y);
+
+    read_mem3(g_before);
+    uint32_t seq = STATUS_FIELD(coproc_get_status(), SEQ);
+    if (pan) {
+        coproc_pan_zoom_with_offset(algorithm, x, y);
+    } else {
+        coproc_apply_zoom_with_offset(algorithm, x, y);
+    }
+    coproc_wait_done();
+    check_status(label, level, x, y, (seq + 1) & STATUS_SEQ_MASK);
+    read_mem3(g_hw);
+
+    memcpy(g_vec, g_before, NUM_PIXELS);
+    memcpy(g_ref, g_before, NUM_PIXELS);
+    zoom_host_run(g_vec, g_image, algorithm, level, x, y, g_pixel_format);
+    zoom_host_run_scalar(g_ref, g_image, algorithm, level, x, y, g_pixel_format);
+    report_mismatch("vetor", label, g_vec, g_hw);
+    report_mismatch("escalar", label, g_ref, g_hw);
+}
+
+static void reset_image(void) {
+    coproc_reset_image();
+    coproc_wait_done();
+}
+
+static void set_pixel_format(uint32_t format) {
+    coproc_set_pixel_format(format);
+    g_pixel_format = format;
+}
+
+static void verify_against_hw(void) {
+    static const uint32_t pans[][2] = { { 10, 0 }, { 150, 110 }, { 319, 239 }, { 1000, 255 }, { 600, 3 } };
+    const int num_pans = (int)(sizeof(pans) / sizeof(pans[0]));
+    static const uint32_t zoom_in[] = { OP_PR_ALG, OP_NHI_ALG };
+    static const uint32_t zoom_out[] = { OP_BA_ALG, OP_NH_ALG };
+    int checks = 0;
+
+    for (uint32_t address = 0; address < NUM_PIXELS; address++) {
+        coproc_write_pixel(address, g_image[address]);
+        coproc_wait_done();
+    }
+
+    for (int a = 0; a < 2; a++) {
+        // Zoom in até 8x, com pan em cada nível
+        reset_image();
+        for (uint32_t level = ZOOM_2X; level <= ZOOM_8X; level++) {
+            check_hw(zoom_in[a], level, 40 * (level - ZOOM_1X), 7 * (level - ZOOM_1X), 0);
+            for (int p = 0; p < num_pans; p++) {
+                check_hw(zoom_in[a], level, pans[p][0], pans[p][1], 1);
+            }
+            checks += 1 + num_pans;
+        }
+
+        // Zoom out até 1/8 e, de volta, zoom in com s = 0 (1/8 -> 1/4 -> 1/2)
+        reset_image();
+        for (uint32_t level = ZOOM_1_2X; level >= ZOOM_1_8X; level--) {
+            check_hw(zoom_out[a], level, 0, 0, 0);
+            checks++;
+        }
+        check_hw(zoom_in[a], ZOOM_1_4X, 33, 17, 0);
+        check_hw(zoom_in[a], ZOOM_1_2X, 0, 0, 0);
+        check_hw(zoom_in[a], ZOOM_1_2X, 200, 100, 1);
+        checks += 3;
+
+        // Pan em 1x
+        reset_image();
+        check_hw(zoom_in[a], ZOOM_1X, 25, 9, 1);
+        checks++;
+    }
+
+    // BA com média por canal
+    set_pixel_format(PIXEL_RGB332);
+    reset_image();
+    for (uint32_t level = ZOOM_1_2X; level >= ZOOM_1_8X; level--) {
+        check_hw(OP_BA_ALG, level, 0, 0, 0);
+        checks++;
+    }
+    set_pixel_format(PIXEL_GRAY8);
+    reset_image();
+    printf("Coprocessador (%s): %d operações conferidas.\n", COPROC_BACKEND, checks);
+}
+
+// =================================================================
+// 2. Vetor x escalar em deslocamentos aleatórios
+// =================================================================
+static void verify_random(void) {
+    for (int i = 0; i < RANDOM_CASES; i++) {
+        const KernelCase *k = &g_kernels[rng_next() % NUM_KERNELS];
+        uint32_t x = rng_next() & 0x1FFFF, y = rng_next() & 0xFF;
+        char label[64];
+
+        for (int p = 0; p < NUM_PIXELS; p++) {
+            g_vec[p] = g_ref[p] = (uint8_t)p;
+        }
+        zoom_host_run(g_vec, g_image, k->algorithm, k->level, x, y, k->pixel_format);
+        zoom_host_run_scalar(g_ref, g_image, k->algorithm, k->level, x, y, k->pixel_format);
+        snprintf(label, sizeof(label), "%s (%u,%u)", k->name, x, y);
+        report_mismatch("aleatorio", label, g_vec, g_ref);
+    }
+    printf("Vetor x escalar: %d casos aleatórios conferidos.\n", RANDOM_CASES);
+}
+
+// =================================================================
+// 3. Microbenchmark
+// =================================================================
+typedef int (*ZoomFn)(uint8_t *, const uint8_t *, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+
+static double median_us(ZoomFn fn, const KernelCase *k, int iterations, double *samples) {
+    for (int i = 0; i < iterations; i++) {
+        double t0 = now_us();
+        fn(g_vec, g_image, k->algorithm, k->level, 10, 10, k->pixel_format);
+        samples[i] = now_us() - t0;
+    }
+    qsort(samples, iterations, sizeof(double), compare_double);
+    return samples[iterations / 2];
+}
+
+static void run_benchmark(int iterations) {
+    double *samples = malloc(sizeof(double) * iterations);
+
+    printf("\n%-9s %12s %12s %9s   (mediana de %d, SIMD: %s)\n",
+           "caso", "escalar_us", "simd_us", "ganho", iterations, zoom_host_isa());
+    for (int c = 0; c < NUM_KERNELS; c++) {
+        double scalar = median_us(zoom_host_run_scalar, &g_kernels[c], iterations, samples);
+        double simd = median_us(zoom_host_run, &g_kernels[c], iterations, samples);
+        printf("%-9s %12.2f %12.2f %8.1fx\n", g_kernels[c].name, scalar, simd, simd > 0 ? scalar / simd : 0);
+    }
+    free(samples);
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = DEFAULT_ITERATIONS;
+    int hw_check = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-q") == 0) {
+            hw_check = 0;
+        } else {
+            printf("Uso: %s [-n iteracoes] [-q]\n", argv[0]);
+            printf("  -n : repetições por caso no benchmark (padrão %d)\n", DEFAULT_ITERATIONS);
+            printf("  -q : não confere com o coprocessador (só vetor x escalar)\n");
+            return 1;
+        }
+    }
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    for (int p = 0; p < NUM_PIXELS; p++) {
+        g_image[p] = (uint8_t)rng_next();
+    }
+
+    if (hw_check) {
+        if (setup_memory_map() != 0) {
+            printf("Falha ao mapear a memória de hardware.\n");
+            return 1;
+        }
+        verify_against_hw();
+        cleanup_memory_map();
+    }
+    verify_random();
+    run_benchmark(iterations);
+
+    if (g_failures) {
+        printf("\n%d divergência(s) encontrada(s).\n", g_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,558 @@
+/*
+ * =================================================================
+ * zoom_host.c
+ * =================================================================
+ * Implementação dos algoritmos de zoom no HPS (ver zoom_host.h).
+ *
+ * A FSM do main.v percorre a saída pixel a pixel, mas o mapeamento
+ * destino -> origem que ela produz é separável por linha:
+ *
+ *   PR/NHI (nível 2^s, atraso L = 2 no PR e 1 no NHI):
+ *     coluna(x) = x < L ? x_off : ((x & ~(L-1)) - 1) >> s) + x_off
+ *     linha(y)  = y < L ? y_off : ((y & ~(L-1)) - 1) >> s) + y_off
+ *     Com s = 0 (zoom in até 1x ou pan em <= 1x) o deslocamento só vale
+ *     na primeira linha e o primeiro pixel das demais vem da coluna 319
+ *     da linha anterior.
+ *   NH/BA (nível 1/2^s): janela central de (320>>s) x (240>>s); o pixel
+ *     (wx, wy) da janela lê (wx<<s, wy<<s); o BA combina esse pixel com
+ *     o vizinho a +2^(s-1) à direita: (p0 >> 2) | (p1 << 6) em cinza, ou
+ *     a média truncada de cada canal em RGB332.
+ *
+ * A versão vetorizada monta cada linha distinta uma única vez
+ * (replicação ou decimação de bytes em registradores SIMD) e a copia
+ * para as linhas repetidas. Linhas cujo mapeamento sai do quadro ou dá
+ * a volta nos registradores de 10/17 bits caem no caminho pixel a
+ * pixel, que segue as mesmas regras de leitura do hardware.
+ */
+
+#include <string.h>
+
+#include "constantes.h"
+#include "zoom_host.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ZOOM_ISA  "neon"
+#define ZVEC      16
+typedef uint8x16_t zvec;
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define ZOOM_ISA  "avx2"
+#define ZVEC      32
+typedef __m256i zvec;
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ZOOM_ISA  "sse2"
+#define ZVEC      16
+typedef __m128i zvec;
+#else
+#define ZOOM_ISA  "escalar"
+#endif
+
+#define W           ZOOM_HOST_WIDTH
+#define H           ZOOM_HOST_HEIGHT
+#define COORD_MASK  0x3FF   // old_x/old_y de 10 bits
+#define ADDR_MASK   0x1FFFF // Endereços de 17 bits
+#define LINE_SLACK  16      // Folga para a replicação passar do fim da linha
+// RGB332 (RRRGGGBB): bits que continuam no mesmo canal depois de >> 1
+#define RGB332_HALF_MASK 0x6D
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+// =================================================================
+// Regras do hardware
+// =================================================================
+static inline uint32_t address_of(uint32_t x, uint32_t y) {
+    return ((x & COORD_MASK) + (y & COORD_MASK) * W) & ADDR_MASK;
+}
+
+// Endereços fora da mem1 são lidos como zero
+static inline uint8_t src_read(const uint8_t *src, uint32_t address) {
+    return (address < ZOOM_HOST_PIXELS) ? src[address] : 0;
+}
+
+static uint32_t zoom_in_shift(uint32_t level) {
+    switch (level) {
+        case ZOOM_2X: return 1;
+        case ZOOM_4X: return 2;
+        case ZOOM_8X: return 3;
+        default:      return 0;
+    }
+}
+
+// 0 se o nível não tem ramo de zoom out no main.v
+static uint32_t zoom_out_shift(uint32_t level) {
+    switch (level) {
+        case ZOOM_1_2X: return 1;
+        case ZOOM_1_4X: return 2;
+        case ZOOM_1_8X: return 3;
+        default:        return 0;
+    }
+}
+
+static inline uint32_t zoom_in_row(uint32_t lag, uint32_t shift, uint32_t y_off, uint32_t y) {
+    uint32_t by = y & ~(lag - 1);
+    if (y < lag) {
+        return y_off;
+    }
+    return shift ? ((by - 1) >> shift) + y_off : by - 1;
+}
+
+static inline uint32_t zoom_in_col(uint32_t lag, uint32_t shift, uint32_t x_off, uint32_t x, uint32_t y) {
+    uint32_t bx = x & ~(lag - 1);
+    if (x < lag) {
+        return (shift || y < lag) ? x_off : W - 1;
+    }
+    return shift ? ((bx - 1) >> shift) + x_off : bx - 1;
+}
+
+static inline uint8_t zoom_in_pixel(const uint8_t *src, uint32_t lag, uint32_t shift,
+                                    uint32_t x_off, uint32_t y_off, uint32_t x, uint32_t y) {
+    return src_read(src, address_of(zoom_in_col(lag, shift, x_off, x, y), zoom_in_row(lag, shift, y_off, y)));
+}
+
+static inline int outside_window(uint32_t shift, uint32_t x, uint32_t y) {
+    uint32_t x0 = (W - (W >> shift)) / 2, y0 = (H - (H >> shift)) / 2;
+    return x < x0 || x >= x0 + (W >> shift) || y < y0 || y >= y0 + (H >> shift);
+}
+
+// ba_pixel do main.v. Em RGB332, (a & b) + ((a ^ b) >> 1) por canal: a
+// máscara tira o bit que passaria de um canal para o vizinho
+static inline uint8_t ba_pixel(uint8_t p0, uint8_t p1, int rgb332) {
+    if (rgb332) {
+        return (uint8_t)((p0 & p1) + (((p0 ^ p1) >> 1) & RGB332_HALF_MASK));
+    }
+    // data_to_write <= data_to_avg >> 2 (só p0 e p1 chegam aos 8 bits)
+    return (uint8_t)((p0 >> 2) | (p1 << 6));
+}
+
+static inline uint8_t zoom_out_pixel(const uint8_t *src, uint32_t algorithm, uint32_t shift, int rgb332,
+                                     uint32_t x, uint32_t y) {
+    if (outside_window(shift, x, y)) {
+        return 0;
+    }
+    uint32_t wx = x - (W - (W >> shift)) / 2, wy = y - (H - (H >> shift)) / 2;
+    uint32_t base = ((wx << shift) + (wy << shift) * W) & ADDR_MASK;
+    if (algorithm == OP_NH_ALG) {
+        return src_read(src, base);
+    }
+    return ba_pixel(src_read(src, base), src_read(src, base + (1u << (shift - 1))), rgb332);
+}
+
+static int validate(uint32_t algorithm, uint32_t level) {
+    switch (algorithm) {
+        case OP_PR_ALG:
+        case OP_NHI_ALG: return (level >= ZOOM_1_8X && level <= ZOOM_8X) ? 0 : -1;
+        case OP_BA_ALG:
+        case OP_NH_ALG:  return zoom_out_shift(level) ? 0 : -1;
+        default:         return -1;
+    }
+}
+
+// PR escreve o quadro inteiro; NHI/BA/NH param em 76799 passos
+static inline uint32_t written_pixels(uint32_t algorithm) {
+    return (algorithm == OP_PR_ALG) ? ZOOM_HOST_PIXELS : ZOOM_HOST_PIXELS - 1;
+}
+
+// =================================================================
+// Versão escalar (referência)
+// =================================================================
+int zoom_host_run_scalar(uint8_t *dst, const uint8_t *src, uint32_t algorithm, uint32_t level,
+                         uint32_t x_offset, uint32_t y_offset, uint32_t pixel_format) {
+    if (validate(algorithm, level) != 0) {
+        return -1;
+    }
+
+    uint32_t count = written_pixels(algorithm);
+    if (algorithm == OP_PR_ALG || algorithm == OP_NHI_ALG) {
+        uint32_t lag = (algorithm == OP_PR_ALG) ? 2 : 1;
+        uint32_t shift = zoom_in_shift(level);
+        for (uint32_t address = 0; address < count; address++) {
+            dst[address] = zoom_in_pixel(src, lag, shift, x_offset & COORD_MASK, y_offset & 0xFF,
+                                         address % W, address / W);
+        }
+    } else {
+        uint32_t shift = zoom_out_shift(level);
+        for (uint32_t address = 0; address < count; address++) {
+            dst[address] = zoom_out_pixel(src, algorithm, shift, pixel_format == PIXEL_RGB332,
+                                          address % W, address / W);
+        }
+    }
+    return 0;
+}
+
+// =================================================================
+// Primitivas SIMD
+// =================================================================
+#ifdef ZVEC
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+ALWAYS_INLINE zvec vload(const uint8_t *p) { return vld1q_u8(p); }
+ALWAYS_INLINE void vstore(uint8_t *p, zvec v) { vst1q_u8(p, v); }
+// Bytes de índice par da concatenação a:b
+ALWAYS_INLINE zvec vpack_even(zvec a, zvec b) { return vuzpq_u8(a, b).val[0]; }
+// Cada byte de v duas vezes: lo recebe a primeira metade, hi a segunda
+ALWAYS_INLINE void vzip_self(zvec v, zvec *lo, zvec *hi) {
+    uint8x16x2_t z = vzipq_u8(v, v);
+    *lo = z.val[0];
+    *hi = z.val[1];
+}
+ALWAYS_INLINE zvec vblock_average(zvec p0, zvec p1) { return vsliq_n_u8(vshrq_n_u8(p0, 2), p1, 6); }
+ALWAYS_INLINE zvec vblock_average_rgb332(zvec p0, zvec p1) {
+    return vaddq_u8(vandq_u8(p0, p1), vandq_u8(vshrq_n_u8(veorq_u8(p0, p1), 1), vdupq_n_u8(RGB332_HALF_MASK)));
+}
+
+#elif defined(__AVX2__)
+ALWAYS_INLINE zvec vload(const uint8_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+ALWAYS_INLINE void vstore(uint8_t *p, zvec v) { _mm256_storeu_si256((__m256i *)p, v); }
+ALWAYS_INLINE zvec vpack_even(zvec a, zvec b) {
+    __m256i mask = _mm256_set1_epi16(0x00FF);
+    // packus trabalha por metade de 128 bits; o permute reordena as metades
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask)), 0xD8);
+}
+ALWAYS_INLINE void vzip_self(zvec v, zvec *lo, zvec *hi) {
+    __m256i l = _mm256_unpacklo_epi8(v, v), h = _mm256_unpackhi_epi8(v, v);
+    *lo = _mm256_permute2x128_si256(l, h, 0x20);
+    *hi = _mm256_permute2x128_si256(l, h, 0x31);
+}
+ALWAYS_INLINE zvec vblock_average(zvec p0, zvec p1) {
+    return _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(p0, 2), _mm256_set1_epi8(0x3F)),
+                           _mm256_and_si256(_mm256_slli_epi16(p1, 6), _mm256_set1_epi8((char)0xC0)));
+}
+// O deslocamento é de 16 bits: a máscara também limpa o bit 7, vindo do byte vizinho
+ALWAYS_INLINE zvec vblock_average_rgb332(zvec p0, zvec p1) {
+    __m256i half = _mm256_and_si256(_mm256_srli_epi16(_mm256_xor_si256(p0, p1), 1), _mm256_set1_epi8(RGB332_HALF_MASK));
+    return _mm256_add_epi8(_mm256_and_si256(p0, p1), half);
+}
+
+#else // SSE2
+ALWAYS_INLINE zvec vload(const uint8_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+ALWAYS_INLINE void vstore(uint8_t *p, zvec v) { _mm_storeu_si128((__m128i *)p, v); }
+ALWAYS_INLINE zvec vpack_even(zvec a, zvec b) {
+    __m128i mask = _mm_set1_epi16(0x00FF);
+    return _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+}
+ALWAYS_INLINE void vzip_self(zvec v, zvec *lo, zvec *hi) {
+    *lo = _mm_unpacklo_epi8(v, v);
+    *hi = _mm_unpackhi_epi8(v, v);
+}
+ALWAYS_INLINE zvec vblock_average(zvec p0, zvec p1) {
+    return _mm_or_si128(_mm_and_si128(_mm_srli_epi16(p0, 2), _mm_set1_epi8(0x3F)),
+                        _mm_and_si128(_mm_slli_epi16(p1, 6), _mm_set1_epi8((char)0xC0)));
+}
+ALWAYS_INLINE zvec vblock_average_rgb332(zvec p0, zvec p1) {
+    __m128i half = _mm_and_si128(_mm_srli_epi16(_mm_xor_si128(p0, p1), 1), _mm_set1_epi8(RGB332_HALF_MASK));
+    return _mm_add_epi8(_mm_and_si128(p0, p1), half);
+}
+#endif
+
+// ZVEC bytes p[k << shift]; lê (ZVEC << shift) bytes a partir de p
+ALWAYS_INLINE zvec vdecimate(const uint8_t *p, uint32_t shift) {
+    zvec v[8];
+    uint32_t n = 1u << shift;
+    for (uint32_t k = 0; k < n; k++) {
+        v[k] = vload(p + k * ZVEC);
+    }
+    for (; n > 1; n /= 2) {
+        for (uint32_t k = 0; k < n / 2; k++) {
+            v[k] = vpack_even(v[2 * k], v[2 * k + 1]);
+        }
+    }
+    return v[0];
+}
+
+// Grava cada byte de x (1 << shift) vezes: (ZVEC << shift) bytes
+ALWAYS_INLINE void vreplicate_store(uint8_t *dst, zvec x, uint32_t shift) {
+    zvec v[8];
+    uint32_t n = 1;
+    v[0] = x;
+    for (uint32_t s = 0; s < shift; s++, n *= 2) {
+        for (uint32_t k = n; k-- > 0; ) {
+            vzip_self(v[k], &v[2 * k], &v[2 * k + 1]);
+        }
+    }
+    for (uint32_t k = 0; k < n; k++) {
+        vstore(dst + k * ZVEC, v[k]);
+    }
+}
+
+#endif // ZVEC
+
+// =================================================================
+// Operações por linha (vetor + cauda escalar)
+// =================================================================
+// dst[i] = src[i >> shift], i < (n << shift); lê exatamente n bytes
+ALWAYS_INLINE void row_replicate_n(uint8_t *dst, const uint8_t *src, uint32_t n, uint32_t shift) {
+    uint32_t i = 0;
+#ifdef ZVEC
+    for (; i + ZVEC <= n; i += ZVEC) {
+        vreplicate_store(dst + (i << shift), vload(src + i), shift);
+    }
+#endif
+    for (; i < n; i++) {
+        memset(dst + (i << shift), src[i], 1u << shift);
+    }
+}
+
+// dst[i] = src[i << shift], i < n; não lê além de src[(n - 1) << shift]
+ALWAYS_INLINE void row_decimate_n(uint8_t *dst, const uint8_t *src, uint32_t n, uint32_t shift) {
+    uint32_t i = 0;
+#ifdef ZVEC
+    for (; i + ZVEC < n; i += ZVEC) {
+        vstore(dst + i, vdecimate(src + (i << shift), shift));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = src[i << shift];
+    }
+}
+
+// BA: dst[i] = ba_pixel(src[i << shift], src[(i << shift) + half])
+ALWAYS_INLINE void row_block_average_n(uint8_t *dst, const uint8_t *src, uint32_t n, uint32_t shift, int rgb332) {
+    uint32_t half = 1u << (shift - 1);
+    uint32_t i = 0;
+#ifdef ZVEC
+    for (; i + ZVEC < n; i += ZVEC) {
+        const uint8_t *p = src + (i << shift);
+        zvec p0 = vdecimate(p, shift), p1 = vdecimate(p + half, shift);
+        vstore(dst + i, rgb332 ? vblock_average_rgb332(p0, p1) : vblock_average(p0, p1));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = ba_pixel(src[i << shift], src[(i << shift) + half], rgb332);
+    }
+}
+
+// Despacho com o deslocamento constante, para o compilador desenrolar os vetores
+static void row_replicate(uint8_t *dst, const uint8_t *src, uint32_t n, uint32_t shift) {
+    switch (shift) {
+        case 0:  memcpy(dst, src, n); break;
+        case 1:  row_replicate_n(dst, src, n, 1); break;
+        case 2:  row_replicate_n(dst, src, n, 2); break;
+        default: row_replicate_n(dst, src, n, 3); break;
+    }
+}
+
+static void row_decimate(uint8_t *dst, const uint8_t *src, uint32_t n, uint32_t shift) {
+    switch (shift) {
+        case 1:  row_decimate_n(dst, src, n, 1); break;
+        case 2:  row_decimate_n(dst, src, n, 2); break;
+        default: row_decimate_n(dst, src, n, 3); break;
+    }
+}
+
+static void row_block_average(uint8_t *dst, const uint8_t *src, uint32_t n, uint32_t shift, int rgb332) {
+    switch (shift) {
+        case 1:  rgb332 ? row_block_average_n(dst, src, n, 1, 1) : row_block_average_n(dst, src, n, 1, 0); break;
+        case 2:  rgb332 ? row_block_average_n(dst, src, n, 2, 1) : row_block_average_n(dst, src, n, 2, 0); break;
+        default: rgb332 ? row_block_average_n(dst, src, n, 3, 1) : row_block_average_n(dst, src, n, 3, 0); break;
+    }
+}
+
+// =================================================================
+// Versão vetorizada
+// =================================================================
+// Monta uma linha de zoom in: os "lag" primeiros pixels e o corpo
+static void zoom_in_line(uint8_t *line, const uint8_t *src, uint32_t lag, uint32_t shift,
+                         uint32_t x_off, uint32_t y_off, uint32_t y) {
+    uint8_t decimated[W];
+    uint32_t row = zoom_in_row(lag, shift, y_off, y) & COORD_MASK;
+
+    // Corpo (x >= lag): replicação por 2^s a partir de x_off; com s = 0
+    // o PR lê as colunas ímpares (1, 3, ...) em pares e o NHI é uma cópia
+    uint32_t dec_shift = (shift == 0 && lag == 2) ? 1 : 0;
+    uint32_t rep_shift = shift ? shift : dec_shift;
+    uint32_t first_col = shift ? x_off : lag - 1;
+    uint32_t n_rep = ((W - lag - 1) >> rep_shift) + 1;
+    uint32_t n_src = ((n_rep - 1) << dec_shift) + 1;
+
+    for (uint32_t x = 0; x < lag; x++) {
+        line[x] = zoom_in_pixel(src, lag, shift, x_off, y_off, x, y);
+    }
+
+    if (first_col + n_src - 1 <= COORD_MASK && row * W + first_col + n_src <= ZOOM_HOST_PIXELS) {
+        const uint8_t *p = src + row * W + first_col;
+        if (dec_shift) {
+            row_decimate(decimated, p, n_rep, dec_shift);
+            p = decimated;
+        }
+        row_replicate(line + lag, p, n_rep, rep_shift);
+    } else {
+        for (uint32_t x = lag; x < W; x++) {
+            line[x] = zoom_in_pixel(src, lag, shift, x_off, y_off, x, y);
+        }
+    }
+}
+
+static void zoom_in_frame(uint8_t *dst, const uint8_t *src, uint32_t algorithm, uint32_t level,
+                          uint32_t x_off, uint32_t y_off) {
+    uint8_t line[W + LINE_SLACK];
+    uint32_t lag = (algorithm == OP_PR_ALG) ? 2 : 1;
+    uint32_t shift = zoom_in_shift(level);
+    uint32_t count = written_pixels(algorithm);
+    uint32_t prev_row = UINT32_MAX, prev_lead = UINT32_MAX;
+
+    for (uint32_t y = 0; y < H; y++) {
+        // Linhas com a mesma origem (e o mesmo primeiro pixel) são iguais
+        uint32_t row = zoom_in_row(lag, shift, y_off, y);
+        uint32_t lead = zoom_in_col(lag, shift, x_off, 0, y);
+        if (row != prev_row || lead != prev_lead) {
+            zoom_in_line(line, src, lag, shift, x_off, y_off, y);
+            prev_row = row;
+            prev_lead = lead;
+        }
+        uint32_t n = (count - y * W < W) ? count - y * W : W;
+        memcpy(dst + y * W, line, n);
+    }
+}
+
+static void zoom_out_frame(uint8_t *dst, const uint8_t *src, uint32_t algorithm, uint32_t level, int rgb332) {
+    uint32_t shift = zoom_out_shift(level);
+    uint32_t win_w = W >> shift, win_h = H >> shift;
+    uint32_t x0 = (W - win_w) / 2, y0 = (H - win_h) / 2;
+    uint32_t count = written_pixels(algorithm);
+
+    for (uint32_t y = 0; y < H; y++) {
+        uint8_t *out = dst + y * W;
+        uint32_t n = (count - y * W < W) ? count - y * W : W;
+
+        if (y < y0 || y >= y0 + win_h) {
+            memset(out, 0, n);
+            continue;
+        }
+        memset(out, 0, x0);
+        memset(out + x0 + win_w, 0, W - x0 - win_w);
+
+        const uint8_t *p = src + ((y - y0) << shift) * W;
+        if (algorithm == OP_NH_ALG) {
+            row_decimate(out + x0, p, win_w, shift);
+        } else {
+            row_block_average(out + x0, p, win_w, shift, rgb332);
+        }
+    }
+}
+
+int zoom_host_run(uint8_t *dst, const uint8_t *src, uint32_t algorithm, uint32_t level,
+                  uint32_t x_offset, uint32_t y_offset, uint32_t pixel_format) {
+    if (validate(algorithm, level) != 0) {
+        return -1;
+    }
+
+    if (algorithm == OP_PR_ALG || algorithm == OP_NHI_ALG) {
+        zoom_in_frame(dst, src, algorithm, level, x_offset & COORD_MASK, y_offset & 0xFF);
+    } else {
+        zoom_out_frame(dst, src, algorithm, level, pixel_format == PIXEL_RGB332);
+    }
+    return 0;
+}
+
+const char *zoom_host_isa(void) {
+    return ZOOM_ISA;
+}
+
+// =================================================================
+// Decodificação (espelha o estado IDLE do main.v)
+// =================================================================
+void zoom_host_state_reset(ZoomHostState *state) {
+    state->current_zoom = ZOOM_1X;
+    state->next_zoom = ZOOM_1X;
+    state->pixel_format = PIXEL_GRAY8;
+}
+
+// CTRL_SET_ZOOM (OP_EXT/EXT_CTRL): nível e algoritmo no próprio comando
+static ZoomHostAction decode_set_zoom(ZoomHostState *state, uint32_t mem_addr, ZoomHostAction action) {
+    uint32_t command = (mem_addr >> EXT_CTRL_SHIFT) & 0xF;
+    uint32_t level = command & 0x7;
+    uint32_t algorithm = ((mem_addr >> SET_ZOOM_ALG_SHIFT) & 0x3) + OP_NHI_ALG;
+    int zoom_in = (algorithm == OP_PR_ALG || algorithm == OP_NHI_ALG);
+
+    if ((mem_addr >> EXT_SUBOP_SHIFT) != EXT_CTRL || !(command & CTRL_SET_ZOOM) || level == 0 ||
+        (level > ZOOM_1X && !zoom_in) || (level < ZOOM_1X && zoom_in)) {
+        return action; // Outra instrução estendida, ou SET_ZOOM recusado (FLAG_ERROR)
+    }
+    action.kind = (level == ZOOM_1X) ? ZOOM_ACTION_COPY_MEM1 : ZOOM_ACTION_RUN;
+    action.algorithm = algorithm;
+    action.level = level;
+    action.x_offset = mem_addr & 0x1FF;
+    state->next_zoom = level;
+    state->current_zoom = level;
+    return action;
+}
+
+ZoomHostAction zoom_host_decode(ZoomHostState *state, uint32_t instruction) {
+    uint32_t opcode  = instruction & 0x7;
+    uint32_t sel_mem = (instruction >> 20) & 0x1;
+    uint32_t current = state->current_zoom;
+    uint32_t previous_next = state->next_zoom;
+    ZoomHostAction action = { ZOOM_ACTION_NONE, opcode, 0, (instruction >> 3) & ADDR_MASK, (instruction >> 21) & 0xFF,
+                              state->pixel_format };
+
+    switch (opcode) {
+        case OP_LOAD:
+        case OP_STORE:
+            return action;
+
+        case OP_RESET:
+            state->next_zoom = ZOOM_1X;
+            action.kind = ZOOM_ACTION_COPY_MEM1;
+            break;
+
+        case OP_REFRESH_SCREEN:
+            if (sel_mem) {
+                if ((action.x_offset >> EXT_SUBOP_SHIFT) == EXT_CTRL &&
+                    ((action.x_offset >> EXT_CTRL_SHIFT) & 0xF) == CTRL_FILTER_RUN) {
+                    // Filtro 3x3: mesmo nível, a cópia no fim mantém o current_zoom
+                    state->next_zoom = current;
+                    action.kind = ZOOM_ACTION_FILTER;
+                    break;
+                }
+                if ((action.x_offset >> EXT_SUBOP_SHIFT) == EXT_CTRL &&
+                    ((action.x_offset >> EXT_CTRL_SHIFT) & 0xF) == CTRL_CONFIG) {
+                    // Formato do pixel: vale a partir da próxima instrução
+                    uint32_t value = action.x_offset & 0xFF;
+                    if (((action.x_offset >> CONFIG_REG_SHIFT) & 0x7) == CONFIG_PIXEL_FORMAT &&
+                        (value == PIXEL_GRAY8 || value == PIXEL_RGB332)) {
+                        state->pixel_format = value;
+                    }
+                    return action;
+                }
+                return decode_set_zoom(state, action.x_offset, action);
+            }
+            action.kind = ZOOM_ACTION_COPY_MEM1;
+            break;
+
+        case OP_NH_ALG:
+        case OP_BA_ALG:
+            if (current == ZOOM_1_8X) {
+                return action;
+            }
+            state->next_zoom = (current - 1) & 0x7;
+            if (current == ZOOM_2X) {
+                action.kind = ZOOM_ACTION_COPY_MEM1;
+            } else if (current <= ZOOM_1X) {
+                action.kind = ZOOM_ACTION_RUN;
+            } else if (opcode == OP_BA_ALG) {
+                action.kind = ZOOM_ACTION_RUN;
+                action.algorithm = OP_PR_ALG;
+            } else if (previous_next > ZOOM_1X) {
+                // NH_ALG decide pelo next_zoom antigo
+                action.kind = ZOOM_ACTION_RUN;
+                action.algorithm = OP_NHI_ALG;
+            } else {
+                return action; // Sem algoritmo e sem cópia
+            }
+            break;
+
+        default: // OP_NHI_ALG / OP_PR_ALG (SEL_MEM = 1 -> Pan)
+            if (current == ZOOM_8X && !sel_mem) {
+                return action;
+            }
+            state->next_zoom = sel_mem ? current : ((current + 1) & 0x7);
+            action.kind = (current == ZOOM_1_2X && !sel_mem) ? ZOOM_ACTION_COPY_MEM1 : ZOOM_ACTION_RUN;
+            break;
+    }
+
+    action.level = state->next_zoom;
+    state->current_zoom = state->next_zoom;
+    return action;
+}
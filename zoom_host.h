@@ -0,0 +1,76 @@
+#ifndef ZOOM_HOST_H
+#define ZOOM_HOST_H
+
+/*
+ * =================================================================
+ * Algoritmos de zoom no HPS (referência rápida do main.v)
+ * =================================================================
+ * Executam no processador os mesmos quatro algoritmos do coprocessador
+ * (OP_PR_ALG, OP_NHI_ALG, OP_BA_ALG, OP_NH_ALG), com deslocamento de
+ * pan, reproduzindo byte a byte a saída do main.v, inclusive os
+ * detalhes da FSM (atraso de um pixel na origem do zoom in, "média"
+ * truncada em 8 bits do BA, último pixel não escrito por NHI/BA/NH).
+ *
+ * src faz o papel da mem1 (imagem original) e dst o da mem3 (memória
+ * de trabalho), ambos com ZOOM_HOST_PIXELS bytes. Como no hardware,
+ * os pixels que o algoritmo não escreve mantêm o valor anterior de dst.
+ * level é o nível de destino (next_zoom, ZOOM_* de constantes.h);
+ * x_offset/y_offset são os campos MEM_ADDR/DATA_IN da instrução.
+ * pixel_format (PIXEL_GRAY8 ou PIXEL_RGB332, CTRL_CONFIG) só muda o BA,
+ * que em RGB332 tira a média truncada de cada canal.
+ *
+ * zoom_host_run usa NEON (Cortex-A9), AVX2 ou SSE2, conforme as flags
+ * de compilação (ver SIMD_CFLAGS no Makefile); zoom_host_run_scalar é
+ * a versão pixel a pixel usada como referência.
+ *
+ * Retornam 0, ou -1 para algoritmo/nível que o main.v não executa
+ * (BA/NH só existem para os níveis 1/2, 1/4 e 1/8).
+ */
+
+#include <stdint.h>
+
+#define ZOOM_HOST_WIDTH  320
+#define ZOOM_HOST_HEIGHT 240
+#define ZOOM_HOST_PIXELS (ZOOM_HOST_WIDTH * ZOOM_HOST_HEIGHT)
+
+int zoom_host_run(uint8_t *dst, const uint8_t *src, uint32_t algorithm, uint32_t level,
+                  uint32_t x_offset, uint32_t y_offset, uint32_t pixel_format);
+int zoom_host_run_scalar(uint8_t *dst, const uint8_t *src, uint32_t algorithm, uint32_t level,
+                         uint32_t x_offset, uint32_t y_offset, uint32_t pixel_format);
+
+// Conjunto de instruções usado por zoom_host_run ("neon", "avx2", "sse2" ou "escalar")
+const char *zoom_host_isa(void);
+
+// =================================================================
+// Decodificação (estado IDLE do main.v)
+// =================================================================
+// Prevê o que o coprocessador faz com uma instrução, a partir dos
+// registradores current_zoom/next_zoom, e os atualiza. Usado para
+// saber qual algoritmo (e em que nível) a FPGA executou.
+
+typedef struct {
+    uint32_t current_zoom;
+    uint32_t next_zoom;
+    uint32_t pixel_format; // CTRL_CONFIG/CONFIG_PIXEL_FORMAT
+} ZoomHostState;
+
+typedef enum {
+    ZOOM_ACTION_NONE,      // Instrução recusada, LOAD/STORE ou sem efeito na mem3
+    ZOOM_ACTION_COPY_MEM1, // Exibição recebe a mem1 (RESET, REFRESH, 1/2 <-> 2x, SET_ZOOM 1x)
+    ZOOM_ACTION_RUN,       // Algoritmo executado na mem3 e copiado para a exibição
+    ZOOM_ACTION_FILTER     // Filtro 3x3 na mem3 (x_offset = MEM_ADDR), copiado para a exibição
+} ZoomActionKind;
+
+typedef struct {
+    ZoomActionKind kind;
+    uint32_t algorithm; // Opcode do algoritmo de fato executado
+    uint32_t level;     // next_zoom usado pelo algoritmo
+    uint32_t x_offset;
+    uint32_t y_offset;
+    uint32_t pixel_format; // Formato em vigor na instrução
+} ZoomHostAction;
+
+void zoom_host_state_reset(ZoomHostState *state);
+ZoomHostAction zoom_host_decode(ZoomHostState *state, uint32_t instruction);
+
+#endif // ZOOM_HOST_H